@@ -92,14 +92,19 @@ namespace mantis
          * {
          *     "database": "<db type>",
          *     "connection": "<connection string>",
+         *     "replica": "<read replica connection string>",
          *     "dataDir": "<path to dir>",
          *     "publicDir": "<path to dir>",
          *     "scriptsDir": "<path to dir>",
          *     "dev": true,
+         *     "writeQueue": true,
+         *     "sqliteProfile": { "mmapSize": <int>, "cacheSize": <int>, ... },
          *     "serve": {
          *         "port": <int>,
          *         "host": "<host IP/addr>",
          *         "poolSize": <int>,
+         *         "readPoolSize": <int>,
+         *         "maxSubscribers": <int>,
          *     },
          *     "admins": {
          *         "add": "<email to add>",
@@ -175,6 +180,37 @@ namespace mantis
          */
         void setPoolSize(const int& pool_size);
 
+        /**
+         * @brief Retrieve the database read pool size value.
+         * @return Number of sessions in the read-only connection pool.
+         */
+        [[nodiscard]] int readPoolSize() const;
+        /**
+         * @brief Set the database read pool size value.
+         * @param pool_size New read pool size value.
+         */
+        void setReadPoolSize(const int& pool_size);
+
+        ///> Upper bound of @see maxSubscribers(), the HTTP pool keeps a worker per stream
+        static constexpr int MAX_SUBSCRIBERS = 256;
+
+        /**
+         * @brief Retrieve the cap on concurrent realtime subscribers.
+         * @return Realtime streams served at once, each holds one of the HTTP workers set aside for streams.
+         */
+        [[nodiscard]] int maxSubscribers() const;
+        /**
+         * @brief Set the cap on concurrent realtime subscribers.
+         * @param max_subscribers New cap, >= 1, clamped to @see MAX_SUBSCRIBERS
+         */
+        void setMaxSubscribers(const int& max_subscribers);
+
+        /**
+         * @brief Connection string for the read pool, PostgreSQL only.
+         * @return Replica connection string, empty if reads go to the primary database.
+         */
+        [[nodiscard]] std::string replicaConnString() const;
+
         /**
          * @brief Retrieve HTTP Server host address. For instance, a host of `127.0.0.1`, `0.0.0.0`, etc.
          * @return HTTP Server Host address.
@@ -295,6 +331,18 @@ namespace mantis
 
         bool isDevMode() const;
 
+        /**
+         * @brief Whether SQLite writes are funneled through the single writer queue.
+         * @return `true` unless disabled through `--noWriteQueue`
+         */
+        [[nodiscard]] bool isWriteQueueEnabled() const;
+
+        /**
+         * @brief SQLite tuning overrides from `--sqliteProfile`, @see SqliteProfile
+         * @return Profile values as a JSON object, empty if not set
+         */
+        [[nodiscard]] const json& sqliteProfile() const;
+
     private:
         const std::string __class_name__ = "mantis::MantisApp";
 
@@ -393,9 +441,14 @@ namespace mantis
         std::string m_host = "127.0.0.1";
 
         int m_poolSize = 2;
+        int m_readPoolSize = 2;
+        int m_maxSubscribers = 32;
+        std::string m_replicaConnString;
         bool m_toStartServer = false;
         bool m_launchAdminPanel = false;
         bool m_isDevMode = false;
+        bool m_writeQueue = true;
+        json m_sqliteProfile = json::object();
 
         std::unique_ptr<DatabaseUnit> m_database;
         std::unique_ptr<LoggingUnit> m_logger;
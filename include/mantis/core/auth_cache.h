@@ -0,0 +1,95 @@
+/**
+ * @file auth_cache.h
+ * @brief In-memory cache of authenticated users, sparing the user lookup of authenticated requests.
+ */
+
+#ifndef AUTH_CACHE_H
+#define AUTH_CACHE_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include "sharded_ttl_cache.h"
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    /**
+     * @brief Size bounded, sharded cache of auth principals, the user records tokens resolve to,
+     * keyed by table & id, @see TableUnit::resolveAuth().
+     *
+     * Users are cached the first time a request needs them and dropped once their record is
+     * updated or deleted through the API, or their table is altered or dropped. Writes bypassing
+     * the API, e.g. raw SQL from JS, clear the cache; others are served stale up to @see TTL.
+     *
+     * As with @see RecordCache, users are kept in a @see ShardedTtlCache, a user read from the
+     * database is only stored if its shard wasn't invalidated since the read started.
+     */
+    class AuthCache
+    {
+    public:
+        ///> Independently locked shards, keys are spread over them by hash
+        static constexpr size_t SHARDS = ShardedTtlCache<std::string, json>::SHARDS;
+        ///> Users kept across all shards
+        static constexpr size_t MAX_ENTRIES = 10000;
+        ///> How long a user is served before being read again
+        static constexpr auto TTL = std::chrono::seconds(60);
+
+        /// Told of invalidated users: `id` is empty for a whole table, both are empty for all users.
+        using Listener = std::function<void(const std::string& table, const std::string& id)>;
+
+        AuthCache() = default;
+
+        /**
+         * @brief Cached user of `table` with `id`.
+         * @return User record without its password, or std::nullopt if missing or expired
+         */
+        std::optional<json> get(const std::string& table, const std::string& id);
+
+        /// Generation of the shard holding the user, to be taken before reading it from the database.
+        [[nodiscard]] uint64_t generation(const std::string& table, const std::string& id) const;
+
+        /**
+         * @brief Cache a user read from the database, evicting the least recently used users
+         * of the shard if full.
+         * @param generation From @see generation(), taken before the user was read
+         */
+        void put(const std::string& table, const std::string& id, json user, uint64_t generation);
+
+        /// Drop the user of `table` with `id`, once it was updated or deleted.
+        void invalidate(const std::string& table, const std::string& id);
+
+        /// Drop all users of `table`, e.g. once its schema changed.
+        void invalidate(const std::string& table);
+
+        /// Drop all users
+        void clear();
+
+        /// Hit/miss & eviction counters as a JSON object.
+        [[nodiscard]] json stats() const;
+
+        /// Set the listener told of invalidations, e.g. to re-check realtime subscribers' users.
+        void setListener(Listener listener);
+
+        const std::string __class_name__ = "mantis::AuthCache";
+
+    private:
+        static std::string key(const std::string& table, const std::string& id);
+
+        /// Tell the listener, if any, outside of the shard locks.
+        void notify(const std::string& table, const std::string& id) const;
+
+        ShardedTtlCache<std::string, json> m_users{MAX_ENTRIES}; ///> Users by @see key()
+
+        mutable std::mutex m_listenerMutex;
+        Listener m_listener;
+    };
+}
+
+#endif //AUTH_CACHE_H
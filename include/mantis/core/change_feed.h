@@ -0,0 +1,172 @@
+/**
+ * @file change_feed.h
+ * @brief Change data capture: record inserts, updates & deletes published to a @see ChangeRing.
+ */
+
+#ifndef CHANGE_FEED_H
+#define CHANGE_FEED_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <soci/soci.h>
+#include <nlohmann/json.hpp>
+
+#include "change_ring.h"
+
+namespace soci::sqlite_api
+{
+    struct sqlite3_context;
+    struct sqlite3_value;
+}
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    /**
+     * @brief Captures committed record changes of user tables and publishes them to a
+     * @see ChangeRing, for caches, realtime and sync to consume instead of polling.
+     *
+     * SQLite: @see attach() installs `sqlite3_update_hook`, `sqlite3_commit_hook` and
+     * `sqlite3_rollback_hook` on a writing connection. The update hook only reports the
+     * `rowid`: ids of deleted records are captured by a `TEMP` trigger per table, installed on
+     * the connection by @see prepare(), which hands `OLD.id` to a function registered on that
+     * connection only. Ids of inserted & updated records are resolved on a separate read
+     * connection once committed, in @see flush(). Changes are held per connection until their
+     * transaction commits; rolled back transactions, and savepoints rolled back through
+     * @see discard(), publish nothing.
+     *
+     * PostgreSQL: an `AFTER INSERT OR UPDATE OR DELETE` trigger on each table, @see captureSql(),
+     * sends the change with `pg_notify`, delivered on commit only. A listener thread holding
+     * its own connection publishes the notifications.
+     *
+     * Tables prefixed with `__` (system tables) aren't captured.
+     */
+    class ChangeFeed
+    {
+    public:
+        ///> Notification channel of the PostgreSQL triggers
+        static constexpr auto PG_CHANNEL = "mantis_changes";
+
+        ChangeFeed();
+        ~ChangeFeed();
+
+        ChangeFeed(const ChangeFeed&) = delete;
+        ChangeFeed& operator=(const ChangeFeed&) = delete;
+
+        /// Events published so far, to subscribe to.
+        [[nodiscard]] ChangeRing& ring();
+
+        /**
+         * @brief Capture SQLite changes, resolving record ids through `resolver`.
+         * @param resolver Opened, read-only session used by the feed only
+         */
+        void startSqlite(std::unique_ptr<soci::session> resolver);
+
+        /// Install the change hooks on a writing SQLite session.
+        void attach(soci::session& sql);
+
+        /**
+         * @brief Install the delete triggers on `sql` if tables changed since it was last
+         * prepared, to be called before writing through a session.
+         */
+        void prepare(soci::session& sql);
+
+        /**
+         * @brief Position in the uncommitted changes of `sql`, taken before a savepoint.
+         * @return Mark to pass to @see discard()
+         */
+        size_t mark(soci::session& sql);
+
+        /// Drop the changes of `sql` captured since `mark`, once their savepoint was rolled back.
+        void discard(soci::session& sql, size_t mark);
+
+        /// Publish the changes committed on `sql`, to be called right after committing.
+        void flush(soci::session& sql);
+
+        /**
+         * @brief Capture PostgreSQL changes, installing the trigger function and listening
+         * for its notifications on a dedicated connection.
+         * @param sql Session of the primary database, to install the trigger function with
+         * @param conn_str Connection string of the primary database
+         */
+        void startPostgres(soci::session& sql, const std::string& conn_str);
+
+        /**
+         * @brief Statements installing the change trigger on `table`.
+         * @return Trigger DDL for PostgreSQL, empty for other databases
+         */
+        [[nodiscard]] std::vector<std::string> captureSql(const std::string& table) const;
+
+        /// Stop capturing, removing the hooks and the listener.
+        void stop();
+
+        /// Feed counters & ring state as a JSON object.
+        [[nodiscard]] json stats() const;
+
+        const std::string __class_name__ = "mantis::ChangeFeed";
+
+    private:
+        struct Pending
+        {
+            ChangeOp op = ChangeOp::Create;
+            std::string table;
+            int64_t rowid = 0;
+            std::string id; ///> Set by the delete trigger, deletes only
+            bool transient = false; ///> Deleted row inserted by the same transaction
+        };
+
+        struct Capture
+        {
+            ChangeFeed* feed = nullptr;
+            void* db = nullptr; ///> `sqlite3*` the hooks are installed on
+            std::mutex mutex;
+            std::vector<Pending> pending; ///> Current transaction
+            std::vector<Pending> committed; ///> Committed, not published yet
+
+            // Only touched by the thread holding the session
+            int schemaVersion = -1; ///> `PRAGMA schema_version` the triggers were installed at
+            std::vector<std::string> triggers; ///> Tables with a delete trigger
+        };
+
+        static void onUpdate(void* arg, int op, const char* db, const char* table, long long rowid);
+        static void onDeleted(soci::sqlite_api::sqlite3_context* ctx, int argc, soci::sqlite_api::sqlite3_value** argv);
+        static int onCommit(void* arg);
+        static void onRollback(void* arg);
+
+        Capture* capture(soci::session& sql);
+
+        /// Record id of `rowid` as seen by readers, empty if there's no such row, std::nullopt on errors.
+        std::optional<std::string> resolveId(const std::string& table, int64_t rowid);
+
+        /// Listener thread, publishing PostgreSQL notifications.
+        void listen(std::string conn_str);
+
+        static bool isCaptured(const std::string& table);
+
+        ChangeRing m_ring;
+
+        std::mutex m_capturesMutex;
+        std::unordered_map<void*, std::unique_ptr<Capture>> m_captures; ///> By `sqlite3*`
+
+        std::mutex m_resolverMutex;
+        std::unique_ptr<soci::session> m_resolver;
+        std::unordered_map<std::string, void*> m_resolverStmts; ///> `sqlite3_stmt*` by table
+
+        bool m_postgres = false;
+        std::atomic<bool> m_stop{false};
+        std::thread m_listener;
+
+        std::atomic<uint64_t> m_dropped{0}; ///> Changes not published, the record was gone
+        std::atomic<uint64_t> m_unresolved{0}; ///> Deletes published without a record id
+        std::atomic<uint64_t> m_notifications{0};
+    };
+}
+
+#endif //CHANGE_FEED_H
@@ -0,0 +1,159 @@
+/**
+ * @file change_ring.h
+ * @brief Lock-free ring buffer of record change events, published by writers and read by any number of subscribers.
+ */
+
+#ifndef CHANGE_RING_H
+#define CHANGE_RING_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    /// Kind of change a @see ChangeEvent reports.
+    enum class ChangeOp : uint8_t
+    {
+        Create,
+        Update,
+        Delete
+    };
+
+    /// Name of the change as sent to clients: `create`, `update` or `delete`.
+    std::string_view changeOpName(ChangeOp op);
+
+    /// A committed change to a single record.
+    struct ChangeEvent
+    {
+        uint64_t seq = 0; ///> Position in the feed, one more than the previous event's
+        ChangeOp op = ChangeOp::Create;
+        std::string table;
+        std::string id; ///> Record id, empty if it could not be resolved
+        int64_t timestamp = 0; ///> Milliseconds since the epoch, when the event was published
+
+        /// `{"seq", "op", "table", "id", "timestamp"}`
+        [[nodiscard]] json toJson() const;
+    };
+
+    /**
+     * @brief Fixed capacity, multi-producer & multi-consumer ring of @see ChangeEvent.
+     *
+     * Publishers claim the next sequence number with a single atomic increment and write the
+     * event into its slot, nobody ever waits on a lock to publish. Each slot carries a version
+     * (seqlock), odd while it's being written and `2 * seq` once the event is readable, so
+     * readers detect both slots not published yet and slots overwritten while copying them.
+     * The payload is stored in relaxed atomics, so copying a slot being rewritten is a torn
+     * read caught by the version check rather than a data race.
+     *
+     * A publisher only takes over its slot once the event of the previous lap is published,
+     * yielding meanwhile, which only happens if the ring wraps around within a single write.
+     * A publisher a full lap behind, i.e. preempted for @see capacity() events, finds its slot
+     * claimed by a newer event and drops its own, which readers count as lost, rather than
+     * moving the version backwards.
+     *
+     * The ring never blocks publishers on slow readers: a subscriber falling more than
+     * @see capacity() events behind loses the oldest ones, @see poll() reports how many, and
+     * should resynchronize (e.g. re-read the affected tables).
+     *
+     * Subscribers keep their own cursor, the last sequence number they've seen:
+     * @code
+     * auto cursor = ring.head(); // Only events published from now on
+     * std::vector<ChangeEvent> events;
+     * while (running) {
+     *     ring.wait(cursor, std::chrono::seconds(1));
+     *     if (const auto lost = ring.poll(cursor, events); lost > 0) resync();
+     *     for (const auto& e : events) ...
+     * }
+     * @endcode
+     */
+    class ChangeRing
+    {
+    public:
+        static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+        ///> Longest table name & record id stored inline, longer ids are published empty
+        static constexpr size_t MAX_FIELD_SIZE = 96;
+
+        /**
+         * @brief Create the ring.
+         * @param capacity Events kept, rounded up to a power of two
+         */
+        explicit ChangeRing(size_t capacity = DEFAULT_CAPACITY);
+
+        ChangeRing(const ChangeRing&) = delete;
+        ChangeRing& operator=(const ChangeRing&) = delete;
+
+        /**
+         * @brief Publish a change event, overwriting the oldest one if the ring is full.
+         * @return Sequence number of the event
+         */
+        uint64_t publish(ChangeOp op, std::string_view table, std::string_view id);
+
+        /**
+         * @brief Read the events published after `cursor`, in order.
+         *
+         * Stops at the first event not fully published yet, so events are never skipped
+         * because a concurrent publisher is slower than the next one.
+         *
+         * @param cursor Sequence number of the last event seen, advanced past the events read
+         * @param out Events read, replaced
+         * @param max Upper bound of events read in one call
+         * @return Events lost since `cursor` because they were overwritten, `0` normally
+         */
+        size_t poll(uint64_t& cursor, std::vector<ChangeEvent>& out, size_t max = 1024) const;
+
+        /**
+         * @brief Block until an event after `cursor` is published, or the timeout expires.
+         * @return `true` if events after `cursor` are available
+         */
+        bool wait(uint64_t cursor, std::chrono::milliseconds timeout) const;
+
+        /// Sequence number of the last event claimed, `0` before the first one.
+        [[nodiscard]] uint64_t head() const;
+
+        [[nodiscard]] size_t capacity() const;
+
+        /// Published events & capacity as a JSON object.
+        [[nodiscard]] json stats() const;
+
+    private:
+        ///> Words of a table name or record id in a slot
+        static constexpr size_t FIELD_WORDS = MAX_FIELD_SIZE / sizeof(uint64_t);
+        static_assert(MAX_FIELD_SIZE % sizeof(uint64_t) == 0);
+
+        using Field = std::array<std::atomic<uint64_t>, FIELD_WORDS>;
+
+        struct Slot
+        {
+            std::atomic<uint64_t> version{0}; ///> `2 * seq - 1` while writing, `2 * seq` once published
+            std::atomic<uint32_t> meta{0}; ///> Op, table size & id size, a byte each
+            std::atomic<int64_t> timestamp{0};
+            Field table{};
+            Field id{};
+        };
+
+        static void storeField(Field& field, std::string_view value);
+        static void loadField(const Field& field, size_t size, std::string& out);
+
+        size_t m_mask;
+        std::unique_ptr<Slot[]> m_slots;
+        std::atomic<uint64_t> m_head{0};
+
+        // Wake up waiting subscribers, only touched if anyone waits
+        mutable std::mutex m_waitMutex;
+        mutable std::condition_variable m_waitCv;
+        mutable std::atomic<uint32_t> m_waiters{0};
+    };
+}
+
+#endif //CHANGE_RING_H
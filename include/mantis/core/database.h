@@ -7,6 +7,8 @@
 #define DATABASE_H
 
 #include <memory>
+#include <string>
+#include <vector>
 #include <soci/soci.h>
 #include <nlohmann/json.hpp>
 #include <mantis/core/private-impl/soci_custom_types.hpp>
@@ -15,6 +17,14 @@
 #include "../app/app.h"
 #include "../utils/utils.h"
 #include "logging.h"
+#include "statement_cache.h"
+#include "record_counter.h"
+#include "record_cache.h"
+#include "auth_cache.h"
+#include "table_versions.h"
+#include "change_feed.h"
+#include "write_queue.h"
+#include "wal_checkpointer.h"
 
 #define __file__ "core/tables/database.h"
 
@@ -22,6 +32,43 @@ namespace mantis
 {
     using json = nlohmann::json;
 
+    /**
+     * @brief SQLite connection tuning, applied to every session as it is opened.
+     *
+     * Taken from the `sqliteProfile` object of the settings config, overridden by the
+     * `--sqliteProfile` command line option. Settings changes apply on the next start.
+     *
+     * @code
+     * mantisapp --sqliteProfile '{"mmapSize": 1073741824, "cacheSize": 32768}' serve
+     * @endcode
+     */
+    struct SqliteProfile
+    {
+        long long mmapSize = 256LL * 1024 * 1024; ///> `mmap_size` in bytes, `0` disables memory-mapped reads
+        long long cacheSize = 16 * 1024; ///> `cache_size` in KiB, per connection
+        std::string tempStore = "memory"; ///> `temp_store`, one of `default`, `file` or `memory`
+        int pageSize = 4096; ///> `page_size` in bytes, only takes effect on new databases
+        int busyTimeout = 30000; ///> `busy_timeout` in milliseconds
+        bool sharedCache = false; ///> Open connections in shared cache mode, readers share table locks
+
+        /**
+         * @brief Override the profile values present in `j`.
+         * @param j Profile as a JSON object, keys as in @see toJson()
+         * @param base Profile to override
+         * @return Resulting profile
+         * @throw std::invalid_argument for unknown keys or invalid values
+         */
+        static SqliteProfile fromJson(const json& j, const SqliteProfile& base);
+
+        /// Profile from `j`, defaults for the values not present.
+        static SqliteProfile fromJson(const json& j);
+
+        [[nodiscard]] json toJson() const;
+
+        /// PRAGMA statements applying the profile, to run right after opening the session.
+        [[nodiscard]] std::vector<std::string> pragmas() const;
+    };
+
     /**
      * @brief Database Management Class
      *
@@ -54,18 +101,137 @@ namespace mantis
 
         /**
          * @brief Get access to a session from the pool
+         *
+         * Record changes committed through the session are published to @see changes() once
+         * the last copy of the pointer is released.
+         *
          * @return A shared pointer to soci::session
          */
         [[nodiscard]] std::shared_ptr<soci::session> session() const;
 
+        /**
+         * @brief Get access to a session from the read-only pool.
+         *
+         * Read sessions can't write, SQLite readers are opened with `query_only` and PostgreSQL
+         * readers with read only transactions, optionally connected to a replica (`--replica`).
+         * Use these for SELECT queries to keep them from competing with writes for sessions.
+         *
+         * @return A shared pointer to soci::session
+         */
+        [[nodiscard]] std::shared_ptr<soci::session> readSession() const;
+
         /**
          * Access to the underlying soci connection_pool instance
          * @return A reference to the soci::connection_pool instance
          */
         [[nodiscard]] soci::connection_pool& connectionPool() const;
 
+        /**
+         * @brief Access the prepared statement cache bound to the pooled connections.
+         * @return A reference to the @see StatementCache instance
+         */
+        [[nodiscard]] StatementCache& statements() const;
+
+        /**
+         * @brief Access the per-table record counts used for list pagination.
+         * @return A reference to the @see RecordCounter instance
+         */
+        [[nodiscard]] RecordCounter& counters() const;
+
+        /**
+         * @brief Access the cache of records served to point reads.
+         * @return A reference to the @see RecordCache instance
+         */
+        [[nodiscard]] RecordCache& recordCache() const;
+
+        /**
+         * @brief Access the cache of users that auth tokens resolve to.
+         * @return A reference to the @see AuthCache instance
+         */
+        [[nodiscard]] AuthCache& authCache() const;
+
+        /**
+         * @brief Access the per-table change versions, keying list ETags.
+         * @return A reference to the @see TableVersions instance
+         */
+        [[nodiscard]] TableVersions& versions() const;
+
+        /**
+         * @brief Access the change data capture feed of record inserts, updates & deletes.
+         * @return A reference to the @see ChangeFeed instance, subscribe through its ring
+         */
+        [[nodiscard]] ChangeFeed& changes() const;
+
+        /**
+         * @brief Execute a write job within a transaction.
+         *
+         * For SQLite databases, with the write queue enabled, the job is queued to the single
+         * writer connection and group committed with other queued writes. Otherwise, the job
+         * runs on a pooled session within its own transaction.
+         *
+         * @code
+         * const bool committed = db().write([&](soci::session& sql) {
+         *      sql << "DELETE FROM students WHERE id = :id", soci::use(id);
+         *      return true; // Return `false` to roll back
+         * });
+         * @endcode
+         *
+         * @param job Write job, @see WriteJob
+         * @return `true` if the job's changes were committed, `false` if rolled back.
+         */
+        bool write(const WriteJob& job) const;
+
+        /**
+         * @brief Access the SQLite writer queue, if enabled.
+         * @return Pointer to the @see WriteQueue instance or `nullptr`
+         */
+        [[nodiscard]] WriteQueue* writeQueue() const;
+
+        /**
+         * @brief Access the SQLite background WAL checkpointer, if running.
+         * @return Pointer to the @see WalCheckpointer instance or `nullptr`
+         */
+        [[nodiscard]] WalCheckpointer* checkpointer() const;
+
+        /**
+         * @brief Turn the automatic WAL checkpoints of the writing SQLite sessions on or off,
+         * off while the @see WalCheckpointer runs and back on once it stops.
+         * @param enabled `true` restores SQLite's default of @see WalCheckpointer::AUTOCHECKPOINT_PAGES
+         */
+        void setAutoCheckpoint(bool enabled) const;
+
+        /**
+         * @brief Database telemetry: statement cache, record counts, change feed, write queue & WAL checkpoints.
+         * @return Stats as a JSON object, `null` for the units not in use
+         */
+        [[nodiscard]] json metrics() const;
+
+        /**
+         * @brief SQLite tuning applied to the sessions, @see SqliteProfile
+         * @return Profile in use, defaults for other databases
+         */
+        [[nodiscard]] const SqliteProfile& sqliteProfile() const;
+
+        /**
+         * @brief Whether write statements can read back rows with `RETURNING`.
+         *
+         * Supported by PostgreSQL and SQLite 3.35+, checked once on connect.
+         * @return `true` if `INSERT/UPDATE/DELETE ... RETURNING` is supported
+         */
+        [[nodiscard]] bool supportsReturning() const;
+
         static nlohmann::json rowToJson(const soci::row& r);
 
+        /**
+         * @brief Whether the query only reads, safe to run on the read pool.
+         *
+         * A single `SELECT`, `VALUES` or `WITH ... SELECT` statement, comments aside, that
+         * doesn't write through a CTE, lock rows (`FOR UPDATE`) or create a table (`SELECT INTO`).
+         * @param query SQL statement
+         * @return `false` for anything else, or if unsure
+         */
+        static bool isSelectQuery(const std::string& query);
+
         /**
          * @brief Check if the database is connected
          * @return Flag of the database connection
@@ -100,7 +266,52 @@ namespace mantis
          */
         void writeCheckpoint() const;
 
+        /**
+         * @brief Open and configure a session for the selected database type.
+         * @param sql Session to open
+         * @param conn_str Connection string, not used for SQLite dbs.
+         * @param readOnly Whether the session is for the read-only pool
+         * @return `true` if the session was opened, `false` for unsupported databases.
+         */
+        bool openSession(soci::session& sql, const std::string& conn_str, bool readOnly) const;
+
+        /**
+         * @brief Open and configure an SQLite session on the `mantis.db` database file.
+         * @param sql Session to open
+         * @param readOnly Open the session with `PRAGMA query_only`
+         */
+        void openSqliteSession(soci::session& sql, bool readOnly = false) const;
+
+        /// Resolve the SQLite profile from the stored settings & command line, @see SqliteProfile
+        static SqliteProfile loadSqliteProfile();
+
+        /// Read back the effective SQLite pragmas of a session.
+        static json sqlitePragmas(soci::session& sql);
+
+        /**
+         * @brief Close all connected sessions of a connection pool.
+         * @param pool Connection pool, may be `nullptr` if never created.
+         * @param size Number of sessions in the pool
+         */
+        static void closePool(soci::connection_pool* pool, int size);
+
+        /// Check the connected database for `RETURNING` support, @see supportsReturning()
+        static bool hasReturningSupport(soci::session& sql);
+
         std::unique_ptr<soci::connection_pool> m_connPool;
+        std::unique_ptr<soci::connection_pool> m_readPool;
+        std::unique_ptr<WriteQueue> m_writeQueue;
+        std::unique_ptr<WalCheckpointer> m_checkpointer;
+        // Declared after the pool, cached statements must be released before the sessions are.
+        std::unique_ptr<StatementCache> m_stmtCache;
+        std::unique_ptr<RecordCounter> m_counters;
+        std::unique_ptr<RecordCache> m_recordCache;
+        std::unique_ptr<AuthCache> m_authCache;
+        std::unique_ptr<TableVersions> m_versions;
+        std::unique_ptr<ChangeFeed> m_changes;
+        bool m_supportsReturning = false;
+        SqliteProfile m_sqliteProfile;
+        json m_sqlitePragmas;
     };
 
     /**
@@ -0,0 +1,134 @@
+/**
+ * @file exporter.h
+ * @brief Streaming export of table records as NDJSON or CSV, through a single database cursor.
+ */
+
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <soci/soci.h>
+#include <nlohmann/json.hpp>
+
+#include "tables/tables.h"
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    /**
+     * @brief Streams all records of a table matching a filter, a chunk at a time.
+     *
+     * The records are read through one cursor held open for the whole export: a single
+     * stepped statement on SQLite and a `DECLARE ... CURSOR` fetched in batches of
+     * @see FETCH_SIZE rows on PostgreSQL. Only the current chunk is ever held in memory,
+     * however big the table is, and no `COUNT` or `OFFSET` scan is run.
+     *
+     * Formats:
+     *  - `ndjson`: One JSON object per line, same as records in list responses.
+     *  - `csv`: RFC 4180, a header row of column names in select order, then one record per
+     *    line. `null` values are written as empty fields, `json`/`list` values as JSON text.
+     *
+     * The exporter keeps a read session leased until it's destroyed, and doesn't hold on to
+     * the table once opened, so it may outlive it. As each export holds a session for as long
+     * as the client takes to download it, exports first take one of @see slots() through
+     * @see acquire(), leaving the rest of the read pool to other requests.
+     *
+     * @code
+     * RecordExporter exporter("csv");
+     * if (!exporter.acquire(RecordExporter::slots())) ... // Busy, try again later
+     * if (const auto err = exporter.open(table, {{"filter", "status = 'done'"}}); !err.empty()) ...
+     * std::string chunk;
+     * while (exporter.next(chunk)) out << chunk;
+     * @endcode
+     */
+    class RecordExporter
+    {
+    public:
+        ///> Rows fetched per round trip from a PostgreSQL cursor
+        static constexpr size_t FETCH_SIZE = 1000;
+        ///> Chunks are flushed once they grow past this size
+        static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+        /**
+         * @brief Create an exporter.
+         * @param format `ndjson` or `csv`
+         * @throw std::invalid_argument for unsupported formats
+         */
+        explicit RecordExporter(std::string format);
+        ~RecordExporter();
+
+        RecordExporter(const RecordExporter&) = delete;
+        RecordExporter& operator=(const RecordExporter&) = delete;
+
+        /// Concurrent exports allowed, half the read pool and at least one.
+        static size_t slots();
+
+        /**
+         * @brief Take an export slot, held until the exporter is destroyed.
+         * @param limit Concurrent exports allowed, see @see slots()
+         * @return `false` if `limit` exports are running already
+         */
+        bool acquire(size_t limit);
+
+        /**
+         * @brief Run the export query and position the cursor before the first record.
+         * @param table Table to export
+         * @param opts `filter`, `sort` & `fields` options, same as for @see TableUnit::list_records()
+         * @return Error message if the options were invalid, else an empty string
+         */
+        std::string open(TableUnit& table, const json& opts);
+
+        /**
+         * @brief Serialize the next records, up to about @see CHUNK_SIZE bytes.
+         * @param chunk Serialized records, replaced
+         * @return `false` once all records were written, `chunk` is empty then
+         */
+        bool next(std::string& chunk);
+
+        /// Response content type of the export format.
+        [[nodiscard]] std::string contentType() const;
+
+        /// Records written so far.
+        [[nodiscard]] size_t rows() const;
+
+        /// Append `value` to `out` as a CSV field, quoted if it holds separators, quotes or line breaks.
+        static void appendCsvField(std::string& out, std::string_view value);
+
+        const std::string __class_name__ = "mantis::RecordExporter";
+
+    private:
+        /// Move to the next row of the cursor, fetching the next batch on PostgreSQL.
+        bool fetch();
+
+        /// Resolve the output columns from the first row, and the CSV header from them.
+        void resolveColumns(std::string& chunk);
+
+        void writeCsvRow(std::string& chunk);
+
+        std::string m_format;
+        std::string m_tableName;
+        std::string m_tableType;
+        std::vector<json> m_fields;
+        std::vector<std::string> m_header; ///> Selected columns, for the CSV header of empty exports
+
+        std::shared_ptr<soci::session> m_sql;
+        std::unique_ptr<soci::transaction> m_tr; ///> Cursors only live within a transaction
+        std::unique_ptr<soci::statement> m_stmt;
+        std::unique_ptr<soci::row> m_row;
+        soci::values m_values; ///> Bound filter values, must outlive the statement execution
+
+        bool m_slot = false; ///> Holds one of the export slots
+        bool m_cursor = false; ///> PostgreSQL cursor, fetched in batches
+        bool m_pending = false; ///> Row fetched ahead, not written yet
+        bool m_done = false;
+        size_t m_batchRows = 0;
+        size_t m_rows = 0;
+        std::vector<TableUnit::RowColumn> m_columns;
+        std::string m_scratch;
+    };
+}
+
+#endif //EXPORTER_H
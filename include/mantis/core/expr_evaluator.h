@@ -6,6 +6,8 @@
 #ifndef EXPR_EVALUATOR_H
 #define EXPR_EVALUATOR_H
 
+#include <memory>
+#include <set>
 #include <string>
 #include <shunting-yard.h>
 #include <containers.h>
@@ -22,6 +24,33 @@ namespace mantis
     using cparse::packToken;
     using json = nlohmann::json;
 
+    /**
+     * @brief Fields of a rule variable, e.g. `auth`, the rule reads; so only these are converted
+     * for evaluation.
+     */
+    struct RuleVarRefs
+    {
+        bool used = false; ///> Variable appears in the rule
+        bool all = false; ///> Read as a whole or by a computed key, all fields are needed
+        std::set<std::string> fields; ///> Top level fields read, e.g. `id` of `auth.id`
+
+        /// Whether the rule may read `field`.
+        [[nodiscard]] bool reads(const std::string& field) const { return all || fields.contains(field); }
+    };
+
+    /**
+     * @brief Access rule compiled into its RPN program, @see ExprEvaluator::compile(), so
+     * evaluating it doesn't tokenize & parse the expression again.
+     */
+    struct CompiledRule
+    {
+        std::string expr; ///> Trimmed rule expression, empty for admin only access
+        std::shared_ptr<const calculator> program; ///> `nullptr` for empty or invalid rules
+        std::string error; ///> Why the expression didn't compile, such rules deny access
+        RuleVarRefs auth; ///> What the rule reads of the `auth` user
+        RuleVarRefs req; ///> What the rule reads of the `req` request info
+    };
+
     /**
      * @brief Struct instance for handling evaluation of database access rules.
      */
@@ -47,6 +76,24 @@ namespace mantis
          */
         auto evaluate(const std::string& expr, const json& vars) -> bool;
 
+        /**
+         * @brief Evaluates a compiled rule in a context of the given TokenMap variables.
+         *
+         * @param rule Compiled access rule, rules that didn't compile evaluate to false
+         * @param vars Parameter tokens
+         * @return True or False
+         */
+        auto evaluate(const CompiledRule& rule, const TokenMap& vars) -> bool;
+
+        /**
+         * @brief Compile an expression into its RPN program. Variables are left unresolved,
+         * they are looked up on every evaluation; the `auth` & `req` fields read are recorded.
+         *
+         * @param expr Access rule expression
+         * @return Compiled rule, with the `error` set if the expression isn't valid
+         */
+        static CompiledRule compile(const std::string& expr);
+
         /**
          * @brief Convert a given JSON Object to the equivalent TokenMap so that we can pass it to the evaluator.
          *
@@ -0,0 +1,177 @@
+/**
+ * @file importer.h
+ * @brief Bulk import of CSV, NDJSON & JSON array files into a table, in batched transactions.
+ */
+
+#ifndef IMPORTER_H
+#define IMPORTER_H
+
+#include <chrono>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+#include <soci/soci.h>
+#include <nlohmann/json.hpp>
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    class TableUnit;
+
+    ///> Progress of an import, reported after every committed batch
+    struct ImportStats
+    {
+        size_t rows = 0; ///> Rows read so far
+        size_t inserted = 0; ///> Rows committed
+        size_t skipped = 0; ///> Invalid rows left out, see @see RecordImporter::setSkipInvalid()
+        size_t batches = 0; ///> Committed transactions
+        std::vector<std::string> errors; ///> First row errors, up to @see RecordImporter::MAX_REPORTED_ERRORS
+        std::chrono::milliseconds elapsed{0};
+
+        [[nodiscard]] json toJson() const;
+    };
+
+    /**
+     * @brief Streams records from a file into a table, without ever holding more than a batch.
+     *
+     * Rows are read one at a time, validated against the table fields as for record creation,
+     * then inserted @see batchSize() rows per transaction: multi-row `INSERT`s on SQLite and
+     * `COPY ... FROM STDIN` on PostgreSQL. Rows keep their `id` if given, else one is generated
+     * as per the table's id strategy.
+     *
+     * Formats:
+     *  - `csv`: RFC 4180, a header row of field names followed by records. Values are converted
+     *    to the field types, empty values are imported as `null`.
+     *  - `ndjson`: One JSON object per line.
+     *  - `json`: A JSON array of objects, read one element at a time.
+     *
+     * Each batch commits on its own; if the import fails, the batches committed before it stay
+     * and @see ImportStats::inserted says how far it got.
+     *
+     * @code
+     * RecordImporter importer(table, "csv");
+     * importer.onProgress([](const ImportStats& s) { Log::info("{} rows imported", s.inserted); });
+     * std::ifstream file("posts.csv", std::ios::binary);
+     * const auto stats = importer.run(file);
+     * @endcode
+     */
+    class RecordImporter
+    {
+    public:
+        ///> Rows committed per transaction, by default
+        static constexpr size_t DEFAULT_BATCH_SIZE = 5000;
+        ///> Upper bound of @see batchSize(), a batch is held in memory until committed
+        static constexpr size_t MAX_BATCH_SIZE = 10000;
+        ///> Bound values per `INSERT` statement, SQLite's lowest default limit
+        static constexpr size_t MAX_BIND_PARAMS = 999;
+        ///> Row errors kept in the import stats
+        static constexpr size_t MAX_REPORTED_ERRORS = 20;
+
+        using ProgressCallback = std::function<void(const ImportStats&)>;
+
+        /**
+         * @brief Create an importer for a table.
+         * @param table Table to import into, must not be a view
+         * @param format `csv`, `ndjson` or `json`
+         * @throw std::invalid_argument for views or unsupported formats
+         */
+        RecordImporter(TableUnit& table, std::string format);
+
+        /// Rows committed per transaction, clamped between one and @see MAX_BATCH_SIZE.
+        void setBatchSize(size_t size);
+
+        /**
+         * @brief Parse a batch size given as text, e.g. a query parameter.
+         * @throw std::invalid_argument unless it's an integer between 1 and @see MAX_BATCH_SIZE
+         */
+        static size_t parseBatchSize(const std::string& value);
+        [[nodiscard]] size_t batchSize() const;
+
+        /// Leave out invalid rows instead of failing the import on the first one.
+        void setSkipInvalid(bool skip);
+
+        /// Called after every committed batch.
+        void onProgress(ProgressCallback callback);
+
+        /**
+         * @brief Import all rows from `in`.
+         * @param in Input stream, open in binary mode
+         * @return Import stats
+         * @throw std::invalid_argument on malformed input or, unless skipped, invalid rows
+         * @throw std::runtime_error / soci::soci_error when writing fails
+         */
+        ImportStats run(std::istream& in);
+
+        /// Stats of the last run, also after it failed.
+        [[nodiscard]] const ImportStats& stats() const;
+
+        /// Import format from a file extension, `.csv`, `.ndjson`/`.jsonl` or `.json`; empty if unknown.
+        static std::string formatFromPath(const std::string& path);
+
+        /**
+         * @brief Read the next CSV record, fields may be quoted & span lines.
+         * @param in Input stream
+         * @param fields Record fields, replaced
+         * @return `false` at the end of the input
+         * @throw std::invalid_argument for unterminated quoted fields
+         */
+        static bool readCsvRecord(std::istream& in, std::vector<std::string>& fields);
+
+        /**
+         * @brief Read the next element of a top level JSON array, without parsing the rest of it.
+         * @param in Input stream
+         * @param element Raw JSON text of the element, replaced
+         * @param started Whether the opening `[` was read, `false` on the first call
+         * @return `false` after the last element
+         * @throw std::invalid_argument if the input is not a JSON array of objects
+         */
+        static bool readJsonArrayElement(std::istream& in, std::string& element, bool& started);
+
+        const std::string __class_name__ = "mantis::RecordImporter";
+
+    private:
+        ///> Row validated & ready to insert
+        struct Row
+        {
+            json entity;
+            bool hasId = false; ///> `id` was given, never regenerated on conflicts
+        };
+
+        /**
+         * @brief Read the next row as a JSON object.
+         * @param in Input stream
+         * @param row Row read
+         * @param error Set if the row could not be read, e.g. malformed values
+         * @return `false` at the end of the input
+         */
+        bool nextRow(std::istream& in, json& row, std::string& error);
+
+        /// Convert a CSV value to the JSON type of its field.
+        json csvValue(const std::string& name, const std::string& value) const;
+
+        /// Insert a batch in one transaction, retrying generated ids on conflicts.
+        void insertBatch(std::vector<Row>& batch);
+
+        void insertRows(soci::session& sql, const std::vector<Row*>& rows, const std::vector<std::string>& columns,
+                        const std::tm& now) const;
+#if MANTIS_HAS_POSTGRESQL
+        void copyRows(soci::session& sql, const std::vector<Row*>& rows, const std::vector<std::string>& columns,
+                      const std::tm& now) const;
+#endif
+
+        TableUnit& m_table;
+        std::string m_tableName;
+        std::string m_format;
+        size_t m_batchSize = DEFAULT_BATCH_SIZE;
+        bool m_skipInvalid = false;
+        ProgressCallback m_onProgress;
+
+        std::vector<std::string> m_csvHeader;
+        bool m_started = false;
+        ImportStats m_stats;
+    };
+}
+
+#endif //IMPORTER_H
@@ -0,0 +1,83 @@
+/**
+ * @file json_writer.h
+ * @brief Minimal append-only JSON text writer, for serializing query results without building a json DOM.
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    /**
+     * @brief Writes compact JSON text straight into a string buffer.
+     *
+     * Output is compact like `nlohmann::json::dump()`, writing object keys in sorted order
+     * yields the same documents as responses built from `json` objects. The writer does
+     * not validate nesting, callers are expected to pair begin/end calls.
+     *
+     * @code
+     * std::string body;
+     * JsonWriter w(body);
+     * w.beginObject();
+     * w.key("data"); w.beginArray(); w.value(1); w.value("two"); w.endArray();
+     * w.key("status"); w.value(200);
+     * w.endObject(); // body = {"data":[1,"two"],"status":200}
+     * @endcode
+     */
+    class JsonWriter
+    {
+    public:
+        explicit JsonWriter(std::string& out);
+
+        void beginObject();
+        void endObject();
+        void beginArray();
+        void endArray();
+
+        /// Write an object key, must be followed by exactly one value.
+        void key(std::string_view k);
+
+        void value(std::string_view v);
+        void value(const std::string& v) { value(std::string_view(v)); }
+        void value(const char* v);
+        void value(bool v);
+        void value(int64_t v);
+        void value(uint64_t v);
+        void value(int v) { value(static_cast<int64_t>(v)); }
+        void value(double v);
+        void value(const json& v);
+        void null();
+
+        /// Write an already serialized JSON value as is.
+        void raw(std::string_view serialized);
+
+        /**
+         * @brief Write serialized JSON from outside, e.g. a JSON column, as `json::dump()` would:
+         * nested object keys sorted and strings checked to be valid UTF-8.
+         * @throw std::invalid_argument if `serialized` isn't valid JSON
+         */
+        void jsonText(std::string_view serialized);
+
+        /// Append `v` to `out` as a quoted & escaped JSON string.
+        static void escape(std::string& out, std::string_view v);
+
+    private:
+        /// Write the separator needed before the next value or key.
+        void separate();
+
+        std::string& m_out;
+        // One entry per open container, `true` once it holds at least one element
+        std::vector<bool> m_hasElements;
+        bool m_afterKey = false;
+    };
+}
+
+#endif //JSON_WRITER_H
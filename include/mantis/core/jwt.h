@@ -10,6 +10,7 @@
 
 #include <string>
 #include "../utils/utils.h"
+#include "token_cache.h"
 
 namespace mantis
 {
@@ -35,10 +36,16 @@ namespace mantis
          * If verification failed, the error JSON key of the response will have the error value. If everything went well,
          * all the other JSON fields will be filled with extracted values.
          *
+         * Verified tokens are cached until they expire, @see TokenCache, later calls with the same
+         * token skip the decoding & signature check.
+         *
          * @param token JWT Token
          * @return JSON Object having a `id`, `table`, `verified` and `error` values.
          */
         static json verifyJwtToken(const std::string& token);
+
+        /// Cache of verified tokens, shared by all requests.
+        static TokenCache& tokenCache();
     };
 } // mantis
 
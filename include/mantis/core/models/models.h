@@ -97,6 +97,11 @@ namespace mantis
 
     bool isValidFieldType(const std::string& fieldType);
 
+    // Record id strategies, `random` short ids or time-ordered `sortable` ids
+    const std::vector<std::string> idStrategies = {"random", "sortable"};
+
+    bool isValidIdStrategy(const std::string& strategy);
+
     // Access rule expression
     typedef std::string Rule;
 
@@ -115,6 +120,7 @@ namespace mantis
         std::optional<double> minValue;
         std::optional<double> maxValue;
         bool isUnique = false;
+        bool isIndexed = false; // single column secondary index, see Table::schemaIndexes()
         std::optional<std::string> validator;
         std::optional<std::string> autoGeneratePattern; // regex for auto-gen strings
 
@@ -132,6 +138,46 @@ namespace mantis
         static soci::db_type toSociType(const FieldType& f_type);
     };
 
+    // Secondary index definition, declared in the table schema
+    struct Index
+    {
+        std::string name;
+        std::vector<std::string> columns; // Column names, prefixed with `-` for descending order
+        bool unique = false;
+        std::optional<std::string> where; // Condition for partial indexes, a filter expression, see `QueryFilter`
+        std::string condition; // `where` compiled to SQL against the table fields, by `Table::schemaIndexes()`
+        std::vector<std::string> conditionColumns; // Columns `where` compares
+
+        [[nodiscard]]
+        json to_json() const;
+
+        /**
+         * @brief Parse & validate an index definition from the table schema.
+         *
+         * @param j Index object, `{"name": "...", "columns": [...], "unique": false, "where": "..."}`
+         * @param table Table name, used to name the index if no name is given
+         * @return Index definition
+         * @throw std::invalid_argument on missing or malformed columns & names, or names starting with `__`
+         */
+        static Index from_json(const json& j, const std::string& table);
+
+        /**
+         * @brief `CREATE [UNIQUE] INDEX IF NOT EXISTS ...` statement for this index on `table`.
+         * @throw std::logic_error if `where` wasn't compiled yet
+         */
+        [[nodiscard]]
+        std::string to_sql(const std::string& table) const;
+
+        /// Whether the index covers `column`, or its condition compares it.
+        [[nodiscard]]
+        bool references(const std::string& column) const;
+
+        /// Default index name, `idx_<table>_<col1>_<col2>...`
+        static std::string defaultName(const std::string& table, const std::vector<std::string>& columns);
+
+        bool operator==(const Index& other) const = default;
+    };
+
     // Represents a generic table in the system
     struct Table
     {
@@ -141,8 +187,11 @@ namespace mantis
         TableType type;
         bool system = false;
         bool has_api = true;
+        std::string idStrategy = "random"; // How record ids are generated, see `idStrategies`
+        bool sync = false; // Changes logged for incremental sync, see `SyncLog`
 
         std::vector<Field> fields;
+        std::vector<Index> indexes;
 
         Rule listRule;
         Rule getRule;
@@ -158,6 +207,42 @@ namespace mantis
 
         [[nodiscard]]
         virtual std::string to_sql() const;
+
+        /**
+         * @brief Index statements to run once the table is created by @see to_sql().
+         *
+         * Kept apart from the `CREATE TABLE` statement, as SQLite only executes the first
+         * statement of a query string.
+         *
+         * @return One SQL statement per index
+         */
+        [[nodiscard]]
+        virtual std::vector<std::string> to_index_sql() const;
+
+        /**
+         * @brief Index backing keyset (cursor) pagination on `(created, id)`.
+         * @param table Table name
+         * @return `CREATE INDEX IF NOT EXISTS ...` statement
+         */
+        static std::string keysetIndexSql(const std::string& table);
+
+        /// Name of the keyset pagination index for `table`, `__keyset_<table>`; user index names can't start with `__`.
+        static std::string keysetIndexName(const std::string& table);
+
+        /// Keyset index name of older versions, which a user index on `(created, id)` would also get by default.
+        static std::string legacyKeysetIndexName(const std::string& table);
+
+        /**
+         * @brief Secondary indexes declared in a table schema, as stored in `__tables`.
+         *
+         * Collects the single column indexes of fields flagged `indexed` and the table level
+         * `indexes` definitions, checking that all indexed columns exist in the schema.
+         *
+         * @param schema Table schema json, see @see to_json()
+         * @return Index definitions, empty for views
+         * @throw std::invalid_argument on invalid definitions or unknown columns
+         */
+        static std::vector<Index> schemaIndexes(const json& schema);
     };
 
     // Specific model for Base table (user-defined)
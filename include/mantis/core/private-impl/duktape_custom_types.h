@@ -190,9 +190,22 @@ namespace mantis
         void setFileContent(const std::string& path, const std::string& content_type) const;
         void setFileContent(const std::string& path) const;
 
+        /**
+         * @brief Stream the response body with chunked transfer encoding, as the provider
+         * produces it, instead of building it in memory.
+         * @param content_type Response content type
+         * @param provider Called for the next chunk until it calls `sink.done()` or returns false
+         * @param releaser Called once the response is over, whether or not it completed
+         */
+        void setChunkedContentProvider(const std::string& content_type,
+                                       httplib::ContentProviderWithoutLength provider,
+                                       httplib::ContentProviderResourceReleaser releaser = nullptr) const;
+
         void send(int statusCode, const std::string& data = "", const std::string& content_type= "text/plain") const;
         void sendJson(int statusCode = 200, const json& data = json::object()) const;
         void sendJson(int statusCode, const DukValue& data) const;
+        ///> Send an already serialized JSON body, avoiding a copy of large responses
+        void sendRawJson(int statusCode, std::string&& data) const;
         void sendText(int statusCode = 200, const std::string& data = "") const;
         void sendHtml(int statusCode = 200, const std::string& data = "<p></p>") const;
         void sendEmpty(int statusCode = 204) const;
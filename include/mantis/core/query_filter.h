@@ -0,0 +1,107 @@
+/**
+ * @file query_filter.h
+ * @brief Parser for the `filter` & `sort` list query parameters, compiled into parameterized SQL.
+ */
+
+#ifndef QUERY_FILTER_H
+#define QUERY_FILTER_H
+
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include <soci/soci.h>
+#include <nlohmann/json.hpp>
+
+namespace mantis
+{
+    ///> Bound value of a compiled filter, by its placeholder name
+    struct QueryParam
+    {
+        std::string name;
+        std::variant<std::string, long long, double, std::tm> value;
+    };
+
+    ///> SQL fragments compiled from the `filter` & `sort` parameters
+    struct CompiledQuery
+    {
+        std::string where; ///> Condition without the `WHERE` keyword, empty if not filtering
+        std::string orderBy; ///> Sort expression without `ORDER BY`, empty for the default sort
+        std::vector<QueryParam> params;
+        std::vector<std::string> columns; ///> Columns the filter compares, in order of appearance
+    };
+
+    /**
+     * @brief Compiles list filters & sorting into SQL, validated against the table columns.
+     *
+     * Filter syntax, comparisons joined by `&&` / `||` and grouped with parentheses:
+     * @code
+     * filter=(age >= 18 && verified = true) || name ~ 'john'
+     * sort=-created,name
+     * @endcode
+     *
+     * Supported operators are `=`, `!=`, `>`, `>=`, `<`, `<=`, `~` (contains, `LIKE`) and `!~`;
+     * `~` matches its value literally, `%` & `_` in it are no wildcards.
+     * Values are quoted strings, numbers, `true`/`false` or `null` (only with `=`/`!=`). Sort
+     * fields are comma separated, prefixed with `-` for descending order.
+     *
+     * Only scalar columns can be used, JSON, list, file list & blob columns as well as any
+     * `password` column are rejected. Values are bound as parameters, only inlined for partial
+     * index conditions, @see compileLiteral().
+     */
+    class QueryFilter
+    {
+    public:
+        ///> Maximum number of comparisons in a single filter
+        static constexpr size_t MAX_CONDITIONS = 50;
+        ///> Maximum nesting of parentheses
+        static constexpr size_t MAX_DEPTH = 8;
+        ///> Maximum number of sort fields
+        static constexpr size_t MAX_SORT_FIELDS = 8;
+
+        /**
+         * @brief Create a filter compiler for a table.
+         * @param fields Table schema fields, as in `TableUnit::fields()`
+         */
+        explicit QueryFilter(const std::vector<nlohmann::json>& fields);
+
+        /**
+         * @brief Compile the `filter` & `sort` expressions.
+         *
+         * @param filter Filter expression, may be empty
+         * @param sort Sort expression, may be empty
+         * @return Compiled SQL fragments & values to bind
+         * @throw std::invalid_argument on syntax errors or columns that can't be filtered/sorted on
+         */
+        [[nodiscard]] CompiledQuery compile(const std::string& filter, const std::string& sort) const;
+
+        /**
+         * @brief Compile a filter expression with its values inlined as SQL literals, for
+         * statements that can't bind values, e.g. the condition of a partial index.
+         *
+         * @param filter Filter expression
+         * @return Compiled condition, without parameters
+         * @throw std::invalid_argument on syntax errors or columns that can't be filtered on
+         */
+        [[nodiscard]] CompiledQuery compileLiteral(const std::string& filter) const;
+
+        /// Add the compiled values to `vals`, for binding by name.
+        static void bind(soci::values& vals, const std::vector<QueryParam>& params);
+
+        /// Whether columns of the given field type can be filtered & sorted on.
+        static bool isFilterableType(const std::string& type);
+
+        const std::string __class_name__ = "mantis::QueryFilter";
+
+    private:
+        class Parser;
+
+        std::string compileSort(const std::string& sort) const;
+
+        ///> Filterable column names to their field types
+        std::unordered_map<std::string, std::string> m_columns;
+    };
+}
+
+#endif //QUERY_FILTER_H
@@ -0,0 +1,180 @@
+/**
+ * @file realtime.h
+ * @brief Fan-out of record change events to Server-Sent Events subscribers.
+ */
+
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+#include "change_ring.h"
+#include "tables/tables.h"
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    /// What a subscriber listens to: all records of `table`, or the one record with `id`.
+    struct RealtimeTopic
+    {
+        std::string table;
+        std::string id; ///> Empty for all records of the table
+    };
+
+    /**
+     * @brief Delivers the events of the database change feed to realtime subscribers,
+     * @see ChangeFeed, as Server-Sent Events.
+     *
+     * A single broadcaster thread reads the change ring, matches each event against the
+     * subscriptions of its table and checks access once per subscriber & table: the table's
+     * `listRule` for table subscriptions, its `getRule` for record subscriptions. Rule results
+     * are kept per subscriber until the rule changes. Each event is serialized once and appended
+     * to the buffer of every subscriber allowed to see it; connections only wait on their buffer
+     * and write it out, so idle streams cost no work.
+     *
+     * Streams end once the subscriber's token expires. Users updated or deleted, @see AuthCache,
+     * are read again before their next event, a deleted user's stream ends.
+     *
+     * Events carry the record id, not the record, clients fetch what they need through the
+     * regular endpoints. A subscriber whose buffer overflows, or a broadcaster losing events to
+     * the ring, gets a `reset` event instead: state may have been missed, refetch it.
+     */
+    class RealtimeHub
+    {
+    public:
+        ///> Buffered bytes per subscriber before it's sent a `reset` instead
+        static constexpr size_t MAX_PENDING_BYTES = 256 * 1024;
+        ///> Topics per subscription
+        static constexpr size_t MAX_TOPICS = 64;
+        ///> Idle streams get an SSE comment this often, keeping proxies from closing them
+        static constexpr auto HEARTBEAT = std::chrono::seconds(15);
+
+        /// Table the events of `name` belong to, `nullptr` if it has no API.
+        using TableLookup = std::function<std::shared_ptr<TableUnit>(const std::string& name)>;
+
+        struct Subscriber
+        {
+            std::vector<RealtimeTopic> topics;
+            json auth; ///> Request `auth` object, @see TableUnit::resolveAuth()
+            TokenMap reqVars;
+            std::string userTable; ///> Logged-in user, empty for guests
+            std::string userId;
+            int64_t expires = 0; ///> Token `exp`, seconds since epoch, `0` if it doesn't expire
+            std::atomic<bool> reauth{false}; ///> User changed, read it again before the next event
+
+            // Broadcaster thread only: rule evaluated last & its result, by `table|list` or `table|get`
+            std::unordered_map<std::string, std::pair<std::string, bool>> access;
+
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::string pending; ///> Frames not written yet
+            bool closed = false;
+        };
+
+        /**
+         * @brief Create the hub.
+         * @param lookup Resolves event tables to their table unit, for access rules
+         * @param maxSubscribers Concurrent subscribers, further ones are turned away
+         */
+        RealtimeHub(TableLookup lookup, size_t maxSubscribers);
+        ~RealtimeHub();
+
+        RealtimeHub(const RealtimeHub&) = delete;
+        RealtimeHub& operator=(const RealtimeHub&) = delete;
+
+        /// Start the broadcaster thread, from the current end of the change feed.
+        void start();
+
+        /// Stop the broadcaster thread and end all streams.
+        void stop();
+
+        /**
+         * @brief Register a subscriber.
+         * @param expires Token `exp` claim, the stream ends then; `0` for guests
+         * @return Subscriber to stream, `nullptr` if the hub is full or stopped
+         */
+        std::shared_ptr<Subscriber> subscribe(std::vector<RealtimeTopic> topics, json auth, TokenMap reqVars,
+                                              int64_t expires);
+
+        /// Remove a subscriber, once its stream is over.
+        void unsubscribe(const std::shared_ptr<Subscriber>& subscriber);
+
+        /**
+         * @brief Have the subscribers of an invalidated user read it again, @see AuthCache::Listener.
+         * @param table User table, empty for all users
+         * @param id User id, empty for all users of `table`
+         */
+        void invalidateUser(const std::string& table, const std::string& id);
+
+        /**
+         * @brief Wait for the next frames of a subscriber, up to @see HEARTBEAT.
+         * @param subscriber Subscriber streamed
+         * @param out Frames to write, a heartbeat comment if none came in time
+         * @return `false` once the subscriber was closed or its token expired
+         */
+        bool next(Subscriber& subscriber, std::string& out) const;
+
+        /**
+         * @brief Parse the `subscribe` parameter: comma separated `table` or `table/id` topics.
+         * @param value Parameter value
+         * @param error Set if the value isn't valid
+         * @return Topics, empty on errors
+         */
+        static std::vector<RealtimeTopic> parseTopics(std::string_view value, std::string& error);
+
+        /// SSE frame of a change event: its `seq` as the event id, `op` as the event name.
+        static std::string formatEvent(const ChangeEvent& event);
+
+        /// Subscriber & delivery counters as a JSON object.
+        [[nodiscard]] json stats() const;
+
+        const std::string __class_name__ = "mantis::RealtimeHub";
+
+    private:
+        void run();
+        void dispatch(const ChangeEvent& event);
+
+        /// Append `frame` to the subscriber's buffer, a `reset` replaces it if full.
+        void push(Subscriber& subscriber, const std::string& frame);
+
+        /// Whether the subscriber may read records of `table`, all of them or by id.
+        static bool canRead(Subscriber& subscriber, TableUnit& table, bool record);
+
+        /// Whether the subscriber's token & user are still valid, closing it if not; broadcaster thread only.
+        static bool authorized(Subscriber& subscriber);
+
+        /// End the subscriber's stream.
+        static void close(Subscriber& subscriber);
+
+        TableLookup m_lookup;
+        size_t m_maxSubscribers;
+
+        std::thread m_thread;
+        std::atomic<bool> m_stop{false};
+
+        mutable std::shared_mutex m_mutex;
+        std::unordered_map<std::string, std::vector<std::shared_ptr<Subscriber>>> m_byTable;
+        size_t m_subscribers = 0;
+        bool m_running = false;
+
+        std::atomic<uint64_t> m_events{0};
+        std::atomic<uint64_t> m_delivered{0};
+        std::atomic<uint64_t> m_resets{0};
+    };
+}
+
+#endif //REALTIME_H
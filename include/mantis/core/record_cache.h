@@ -0,0 +1,117 @@
+/**
+ * @file record_cache.h
+ * @brief In-memory read-through cache of serialized records, serving hot point reads without the database.
+ */
+
+#ifndef RECORD_CACHE_H
+#define RECORD_CACHE_H
+
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+#include "sharded_ttl_cache.h"
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    /**
+     * @brief Size bounded, sharded LRU cache of records keyed by table & id, set through the
+     * `recordCache` setting.
+     *
+     * @code
+     * "recordCache": {
+     *     "enabled": false,      // Default for tables not listed below
+     *     "maxEntries": 10000,   // Records kept across all tables
+     *     "ttl": 60,             // Seconds a cached record is served, `<= 0` until invalidated
+     *     "tables": {"profiles": {"enabled": true, "ttl": 300}}
+     * }
+     * @endcode
+     *
+     * Records are cached by @see TableUnit::read() and dropped synchronously once an update or
+     * delete through the API commits, or once the table schema changes. Writes bypassing the
+     * API, e.g. raw SQL from JS, are caught by @see clear() or else served stale up to the TTL.
+     *
+     * Records are kept in a @see ShardedTtlCache, a record read from the database is only
+     * stored if its shard wasn't invalidated since the read started.
+     */
+    class RecordCache
+    {
+    public:
+        ///> Independently locked shards, keys are spread over them by hash
+        static constexpr size_t SHARDS = ShardedTtlCache<std::string, std::string>::SHARDS;
+
+        RecordCache() = default;
+
+        /**
+         * @brief Apply the `recordCache` setting, dropping all cached records.
+         * @param config Setting object, missing keys take the defaults
+         */
+        void configure(const json& config);
+
+        /**
+         * @brief Check a `recordCache` setting before it's stored or applied.
+         * @param config Setting object
+         * @throws std::invalid_argument On unknown keys or values of the wrong type or range
+         */
+        static void validate(const json& config);
+
+        /// Whether records of `table` are cached.
+        [[nodiscard]] bool enabled(const std::string& table) const;
+
+        /**
+         * @brief Cached record of `table` with `id`.
+         * @return Serialized record, or std::nullopt if missing or expired
+         */
+        std::optional<std::string> get(const std::string& table, const std::string& id);
+
+        /// Generation of the shard holding `id`, to be taken before reading the record from the database.
+        [[nodiscard]] uint64_t generation(const std::string& table, const std::string& id) const;
+
+        /**
+         * @brief Cache a record read from the database, evicting the least recently used records
+         * of the shard if full.
+         * @param table Table name
+         * @param id Record id
+         * @param record Serialized record
+         * @param generation From @see generation(), taken before the record was read
+         */
+        void put(const std::string& table, const std::string& id, std::string record, uint64_t generation);
+
+        /// Drop the record of `table` with `id`, once it was updated or deleted.
+        void invalidate(const std::string& table, const std::string& id);
+
+        /// Drop all records of `table`, e.g. once its schema changed.
+        void invalidate(const std::string& table);
+
+        /// Drop all records
+        void clear();
+
+        /// Hit/miss & eviction counters as a JSON object.
+        [[nodiscard]] json stats() const;
+
+        const std::string __class_name__ = "mantis::RecordCache";
+
+    private:
+        struct TableConfig
+        {
+            bool enabled = false;
+            int64_t ttlSeconds = 60;
+        };
+
+        static std::string key(const std::string& table, const std::string& id);
+        TableConfig tableConfig(const std::string& table) const;
+
+        mutable std::shared_mutex m_configMutex;
+        TableConfig m_defaults;
+        std::unordered_map<std::string, TableConfig> m_tables;
+
+        ShardedTtlCache<std::string, std::string> m_records{10000}; ///> Serialized records by @see key()
+    };
+}
+
+#endif //RECORD_CACHE_H
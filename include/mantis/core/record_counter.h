@@ -0,0 +1,119 @@
+/**
+ * @file record_counter.h
+ * @brief In-memory per-table record counts, saving a full table scan on every paginated list request.
+ */
+
+#ifndef RECORD_COUNTER_H
+#define RECORD_COUNTER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    /**
+     * @brief How record counts for list pagination are obtained, set through the
+     * `recordCountMode` setting.
+     */
+    enum class RecordCountMode
+    {
+        Exact, ///> Run `COUNT` on every request
+        Maintained, ///> Count once, then adjust on record create/delete, resynced every TTL
+        Periodic ///> Count once per TTL, serving the cached value in between
+    };
+
+    /**
+     * @brief Cache of per-table record counts.
+     *
+     * Counts are loaded lazily through the callback passed to @see get(). In `Maintained`
+     * mode, record creation and deletion through the API adjust the cached value, writes
+     * bypassing the API (e.g. raw SQL from JS) are picked up on the next resync.
+     *
+     * Each table carries a generation bumped by every adjustment, a count is only stored if
+     * no record was created or deleted while it ran, as the `COUNT` may or may not have seen
+     * those records.
+     */
+    class RecordCounter
+    {
+    public:
+        using CountFunc = std::function<int64_t()>;
+
+        RecordCounter() = default;
+
+        /**
+         * @brief Set the counting mode and how long a loaded count is trusted.
+         * @param mode One of `exact`, `maintained` or `periodic`, anything else is taken as `maintained`
+         * @param ttlSeconds Seconds before a cached count is reloaded, `<= 0` keeps it until invalidated
+         */
+        void configure(const std::string& mode, int64_t ttlSeconds);
+
+        /**
+         * @brief Record count of `table`, served from memory unless missing, stale or in `Exact` mode.
+         * @param table Table name
+         * @param count Callback running the actual `COUNT` query
+         * @return Number of records
+         */
+        int64_t get(const std::string& table, const CountFunc& count);
+
+        /**
+         * @brief Run the `COUNT` query and store its result, for requests asking for an exact count.
+         * @param table Table name
+         * @param count Callback running the actual `COUNT` query
+         * @return Number of records
+         */
+        int64_t refresh(const std::string& table, const CountFunc& count);
+
+        /**
+         * @brief Adjust the cached count of `table` after records were created (`+n`) or deleted (`-n`).
+         * Ignored unless in `Maintained` mode; counts running meanwhile aren't stored.
+         */
+        void add(const std::string& table, int64_t delta);
+
+        /// Drop the cached count of `table`, e.g. once the table is renamed or dropped.
+        void invalidate(const std::string& table);
+
+        /// Drop all cached counts
+        void clear();
+
+        [[nodiscard]] RecordCountMode mode() const;
+
+        /// Counter hit/miss values as a JSON object.
+        [[nodiscard]] json stats() const;
+
+        const std::string __class_name__ = "mantis::RecordCounter";
+
+    private:
+        struct Entry
+        {
+            int64_t value = 0;
+            std::chrono::steady_clock::time_point loaded;
+        };
+
+        /// Generation of `table`, to be taken before counting; m_mutex must be held.
+        uint64_t generation(const std::string& table) const;
+
+        /// Store the count of `table` unless its generation moved on since it was taken.
+        void store(const std::string& table, int64_t value, uint64_t generation);
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, Entry> m_entries;
+        std::unordered_map<std::string, uint64_t> m_generations; ///> Bumped by add() & invalidate()
+        uint64_t m_clears = 0; ///> Bumped by clear(), part of every table's generation
+
+        std::atomic<RecordCountMode> m_mode{RecordCountMode::Maintained};
+        std::atomic<int64_t> m_ttlSeconds{60};
+
+        std::atomic<uint64_t> m_hits{0};
+        std::atomic<uint64_t> m_misses{0};
+    };
+}
+
+#endif //RECORD_COUNTER_H
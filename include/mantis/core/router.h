@@ -6,13 +6,20 @@
 #ifndef MANTIS_SERVER_H
 #define MANTIS_SERVER_H
 
+#include <atomic>
 #include <memory>
+#include <unordered_map>
 #include <vector>
 #include <nlohmann/json.hpp>
 
 #include "dukglue/dukvalue.h"
 #include "../utils/utils.h"
 
+namespace httplib
+{
+    class ContentReader;
+}
+
 namespace mantis
 {
     class MantisRequest;
@@ -21,6 +28,7 @@ namespace mantis
 
     class TableUnit;
     class SysTablesUnit;
+    class RealtimeHub;
 
     /**
      * @brief Router class allows for managing routes as well as acting as a top-wrapper on the HttpUnit.
@@ -72,6 +80,15 @@ namespace mantis
 
         static void registerDuktapeMethods();
 
+        /// Table unit serving `name`, `nullptr` if there's none.
+        [[nodiscard]] std::shared_ptr<TableUnit> findTable(const std::string& name) const;
+
+        /// Table unit of the `__admins` table.
+        [[nodiscard]] std::shared_ptr<TableUnit> adminTable() const;
+
+        ///> Maximum number of operations in a single `/api/v1/batch` request
+        static constexpr size_t MAX_BATCH_OPERATIONS = 1000;
+
         const std::string __class_name__ = "mantis::Router";
 
     private:
@@ -89,6 +106,57 @@ namespace mantis
 
         bool generateMiscEndpoints() const;
 
+        /**
+         * @brief `POST /api/v1/batch` handler, runs create/update/delete operations across
+         * tables in a single transaction.
+         *
+         * The body is an array of operations (or `{"operations": [...]}`), each as
+         * `{"action": "create|update|delete", "table": "...", "id": "...", "data": {...}}`.
+         * Access rules are evaluated once per table & action, all operations are validated
+         * before writing. Any failing operation rolls back the whole batch, else the response
+         * holds one `{status, data}` result per operation, in order.
+         */
+        void batchWrite(MantisRequest& req, MantisResponse& res) const;
+
+        /**
+         * @brief `POST /api/v1/import/:table` handler, bulk imports the request body into a table.
+         *
+         * The body is streamed to a temporary file, then imported with @see RecordImporter. The
+         * format comes from the `format` query parameter or the `Content-Type` (`text/csv`,
+         * `application/x-ndjson` or `application/json`). `skipInvalid=true` leaves out invalid
+         * rows & `batchSize` sets the rows per transaction. Responds with the import stats.
+         */
+        void importRecords(MantisRequest& req, MantisResponse& res, const httplib::ContentReader& reader) const;
+
+        /**
+         * @brief `GET /api/v1/realtime` handler, streams record changes as Server-Sent Events.
+         *
+         * The `subscribe` query parameter lists the topics, comma separated: `table` for all
+         * records of a table, subject to its `listRule`, or `table/id` for a single record,
+         * subject to its `getRule`. EventSource clients can't set headers, so the auth token may
+         * also be passed as the `token` query parameter. @see RealtimeHub
+         */
+        void realtime(MantisRequest& req, MantisResponse& res) const;
+
+        /**
+         * @brief `GET /api/v1/sync/:table` handler, pulls the records changed since the `since`
+         * token, subject to the table's `listRule`.
+         *
+         * Responds with `{records, deleted, since, hasMore}`: the current state of each changed
+         * record, the ids of deleted ones and the token to pull from next. @see SyncLog
+         */
+        void syncPull(MantisRequest& req, MantisResponse& res) const;
+
+        /**
+         * @brief `POST /api/v1/sync/:table` handler, pushes offline changes in one transaction.
+         *
+         * The body is `{"changes": [record, ...], "deleted": [{"id", "updated"}, ...]}`, every
+         * entry with the client's `updated` time. Last write wins: a record newer on the server,
+         * ties included, or deleted on the server after the change is reported as a conflict
+         * rather than written. Responds with the `applied` ids & the `conflicts`.
+         */
+        void syncPush(MantisRequest& req, MantisResponse& res) const;
+
         /**
          * @brief Generate Admin only CRUD endpoints.
          * @return Status whether Admin only CRUD  generation succeeded
@@ -137,6 +205,16 @@ namespace mantis
         std::shared_ptr<TableUnit> m_adminTable;
         std::shared_ptr<SysTablesUnit> m_tableRoutes;
         std::vector<std::shared_ptr<TableUnit>> m_routes = {};
+        std::shared_ptr<RealtimeHub> m_realtime;
+
+        ///> Table units by name, as of the last change to `m_routes`
+        using TableIndex = std::unordered_map<std::string, std::shared_ptr<TableUnit>>;
+
+        /// Publish `m_routes` for @see findTable(), after every change to it.
+        void publishTables();
+
+        ///> Replaced as a whole, never changed in place; readable from any thread, e.g. the realtime broadcaster
+        std::atomic<std::shared_ptr<const TableIndex>> m_tables;
 
     public:
         std::vector<json> adminTableFields = {};
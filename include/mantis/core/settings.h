@@ -67,6 +67,16 @@ namespace mantis
          */
         void setupConfigRoutes();
 
+        /**
+         * @brief Apply the `recordCountMode` & `recordCountTTL` settings to the database record counters.
+         */
+        void applyRecordCountConfig() const;
+
+        /**
+         * @brief Apply the `recordCache` setting to the database record cache.
+         */
+        void applyRecordCacheConfig() const;
+
         // Cache settings config on create/read/update cycles to reduce database reads
         // may not be that significant though...!
         json m_configs;
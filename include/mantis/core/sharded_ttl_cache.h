@@ -0,0 +1,255 @@
+/**
+ * @file sharded_ttl_cache.h
+ * @brief Size bounded, sharded LRU map with per-entry expiry, the storage of the in-memory caches.
+ */
+
+#ifndef SHARDED_TTL_CACHE_H
+#define SHARDED_TTL_CACHE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    /**
+     * @brief Size bounded, sharded LRU map of `K` to `V`, each entry served until it expires.
+     *
+     * Keys are spread over @see SHARDS independently locked shards by `Hash`. A full shard
+     * evicts its least recently used entries; expired entries are dropped as they're looked up.
+     *
+     * Each shard carries a generation bumped by every invalidation. A value read from the
+     * database is only stored if its shard's generation didn't change since the read started,
+     * so a read racing a write can't bring back the old value:
+     * @code
+     * const auto generation = cache.generation(key);
+     * auto value = readFromDatabase(key);
+     * cache.put(key, value, ShardedTtlCache<K, V>::Clock::now() + ttl, generation);
+     * @endcode
+     *
+     * Used by @see RecordCache, @see AuthCache and @see TokenCache.
+     */
+    template <typename K, typename V, typename Hash = std::hash<K>>
+    class ShardedTtlCache
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        ///> Independently locked shards, keys are spread over them by hash
+        static constexpr size_t SHARDS = 16;
+
+        /// @param capacity Entries kept across all shards, `0` keeps none
+        explicit ShardedTtlCache(const size_t capacity)
+        {
+            setCapacity(capacity);
+        }
+
+        ShardedTtlCache(const ShardedTtlCache&) = delete;
+        ShardedTtlCache& operator=(const ShardedTtlCache&) = delete;
+
+        /// Change the entries kept, shards over the new capacity evict as they're written to.
+        void setCapacity(const size_t capacity)
+        {
+            m_shardCapacity = (capacity + SHARDS - 1) / SHARDS;
+        }
+
+        /// Entries kept across all shards, rounded up to a multiple of @see SHARDS.
+        [[nodiscard]] size_t capacity() const
+        {
+            return m_shardCapacity.load() * SHARDS;
+        }
+
+        /**
+         * @brief Value of `key`, marking it most recently used.
+         * @return Copy of the value, or std::nullopt if missing or expired
+         */
+        std::optional<V> get(const K& key)
+        {
+            auto& s = shard(key);
+
+            std::lock_guard lock(s.mutex);
+            const auto it = s.entries.find(key);
+            if (it == s.entries.end())
+            {
+                ++m_misses;
+                return std::nullopt;
+            }
+
+            if (Clock::now() >= it->second->expires)
+            {
+                s.lru.erase(it->second);
+                s.entries.erase(it);
+                ++m_misses;
+                return std::nullopt;
+            }
+
+            s.lru.splice(s.lru.begin(), s.lru, it->second);
+            ++m_hits;
+            return it->second->value;
+        }
+
+        /// Generation of the shard holding `key`, to be taken before reading its value.
+        [[nodiscard]] uint64_t generation(const K& key) const
+        {
+            return shard(key).generation.load();
+        }
+
+        /**
+         * @brief Store `value` under `key` until `expires`, evicting the least recently used
+         * entries of the shard if full.
+         * @param generation From @see generation(), taken before the value was read; the value
+         * isn't stored if the shard was invalidated since. std::nullopt always stores it.
+         */
+        void put(K key, V value, const Clock::time_point expires, const std::optional<uint64_t> generation = std::nullopt)
+        {
+            const auto capacity = m_shardCapacity.load();
+            if (capacity == 0) return;
+
+            auto& s = shard(key);
+            std::lock_guard lock(s.mutex);
+
+            // Invalidated while the value was being read, it may be outdated already
+            if (generation.has_value() && s.generation.load() != generation.value()) return;
+
+            if (const auto it = s.entries.find(key); it != s.entries.end())
+            {
+                it->second->value = std::move(value);
+                it->second->expires = expires;
+                s.lru.splice(s.lru.begin(), s.lru, it->second);
+                return;
+            }
+
+            while (!s.lru.empty() && s.entries.size() >= capacity)
+            {
+                s.entries.erase(s.lru.back().key);
+                s.lru.pop_back();
+                ++m_evictions;
+            }
+
+            s.lru.push_front(Entry{key, std::move(value), expires});
+            s.entries.emplace(std::move(key), s.lru.begin());
+        }
+
+        /// Drop the entry of `key`, e.g. once the value it was read from changed.
+        void invalidate(const K& key)
+        {
+            auto& s = shard(key);
+
+            std::lock_guard lock(s.mutex);
+            ++s.generation;
+            ++m_invalidations;
+
+            if (const auto it = s.entries.find(key); it != s.entries.end())
+            {
+                s.lru.erase(it->second);
+                s.entries.erase(it);
+            }
+        }
+
+        /// Drop all entries `pred(key, value)` holds for, invalidating every shard.
+        template <typename Pred>
+        void invalidateIf(Pred pred)
+        {
+            ++m_invalidations;
+            for (auto& s : m_shards)
+            {
+                std::lock_guard lock(s.mutex);
+                ++s.generation;
+
+                for (auto it = s.lru.begin(); it != s.lru.end();)
+                {
+                    if (!pred(it->key, it->value))
+                    {
+                        ++it;
+                        continue;
+                    }
+
+                    s.entries.erase(it->key);
+                    it = s.lru.erase(it);
+                }
+            }
+        }
+
+        /// Drop all entries, invalidating every shard.
+        void clear()
+        {
+            for (auto& s : m_shards)
+            {
+                std::lock_guard lock(s.mutex);
+                ++s.generation;
+                s.entries.clear();
+                s.lru.clear();
+            }
+        }
+
+        /// Entries held across all shards.
+        [[nodiscard]] size_t size() const
+        {
+            size_t entries = 0;
+            for (const auto& s : m_shards)
+            {
+                std::lock_guard lock(s.mutex);
+                entries += s.entries.size();
+            }
+            return entries;
+        }
+
+        /// Hit/miss, eviction & invalidation counters, entries & capacity as a JSON object.
+        [[nodiscard]] json stats() const
+        {
+            return {
+                {"hits", m_hits.load()},
+                {"misses", m_misses.load()},
+                {"evictions", m_evictions.load()},
+                {"invalidations", m_invalidations.load()},
+                {"entries", size()},
+                {"capacity", capacity()}
+            };
+        }
+
+    private:
+        struct Entry
+        {
+            K key;
+            V value;
+            Clock::time_point expires;
+        };
+
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            std::list<Entry> lru; ///> Most recently used first
+            std::unordered_map<K, typename std::list<Entry>::iterator, Hash> entries;
+            std::atomic<uint64_t> generation{0};
+        };
+
+        Shard& shard(const K& key)
+        {
+            return m_shards[Hash{}(key) % SHARDS];
+        }
+
+        const Shard& shard(const K& key) const
+        {
+            return m_shards[Hash{}(key) % SHARDS];
+        }
+
+        std::array<Shard, SHARDS> m_shards;
+        std::atomic<size_t> m_shardCapacity{0};
+
+        std::atomic<uint64_t> m_hits{0};
+        std::atomic<uint64_t> m_misses{0};
+        std::atomic<uint64_t> m_evictions{0};
+        std::atomic<uint64_t> m_invalidations{0};
+    };
+}
+
+#endif //SHARDED_TTL_CACHE_H
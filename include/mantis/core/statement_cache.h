@@ -0,0 +1,167 @@
+/**
+ * @file statement_cache.h
+ * @brief Per-connection cache of prepared statements for the table CRUD queries.
+ */
+
+#ifndef STATEMENT_CACHE_H
+#define STATEMENT_CACHE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <soci/soci.h>
+#include <nlohmann/json.hpp>
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    class StatementCache;
+
+    /**
+     * @brief RAII handle to a cached prepared statement.
+     *
+     * The handle is only valid while the pooled session it was leased for is held. Once
+     * the handle goes out of scope, any pending rows are drained (so SQLite releases the
+     * read snapshot) and the bound `into`/`use` elements are cleaned up, leaving the
+     * prepared statement ready for the next caller on the same connection.
+     *
+     * @code
+     * soci::row r;
+     * auto st = db().statements().prepare(*sql, "students", "read", [&] {
+     *      return "SELECT * FROM students WHERE id = :id";
+     * });
+     * st->exchange(soci::use(id));
+     * st->exchange(soci::into(r));
+     * st->define_and_bind();
+     * st->execute(true);
+     * @endcode
+     */
+    class CachedStatement
+    {
+    public:
+        CachedStatement(StatementCache& cache, const void* conn, std::string key, soci::statement& stmt, bool& busy);
+        ///> Wraps a one-off statement for sessions not backed by a registered pool.
+        CachedStatement(StatementCache& cache, std::unique_ptr<soci::statement> stmt);
+        ~CachedStatement();
+
+        CachedStatement(const CachedStatement&) = delete;
+        CachedStatement& operator=(const CachedStatement&) = delete;
+
+        soci::statement& operator*() const { return m_stmt; }
+        soci::statement* operator->() const { return &m_stmt; }
+
+    private:
+        StatementCache& m_cache;
+        const void* m_conn;
+        std::string m_key;
+        std::unique_ptr<soci::statement> m_owned;
+        soci::statement& m_stmt;
+        bool* m_busy = nullptr;
+    };
+
+    /**
+     * @brief Cache of prepared `soci::statement` objects bound to each pooled connection.
+     *
+     * Statements are keyed by the connection backend, the table name and an operation key
+     * (e.g. `read`, `delete`, `insert:<columns>`), so the same SQL is only parsed & planned
+     * once per connection. Each table carries a version number; bumping it through
+     * @see invalidate() forces all connections to re-prepare statements for that table the
+     * next time they are used, which is what schema changes (ALTER/RENAME/DROP) rely on.
+     */
+    class StatementCache
+    {
+    public:
+        ///> Upper bound of statements kept per connection, further statements are prepared one-off.
+        static constexpr size_t MAX_STATEMENTS_PER_CONNECTION = 256;
+
+        StatementCache() = default;
+        ~StatementCache() = default;
+
+        /**
+         * @brief Register a connection pool whose sessions may be passed to @see prepare().
+         *
+         * @param pool Connection pool instance, must outlive this cache
+         * @param size Number of sessions in the pool
+         */
+        void addPool(soci::connection_pool& pool, size_t size);
+
+        /**
+         * @brief Register a standalone session whose statements may be cached.
+         * @param sql Session instance, must outlive this cache
+         */
+        void addSession(soci::session& sql);
+
+        /**
+         * @brief Get a prepared statement for `table` and operation `key` on the connection
+         * backing the leased session `sql`, preparing it first if missing or stale.
+         *
+         * @param sql Session leased from one of the registered pools
+         * @param table Table the statement operates on, used for invalidation
+         * @param key Operation key, must uniquely identify the SQL for this table
+         * @param query Builder for the SQL text, only called when the statement has to be prepared
+         * @return RAII handle to the prepared statement
+         */
+        [[nodiscard]]
+        CachedStatement prepare(soci::session& sql,
+                                const std::string& table,
+                                const std::string& key,
+                                const std::function<std::string()>& query);
+
+        /**
+         * @brief Mark all cached statements for `table` as stale across all connections.
+         * @param table Table name
+         */
+        void invalidate(const std::string& table);
+
+        /**
+         * @brief Drop all cached statements, must be called before the pooled sessions are closed.
+         */
+        void clear();
+
+        /// Cache hit/miss counters as a JSON object.
+        [[nodiscard]] json stats() const;
+
+        const std::string __class_name__ = "mantis::StatementCache";
+
+    private:
+        friend class CachedStatement;
+
+        struct Entry
+        {
+            std::unique_ptr<soci::statement> stmt;
+            std::string table;
+            uint64_t version = 0;
+            bool busy = false; ///> Held by a live @see CachedStatement handle
+        };
+
+        struct Connection
+        {
+            soci::session* session = nullptr;
+            uint64_t epoch = 0;
+            std::unordered_map<std::string, Entry> entries;
+        };
+
+        ///> Resolve the cache slot of the pooled session backing the leased session `sql`.
+        Connection* connection(soci::session& sql);
+        ///> Current version of the `table` statements
+        uint64_t version(const std::string& table) const;
+        ///> Remove an entry left in an unknown state after a failed execution.
+        void evict(const void* conn, const std::string& key);
+
+        mutable std::mutex m_mutex;
+        std::vector<soci::session*> m_sessions;
+        std::unordered_map<const void*, std::unique_ptr<Connection>> m_connections;
+        std::unordered_map<std::string, uint64_t> m_versions;
+
+        std::atomic<uint64_t> m_epoch{0};
+        std::atomic<uint64_t> m_hits{0};
+        std::atomic<uint64_t> m_misses{0};
+    };
+}
+
+#endif //STATEMENT_CACHE_H
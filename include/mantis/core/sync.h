@@ -0,0 +1,98 @@
+/**
+ * @file sync.h
+ * @brief Per-table change log for incremental sync: a monotonic sequence per table and tombstones of deleted records.
+ */
+
+#ifndef SYNC_H
+#define SYNC_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <soci/soci.h>
+
+namespace mantis
+{
+    /**
+     * @brief Keeps the `__sync_log` of the base & auth tables with `sync` enabled, read by `/api/v1/sync/:table`.
+     *
+     * Triggers on each table record every insert, update & delete, in the writing transaction,
+     * so writes from the API, imports & raw SQL are all logged alike:
+     *  - `__sync_seq (name, seq)` holds the last sequence number handed out per table. Writers
+     *    bump it first, PostgreSQL writers of a table therefore commit in sequence order.
+     *  - `__sync_log (table_name, record_id, seq, deleted, changed)` holds one row per record,
+     *    moved to the new sequence number on every write. Deleted records stay as tombstones,
+     *    `deleted = 1` & `changed` set to the time of deletion.
+     *
+     * A client pulls the rows with `seq` past the last one it saw, getting each changed record
+     * once however often it changed. Tombstones are kept for as long as the table exists.
+     */
+    class SyncLog
+    {
+    public:
+        ///> Records returned per pull by default, and at most
+        static constexpr int DEFAULT_PULL_LIMIT = 500;
+        static constexpr int MAX_PULL_LIMIT = 5000;
+        ///> Records read per statement by a pull, within SQLite's 999 parameters of builds before 3.32
+        static constexpr size_t PULL_CHUNK = 500;
+
+        /// An entry of the log, @see changesSince()
+        struct Entry
+        {
+            std::string id;
+            int64_t seq = 0;
+            bool deleted = false;
+        };
+
+        /// Create the log tables, and the trigger function on PostgreSQL.
+        static void migrate(soci::session& sql);
+
+        /**
+         * @brief Install the log triggers on `table` if missing, logging its existing records
+         * with sequence number `1` the first time.
+         */
+        static void track(soci::session& sql, const std::string& table);
+
+        /// Move the log of a renamed table to its new name, SQLite triggers are recreated.
+        static void rename(soci::session& sql, const std::string& from, const std::string& to);
+
+        /// Drop the log triggers of `table` if installed, and its log; on disabling sync or ahead of dropping it.
+        static void untrack(soci::session& sql, const std::string& table);
+
+        /**
+         * @brief Entries of `table` changed after `since`, in sequence order.
+         * @param limit Entries read, the caller reads one more than it returns to detect further pages
+         */
+        static std::vector<Entry> changesSince(soci::session& sql, const std::string& table, int64_t since,
+                                               int limit);
+
+        /**
+         * @brief Deletion time of `id`, if it's a tombstone.
+         * @return `changed` of the tombstone, as `YYYY-MM-DD HH:MM:SS`, empty otherwise
+         */
+        static std::string deletedAt(soci::session& sql, const std::string& table, const std::string& id);
+
+        /**
+         * @brief `updated` time of a pushed change as stored, no later than the server's clock.
+         *
+         * The last write wins on `updated`, a client clock running ahead would win every
+         * conflict, and keep winning, until the server caught up with it.
+         *
+         * @param value Client's `updated`
+         * @param now Server time, `YYYY-MM-DD HH:MM:SS`
+         * @return `YYYY-MM-DD HH:MM:SS`, `now` if `value` is later; empty if `value` can't be parsed
+         */
+        static std::string pushedTime(const std::string& value, const std::string& now);
+
+    private:
+        /// Trigger statements logging `table` on SQLite, which has no `TG_TABLE_NAME`.
+        static std::vector<std::string> sqliteTriggers(const std::string& table);
+
+        /// Drop the SQLite triggers of `table`.
+        static void dropSqliteTriggers(soci::session& sql, const std::string& table);
+
+        static bool isPostgres(soci::session& sql);
+    };
+}
+
+#endif //SYNC_H
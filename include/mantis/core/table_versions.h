@@ -0,0 +1,50 @@
+/**
+ * @file table_versions.h
+ * @brief Per-table change versions, for validating cached list responses without querying the database.
+ */
+
+#ifndef TABLE_VERSIONS_H
+#define TABLE_VERSIONS_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace mantis
+{
+    /**
+     * @brief Counts the writes to each table made through this process.
+     *
+     * Versions are bumped once record writes commit (creates, updates, deletes, imports),
+     * on schema changes and, for all tables, on raw SQL writes from JS. Writes made by other
+     * processes are not seen. Versions start over on restart, @see tag() carries a per-process
+     * epoch so tags handed out before a restart never match again.
+     */
+    class TableVersions
+    {
+    public:
+        TableVersions();
+
+        /// Current version of `table`, as an opaque string that changes on every write to it.
+        [[nodiscard]] std::string tag(const std::string& table) const;
+
+        /// Bump the version of `table` after a write to it committed.
+        void bump(const std::string& table);
+
+        /// Bump the version of all tables, e.g. after raw SQL writes.
+        void bumpAll();
+
+        const std::string __class_name__ = "mantis::TableVersions";
+
+    private:
+        const std::string m_epoch;
+        std::atomic<uint64_t> m_global{0};
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::string, uint64_t> m_versions;
+    };
+}
+
+#endif //TABLE_VERSIONS_H
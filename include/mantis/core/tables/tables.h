@@ -6,10 +6,15 @@
 #define TABLES_H
 
 #include <memory>
+#include <shared_mutex>
+#include <unordered_map>
 #include <nlohmann/json.hpp>
 
 #include "../models/models.h"
 #include "../http.h"
+#include "../json_writer.h"
+#include "../statement_cache.h"
+#include "../query_filter.h"
 #include "../crud/crud.h"
 #include "../../app/app.h"
 #include "../../utils/utils.h"
@@ -40,6 +45,8 @@ namespace mantis
         // CRUD endpoints handlers
         virtual void fetchRecord(MantisRequest& req, MantisResponse& res);
         virtual void fetchRecords(MantisRequest& req, MantisResponse& res);
+        /// Stream all records as NDJSON or CSV, see @see RecordExporter
+        virtual void exportRecords(MantisRequest& req, MantisResponse& res);
         virtual void createRecord(MantisRequest& req, MantisResponse& res, const MantisContentReader& reader);
         virtual void updateRecord(MantisRequest& req, MantisResponse& res, const MantisContentReader& reader);
         virtual void deleteRecord(MantisRequest& req, MantisResponse& res);
@@ -58,6 +65,34 @@ namespace mantis
         static bool getAuthToken(MantisRequest& req, MantisResponse& res);
         virtual bool hasAccess(MantisRequest& req, MantisResponse& res);
 
+        /**
+         * @brief Resolve the `auth` context var set by @see getAuthToken(), loading the user of
+         * a verified token and updating the context var with it.
+         * @param req Request with the `auth` context var
+         * @return `auth` object, with the user fields if logged in
+         */
+        json resolveAuth(MantisRequest& req) const;
+
+        /**
+         * @brief User record a token resolves to, served from @see AuthCache once loaded.
+         * @param table User table, e.g. `__admins`
+         * @param id User id
+         * @return User record without its password, or std::nullopt if not found
+         */
+        static std::optional<json> principal(const std::string& table, const std::string& id);
+
+        /// Request info exposed to access rules as `req`.
+        static TokenMap requestVars(MantisRequest& req);
+
+        /**
+         * @brief Evaluate an access rule, an empty rule grants access to admins only.
+         * @param rule Access rule expression
+         * @param auth Request `auth` object, from @see resolveAuth()
+         * @param reqMap Request variables, from @see requestVars()
+         * @return `{status, error}` if access is denied, else std::nullopt
+         */
+        std::optional<json> checkAccess(const Rule& rule, const json& auth, const TokenMap& reqMap) const;
+
         // Getters
         std::string tableName();
         void setTableName(const std::string& name);
@@ -74,6 +109,12 @@ namespace mantis
         bool isSystem() const;
         void setIsSystemTable(bool isSystemTable);
 
+        /// Record id strategy, `random` or `sortable`, see @see newRecordId()
+        std::string idStrategy() const;
+
+        /// Whether changes are logged for `/api/v1/sync/:table`, the schema's `sync` flag
+        bool syncEnabled() const;
+
         // Store the rules cached
         Rule listRule();
         void setListRule(const Rule& rule);
@@ -99,12 +140,96 @@ namespace mantis
         std::vector<json> list(const json& opts) override { return json::array(); }; // Remove
         json list_records(const json& opts);
 
+        ///> Record write, validated & bound ahead of the write job executing it
+        struct RecordWrite
+        {
+            std::string id;
+            std::string query; ///> `INSERT` or `UPDATE` statement
+            std::string columns; ///> Written columns, keys the cached statement
+            soci::values values;
+            std::string selectColumns = "*"; ///> Columns of the record read back, see @see selectColumns()
+            std::vector<json> fileFields; ///> File fields being updated
+            std::vector<std::string> filesToDelete; ///> Files replaced by the update, removed once committed
+            json record; ///> Record read back, or the removed record
+            bool keepId = false; ///> Id given by the client, a taken id fails instead of being retried
+        };
+
+        /**
+         * @brief Write steps of @see create(), @see update() & @see remove(), for running several
+         * writes in one write job, e.g. batches.
+         *
+         * `prepare*` validates & binds the write outside of the job, returning the error response
+         * `{data, error, status}` if invalid. `execute*` runs on the job's session; update returns
+         * an error message & remove throws if the record is missing, the job has to be rolled back.
+         * `finish*` applies the side effects once committed, i.e. record counts & file removals.
+         *
+         * Sync pushes set `opts.id` to create the record with the client's id, and `opts.updated`
+         * to keep the client's `updated` time, e.g. `2025-01-31 13:45:00`, instead of now.
+         */
+        std::optional<json> prepareCreate(const json& entity, const json& opts, RecordWrite& op) const;
+        void executeCreate(soci::session& sql, RecordWrite& op) const;
+        void finishCreate(RecordWrite& op) const;
+
+        std::optional<json> prepareUpdate(const std::string& id, const json& entity, const json& opts,
+                                          RecordWrite& op) const;
+        std::string executeUpdate(soci::session& sql, RecordWrite& op) const;
+        void finishUpdate(RecordWrite& op) const;
+
+        void executeRemove(soci::session& sql, RecordWrite& op) const;
+        void finishRemove(RecordWrite& op) const;
+
+        /// `updated` time of a record, read on the write job's session; std::nullopt if not found.
+        std::optional<std::string> updatedAt(soci::session& sql, const std::string& id) const;
+
+        /**
+         * @brief Same as @see list_records() but serializes the page straight into the
+         * `{data, error, pagination, status}` response envelope, without building json objects
+         * for each row.
+         *
+         * @param opts Options object, same as for @see list_records()
+         * @param body Output buffer for the serialized response envelope
+         * @return Error message if the options were invalid, else an empty string
+         */
+        std::string list_records_json(const json& opts, std::string& body);
+
         // Helper methods
         static std::string generateTableId(const std::string& tablename);
         std::string getColTypeFromName(const std::string& col, const std::vector<json>& fields) const;
         json parseDbRowToJson(const soci::row& row) const;
         json parseDbRowToJson(const soci::row& row, const std::vector<json>& ref_fields) const;
 
+        ///> Column of a result row, as serialized by @see writeDbRowJson()
+        struct RowColumn
+        {
+            size_t index;
+            std::string name;
+            std::string type;
+        };
+
+        /**
+         * @brief Resolve the column types of a result row once, to be reused for every
+         * row of the same statement. Columns are sorted by name, same as json objects.
+         *
+         * @param row Result row, only the column properties are read
+         * @param ref_fields Schema fields to resolve column types from
+         * @param hidden Column names left out of the output, e.g. `password`
+         * @return Columns to serialize, in output order
+         */
+        std::vector<RowColumn> rowColumns(const soci::row& row,
+                                          const std::vector<json>& ref_fields,
+                                          const std::vector<std::string>& hidden = {}) const;
+
+        /**
+         * @brief Serialize a result row as a JSON object, same output as @see parseDbRowToJson().
+         * @param w JSON writer to append the object to
+         * @param row Result row
+         * @param columns Columns to write, from @see rowColumns()
+         */
+        static void writeDbRowJson(JsonWriter& w, const soci::row& row, const std::vector<RowColumn>& columns);
+
+        /// Serialize a single column value of a result row, as written by @see writeDbRowJson().
+        static void writeDbValueJson(JsonWriter& w, const soci::row& row, const RowColumn& column);
+
         /**
          * Convert input values to JSON type
          *
@@ -121,15 +246,35 @@ namespace mantis
          *
          * @param vals Reference to the soci::values object
          * @param entity Const ref to the json payload
+         * @param suffix Appended to the bound value names, e.g. for multi-row inserts
          * @return Error object if unsuccessful else a std::nullopt
          */
-        std::optional<json> bindEntityToSociValue(soci::values& vals, const json& entity) const;
+        std::optional<json> bindEntityToSociValue(soci::values& vals, const json& entity,
+                                                  const std::string& suffix = "") const;
 
         std::optional<std::string> validateRequestBody(const json& body) const;
         std::optional<std::string> validateUpdateRequestBody(const json& body) const;
 
         bool recordExists(const std::string& id) const;
+
+        ///> Inserts tried with newly generated ids, before giving up on id conflicts
+        static constexpr int MAX_ID_ATTEMPTS = 10;
+
+        /// Generate an id for a new record, as per the table's id strategy.
+        std::string newRecordId() const;
+
+        /// Whether `e` is a primary key conflict on `id`, i.e. the generated id is taken.
+        bool isIdConflict(const soci::soci_error& e) const;
         std::optional<json> findFieldByKey(const std::string& key) const;
+
+        /**
+         * @brief Resolve the `fields` option (sparse fieldset) into the column list to select.
+         *
+         * @param fields Comma separated field names, empty to select all columns
+         * @param columns Columns to select, always including `id`, or `*` for all columns
+         * @return Error message for fields that can't be selected, else an empty string
+         */
+        std::string selectColumns(const std::string& fields, std::string& columns) const;
         json checkValueInColumns(const std::string& value, const std::vector<std::string>& columns) const;
 
         // Validators ...
@@ -141,6 +286,83 @@ namespace mantis
 
         static std::optional<json> validateTableSchema(const json& entity);
 
+        /**
+         * @brief Check the access rules of a table schema compile, so syntax errors are reported
+         * when the schema is saved rather than denying every request.
+         * @param entity Table schema, or the changed part of it
+         * @return `{status, error, data}` for the first invalid rule, else std::nullopt
+         */
+        static std::optional<json> validateRules(const json& entity);
+
+    private:
+        ///> Page of records to list, resolved from the pagination options
+        struct ListQuery
+        {
+            int limit = 0;
+            int offset = 0;
+            bool keyset = false; ///> Cursor pagination on `(created, id)` instead of offsets
+            bool seek = false; ///> Continue after `created` & `id`, else start from the newest record
+            std::tm created{};
+            std::string id;
+            CompiledQuery compiled; ///> From the `filter` & `sort` options
+            std::string columns = "*"; ///> From the `fields` option, see @see selectColumns()
+            std::vector<std::string> hidden; ///> Columns selected for paging only, left out of the output
+            soci::values values; ///> Bound statement values, must outlive the statement execution
+        };
+
+        /**
+         * @brief Validate pagination & filter options, counting records if requested.
+         *
+         * @param sql Session to count records on
+         * @param opts List options, for the `filter` & `sort` expressions
+         * @param pagination Pagination options, updated in place with the page & record counts
+         * @param query Resolved page to fetch
+         * @return Error message if the options were invalid, else an empty string
+         */
+        std::string paginate(soci::session& sql, const json& opts, json& pagination, ListQuery& query) const;
+
+        /**
+         * @brief Record count of the table, as served to unfiltered list requests.
+         * @param sql Session to count records on, if the count isn't served from memory
+         * @param exact Run a fresh `COUNT`, rather than the cached one
+         */
+        int64_t countRecords(soci::session& sql, bool exact) const;
+
+        /**
+         * @brief Read a single record, e.g. back after writing it.
+         *
+         * @param sql Session to read on
+         * @param id Record id
+         * @param columns Columns to select, from @see selectColumns()
+         * @return Record, or std::nullopt if not found
+         */
+        std::optional<json> readRecord(soci::session& sql, const std::string& id, const std::string& columns) const;
+
+        /**
+         * @brief Execute a write statement ending in `RETURNING`, see @see DatabaseUnit::supportsReturning().
+         *
+         * @param sql Session of the write job
+         * @param key Statement cache key
+         * @param query `INSERT`, `UPDATE` or `DELETE` statement with a `RETURNING` clause
+         * @param values Values to bind, by name
+         * @return Written record, or std::nullopt if no row was written
+         */
+        std::optional<json> writeReturning(soci::session& sql, const std::string& key, const std::string& query,
+                                           soci::values& values) const;
+
+        /// Prepare the list statement for `query`, bind it with @see bindListStatement()
+        CachedStatement prepareListStatement(soci::session& sql, const ListQuery& query) const;
+        static void bindListStatement(soci::statement& st, ListQuery& query, soci::row& row);
+
+        /**
+         * @brief Opaque cursor pointing after the given row, for keyset pagination.
+         * @param row Last row of the page
+         * @return Base64url encoded `[created, id]` of the row
+         */
+        static std::string encodeCursor(const soci::row& row);
+        static bool decodeCursor(const std::string& cursor, ListQuery& query);
+
+    public:
 
         const std::string __class_name__ = "TableUnit";
     protected:
@@ -149,6 +371,8 @@ namespace mantis
         std::string m_tableType;
         std::string m_routeName;
         bool m_isSystem = false;
+        std::string m_idStrategy = "random";
+        bool m_sync = false;
         std::vector<json> m_fields = {};
 
         // Store the rules cached
@@ -157,6 +381,16 @@ namespace mantis
         Rule m_addRule;
         Rule m_updateRule;
         Rule m_deleteRule;
+
+        /// Compile the rules not compiled yet, dropping those no longer in use; on every rule change.
+        void compileRules();
+
+        /// Compiled program of `rule`, compiled on the spot if it isn't one of the table's rules.
+        CompiledRule compiledRule(const Rule& rule) const;
+
+        // Guards the rules & their compiled programs, by trimmed expression
+        mutable std::shared_mutex m_rulesMutex;
+        std::unordered_map<std::string, CompiledRule> m_compiledRules;
     };
 }
 
@@ -0,0 +1,81 @@
+/**
+ * @file token_cache.h
+ * @brief Cache of verified JWT claims, sparing the decoding & signature check of tokens seen before.
+ */
+
+#ifndef TOKEN_CACHE_H
+#define TOKEN_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <nlohmann/json.hpp>
+
+#include "sharded_ttl_cache.h"
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    /**
+     * @brief Size bounded, sharded map of token digests to the claims they verified to, @see JwtUnit::verifyJwtToken().
+     *
+     * Tokens are keyed by their SHA-256 digest, the tokens themselves aren't kept. Entries are served
+     * until the token's `exp` claim, tokens without one aren't cached. All entries were verified
+     * against one verification context, the secret key, issuer & audience; a lookup under another
+     * context drops them all first, so changing any of them invalidates the cached tokens.
+     * Entries are kept in a @see ShardedTtlCache.
+     */
+    class TokenCache
+    {
+    public:
+        ///> Independently locked shards, keys are spread over them by digest
+        static constexpr size_t SHARDS = ShardedTtlCache<std::string, json>::SHARDS;
+        ///> Tokens kept across all shards
+        static constexpr size_t MAX_ENTRIES = 10000;
+
+        TokenCache() = default;
+
+        /**
+         * @brief Claims of a token verified before.
+         * @param token Encoded token
+         * @param context Verification context, e.g. secret, issuer & audience, entries of others are dropped
+         * @return Verified claims, or std::nullopt if not cached or expired
+         */
+        std::optional<json> get(const std::string& token, const std::string& context);
+
+        /**
+         * @brief Cache the claims of a verified token, until its `exp` claim. A full shard evicts
+         * its least recently used entries.
+         * @param token Encoded token
+         * @param context Verification context the token was verified under
+         * @param claims Verified claims
+         */
+        void put(const std::string& token, const std::string& context, const json& claims);
+
+        /// Drop all entries
+        void clear();
+
+        /// Hit/miss & eviction counters as a JSON object.
+        [[nodiscard]] json stats() const;
+
+        const std::string __class_name__ = "mantis::TokenCache";
+
+    private:
+        /// SHA-256 digest of `token`, raw bytes.
+        static std::string digest(const std::string& token);
+
+        /// Switch to `context`, dropping entries verified under the previous one.
+        void useContext(const std::string& context);
+
+        mutable std::shared_mutex m_contextMutex;
+        std::string m_context;
+
+        ShardedTtlCache<std::string, json> m_tokens{MAX_ENTRIES}; ///> Claims by token digest
+        std::atomic<uint64_t> m_clears{0};
+    };
+}
+
+#endif //TOKEN_CACHE_H
@@ -0,0 +1,124 @@
+/**
+ * @file wal_checkpointer.h
+ * @brief Background WAL checkpointing for SQLite databases, off the request threads.
+ */
+
+#ifndef WAL_CHECKPOINTER_H
+#define WAL_CHECKPOINTER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <soci/soci.h>
+#include <nlohmann/json.hpp>
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    /**
+     * @brief Runs SQLite WAL checkpoints on a dedicated connection & thread.
+     *
+     * With `wal_autocheckpoint`, the checkpoint runs on whichever connection commits past the
+     * threshold, stalling that request. Instead, autocheckpoints of the writing connections are
+     * disabled for as long as this thread runs, @see DatabaseUnit::setAutoCheckpoint(), and it
+     * checkpoints on its own:
+     *  - `PASSIVE` every @see PASSIVE_INTERVAL while there are writes, or on every tick once the
+     *    WAL file reaches @see WAL_SIZE_THRESHOLD. Never blocks readers or writers.
+     *  - `RESTART` once the WAL content reaches @see WAL_SIZE_LIMIT, so the WAL is reused from
+     *    the start instead of growing without bound under steady traffic.
+     *  - `TRUNCATE` after @see IDLE_TIMEOUT without writes, shrinking the WAL file back to zero.
+     *
+     * `RESTART` & `TRUNCATE` wait on readers for at most @see BUSY_TIMEOUT, if they could not
+     * complete they are retried after @see PASSIVE_INTERVAL.
+     */
+    class WalCheckpointer
+    {
+    public:
+        ///> How often the WAL is checked
+        static constexpr std::chrono::milliseconds TICK_INTERVAL{1000};
+        ///> Maximum time between passive checkpoints while writes are coming in
+        static constexpr std::chrono::seconds PASSIVE_INTERVAL{5};
+        ///> Time without writes before the WAL file is truncated
+        static constexpr std::chrono::seconds IDLE_TIMEOUT{10};
+        ///> WAL file size from which passive checkpoints run on every tick
+        static constexpr std::uintmax_t WAL_SIZE_THRESHOLD = 4 * 1024 * 1024;
+        ///> WAL content size from which the WAL is restarted
+        static constexpr std::uintmax_t WAL_SIZE_LIMIT = 64 * 1024 * 1024;
+        ///> How long blocking checkpoints wait on readers, in milliseconds
+        static constexpr int BUSY_TIMEOUT = 1000;
+        ///> SQLite's default `wal_autocheckpoint`, for connections committing without the checkpointer
+        static constexpr int AUTOCHECKPOINT_PAGES = 1000;
+
+        /**
+         * @brief Create the checkpointer, taking ownership of its session.
+         * @param sql Opened session to be used exclusively by the checkpointer thread.
+         * @param walPath Path to the database's `-wal` file
+         */
+        WalCheckpointer(std::unique_ptr<soci::session> sql, std::filesystem::path walPath);
+        ~WalCheckpointer();
+
+        /// Start the checkpointer thread
+        void start();
+
+        /// Stop the checkpointer thread, the session is left open.
+        void stop();
+
+        /**
+         * @brief Run a checkpoint right away, from the calling thread.
+         * @param mode One of `PASSIVE`, `FULL`, `RESTART` or `TRUNCATE`
+         * @return `true` if the checkpoint completed, `false` if it was blocked or failed
+         */
+        bool checkpoint(const std::string& mode);
+
+        /// Checkpointer session, only to be used once the thread is stopped.
+        [[nodiscard]] soci::session& session() const;
+
+        /// Size of the WAL file in bytes, `0` if there is none.
+        [[nodiscard]] std::uintmax_t walSize() const;
+
+        /// Checkpoint counters as a JSON object.
+        [[nodiscard]] json stats() const;
+
+        const std::string __class_name__ = "mantis::WalCheckpointer";
+
+    private:
+        void run();
+
+        /// Whether any connection committed since the last call, from `PRAGMA data_version`.
+        bool hasNewWrites();
+
+        /// Bytes of WAL content as of the last checkpoint, as opposed to the file size.
+        [[nodiscard]] std::uintmax_t walContentSize() const;
+
+        std::unique_ptr<soci::session> m_sql;
+        std::filesystem::path m_walPath;
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        bool m_stop = false;
+
+        std::mutex m_sqlMutex; // Checkpoints can also be requested from other threads
+        long long m_dataVersion = -1;
+        long long m_backfilled = 0;
+        std::uintmax_t m_frameSize = 0;
+
+        std::atomic<uint64_t> m_passive{0};
+        std::atomic<uint64_t> m_restarts{0};
+        std::atomic<uint64_t> m_truncates{0};
+        std::atomic<uint64_t> m_busy{0};
+        std::atomic<uint64_t> m_failed{0};
+        std::atomic<uint64_t> m_framesCheckpointed{0};
+        std::atomic<uint64_t> m_walFrames{0};
+        std::atomic<uint64_t> m_totalMicros{0};
+        std::atomic<uint64_t> m_lastMicros{0};
+        std::atomic<uint64_t> m_maxMicros{0};
+    };
+}
+
+#endif //WAL_CHECKPOINTER_H
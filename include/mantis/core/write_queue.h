@@ -0,0 +1,114 @@
+/**
+ * @file write_queue.h
+ * @brief Single writer queue for SQLite databases, batching queued writes into group commits.
+ */
+
+#ifndef WRITE_QUEUE_H
+#define WRITE_QUEUE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <soci/soci.h>
+#include <nlohmann/json.hpp>
+
+namespace mantis
+{
+    using json = nlohmann::json;
+
+    class ChangeFeed;
+
+    /**
+     * @brief A unit of write work executed within the writer transaction.
+     *
+     * The job gets the session it should run its statements on and returns `true`
+     * to keep its changes or `false` to have them rolled back. Throwing also rolls
+     * back the job's changes, the exception is rethrown to the caller.
+     */
+    using WriteJob = std::function<bool(soci::session&)>;
+
+    /**
+     * @brief Serializes all writes onto one dedicated connection.
+     *
+     * SQLite only allows a single writer at a time, with several pooled connections
+     * writing concurrently, callers end up spinning on the busy timeout and eventually
+     * fail with `database is locked`. Instead, callers enqueue their @see WriteJob and
+     * block; the writer thread drains whatever is queued, runs each job within its own
+     * `SAVEPOINT` and commits the whole batch in a single transaction (group commit).
+     * A failing job only rolls back its own savepoint, the rest of the batch commits.
+     */
+    class WriteQueue
+    {
+    public:
+        ///> Upper bound of jobs committed in a single transaction.
+        static constexpr size_t MAX_BATCH_SIZE = 128;
+
+        /**
+         * @brief Create the write queue, taking ownership of the writer session.
+         * @param sql Opened session to be used exclusively by the writer thread.
+         */
+        explicit WriteQueue(std::unique_ptr<soci::session> sql);
+        ~WriteQueue();
+
+        /// Start the writer thread
+        void start();
+
+        /// Stop the writer thread once all queued jobs have been committed.
+        void stop();
+
+        /**
+         * @brief Queue a job and block until the batch it ran in is committed.
+         *
+         * Jobs submitted from within another job run inline on the writer session.
+         *
+         * @param job Write job to execute
+         * @return `true` if the job's changes were committed, `false` if the job asked for a rollback.
+         */
+        bool submit(const WriteJob& job);
+
+        /**
+         * @brief Publish the changes of committed batches to `feed`, keeping those of jobs
+         * rolled back to their savepoint out of it. Set before @see start().
+         * @param feed Change feed the writer session is attached to, or `nullptr`
+         */
+        void setChangeFeed(ChangeFeed* feed);
+
+        /// Writer session, only to be used from within jobs or once the queue is stopped.
+        [[nodiscard]] soci::session& session() const;
+
+        /// Queue counters as a JSON object.
+        [[nodiscard]] json stats() const;
+
+        const std::string __class_name__ = "mantis::WriteQueue";
+
+    private:
+        struct Task
+        {
+            const WriteJob* job = nullptr;
+            std::promise<bool> done;
+        };
+
+        void run();
+        void commitBatch(const std::vector<Task*>& batch);
+
+        std::unique_ptr<soci::session> m_sql;
+        ChangeFeed* m_changes = nullptr;
+        std::thread m_thread;
+        std::atomic<std::thread::id> m_writerId{}; ///> Set by the writer thread while it runs
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::deque<Task*> m_queue;
+        bool m_stop = false;
+
+        std::atomic<uint64_t> m_batches{0};
+        std::atomic<uint64_t> m_jobs{0};
+        std::atomic<uint64_t> m_maxBatch{0};
+    };
+}
+
+#endif //WRITE_QUEUE_H
@@ -31,6 +31,8 @@
 // Table operations
 #include "core/tables/sys_tables.h"
 #include "core/tables/tables.h"
+#include "core/importer.h"
+#include "core/exporter.h"
 
 // For convenience to using json,
 // lets include it here
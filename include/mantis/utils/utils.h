@@ -187,6 +187,21 @@ namespace mantis
      */
     std::string generateShortId(size_t length = 16);
 
+    /**
+     * @brief Generates a time-ordered, monotonic ID
+     *
+     * 16 Crockford base32 characters: a 50-bit millisecond timestamp, a 20-bit per-process
+     * sequence and 10 node bits picked at random per process. IDs generated by a process are
+     * strictly increasing, so they sort by creation time and append to the end of indexes.
+     *
+     * Sample Output: `01JX3W8ZK40C8Q2M`
+     *
+     * @return A sortable 16 character ID
+     *
+     * @see generateShortId() For a random short UUID.
+     */
+    std::string generateSortableId();
+
     /**
      * @brief Split given string based on given delimiter
      *
@@ -202,6 +217,28 @@ namespace mantis
      */
     std::vector<std::string> splitString(const std::string& input, const std::string& delimiter);
 
+    /**
+     * @brief Encode data as unpadded base64url (RFC 4648 §5), safe for use in URLs.
+     * @param data Data to encode.
+     * @return Encoded string.
+     */
+    std::string base64UrlEncode(std::string_view data);
+
+    /**
+     * @brief Decode unpadded (or padded) base64url data.
+     * @param encoded Base64url encoded string.
+     * @return Decoded data, or `std::nullopt` if `encoded` is not valid, canonically encoded base64url.
+     */
+    std::optional<std::string> base64UrlDecode(std::string_view encoded);
+
+    /**
+     * @brief Check an `If-None-Match` header against an entity tag, with the weak comparison of RFC 9110.
+     * @param ifNoneMatch Header value, a comma separated list of entity tags or `*`
+     * @param etag Current entity tag, weak or strong
+     * @return `true` if the client's copy is current, i.e. `304 Not Modified` can be sent
+     */
+    bool etagMatches(std::string_view ifNoneMatch, std::string_view etag);
+
     /**
      * @brief Retrieves a value from an environment variable or a default value if the env variable was not set.
      * @param key Environment variable key.
@@ -7,7 +7,9 @@
 
 #include <builtin_features.h>
 #include <cmrc/cmrc.hpp>
+#include <algorithm>
 #include <fstream>
+#include <thread>
 
 #define __file__ "app/app.cpp"
 
@@ -104,6 +106,13 @@ namespace mantis
             app.m_cmdArgs.push_back(config.at("connection").get<std::string>());
         }
 
+        // --replica "dbname=mantis host=10.0.0.2 username=duser password=1235"
+        if (config.contains("replica"))
+        {
+            app.m_cmdArgs.emplace_back("--replica");
+            app.m_cmdArgs.push_back(config.at("replica").get<std::string>());
+        }
+
         // --dataDir /some/path/to/dir
         if (config.contains("dataDir"))
         {
@@ -131,6 +140,19 @@ namespace mantis
             app.m_cmdArgs.emplace_back("--dev"); // We don't care much about the value
         }
 
+        // --noWriteQueue
+        if (config.contains("writeQueue") && !config.at("writeQueue").get<bool>())
+        {
+            app.m_cmdArgs.emplace_back("--noWriteQueue");
+        }
+
+        // --sqliteProfile '{"mmapSize": 268435456}'
+        if (config.contains("sqliteProfile"))
+        {
+            app.m_cmdArgs.emplace_back("--sqliteProfile");
+            app.m_cmdArgs.push_back(config.at("sqliteProfile").dump());
+        }
+
         // serve [--host x.y.z.t --port 1234 --poolSize 8]
         if (config.contains("serve"))
         {
@@ -161,6 +183,20 @@ namespace mantis
                     app.m_cmdArgs.emplace_back("--poolSize");
                     app.m_cmdArgs.push_back(std::to_string(serve.at("poolSize").get<int>()));
                 }
+
+                // serve --readPoolSize 8
+                if (serve.contains("readPoolSize"))
+                {
+                    app.m_cmdArgs.emplace_back("--readPoolSize");
+                    app.m_cmdArgs.push_back(std::to_string(serve.at("readPoolSize").get<int>()));
+                }
+
+                // serve --maxSubscribers 32
+                if (serve.contains("maxSubscribers"))
+                {
+                    app.m_cmdArgs.emplace_back("--maxSubscribers");
+                    app.m_cmdArgs.push_back(std::to_string(serve.at("maxSubscribers").get<int>()));
+                }
             }
         }
 
@@ -212,6 +248,9 @@ namespace mantis
         program.add_argument("--connection", "-c")
                .nargs(1)
                .help("<conn> Database connection string.");
+        program.add_argument("--replica")
+               .nargs(1)
+               .help("<conn> PSQL only: Read replica connection string for the read pool.");
         program.add_argument("--dataDir")
                .nargs(1)
                .help("<dir> Data directory (default: ./data)");
@@ -222,6 +261,12 @@ namespace mantis
                .nargs(1)
                .help("<dir> JS script files directory (default: ./scripts).");
         program.add_argument("--dev").flag();
+        program.add_argument("--noWriteQueue")
+               .flag()
+               .help("SQLite only: write from pooled sessions instead of the single writer queue.");
+        program.add_argument("--sqliteProfile")
+               .nargs(1)
+               .help("<json> SQLite only: connection tuning, e.g. '{\"mmapSize\": 268435456, \"cacheSize\": 16384}'");
 
         // Serve subcommand
         argparse::ArgumentParser serve_command("serve");
@@ -236,6 +281,12 @@ namespace mantis
         serve_command.add_argument("--poolSize")
                      .scan<'i', int>()
                      .help("<pool size> Size of database connection pools >= 1");
+        serve_command.add_argument("--readPoolSize")
+                     .scan<'i', int>()
+                     .help("<pool size> Size of the read-only database connection pool >= 1");
+        serve_command.add_argument("--maxSubscribers")
+                     .scan<'i', int>()
+                     .help("<count> Concurrent realtime subscribers, 1 to 256 (default: 32)");
 
         // Admins subcommand with nested subcommands
         argparse::ArgumentParser admins_command("admins");
@@ -260,11 +311,29 @@ namespace mantis
         // Migrations subcommand with nested subcommands
         argparse::ArgumentParser sync_command("sync");
 
+        // Bulk import subcommand
+        argparse::ArgumentParser import_command("import");
+        import_command.add_argument("--table", "-t")
+                      .required()
+                      .help("<name> Table to import records into.");
+        import_command.add_argument("--file", "-f")
+                      .required()
+                      .help("<file> CSV, NDJSON or JSON array file to import.");
+        import_command.add_argument("--format")
+                      .help("<format> `csv`, `ndjson` or `json` (default: from the file extension)");
+        import_command.add_argument("--batchSize")
+                      .scan<'i', int>()
+                      .help("<rows> Rows inserted per transaction (default: 5000)");
+        import_command.add_argument("--skipInvalid")
+                      .flag()
+                      .help("Leave out invalid rows instead of stopping at the first one.");
+
         // Add main subparsers
         program.add_subparser(serve_command);
         program.add_subparser(admins_command);
         program.add_subparser(migrations_command);
         program.add_subparser(sync_command);
+        program.add_subparser(import_command);
 
         try
         {
@@ -291,6 +360,7 @@ namespace mantis
         // Get main program args
         auto db = program.present<std::string>("--database").value_or("sqlite");
         const auto connString = program.present<std::string>("--connection").value_or("");
+        m_replicaConnString = program.present<std::string>("--replica").value_or("");
         const auto dataDir = program.present<std::string>("--dataDir").value_or("data");
         const auto pubDir = program.present<std::string>("--publicDir").value_or("public");
         const auto scriptsDir = program.present<std::string>("--scriptsDir").value_or("scripts");
@@ -303,6 +373,23 @@ namespace mantis
             m_isDevMode = true;
         }
 
+        // Writes are queued to a single writer connection unless disabled
+        m_writeQueue = !program.get<bool>("--noWriteQueue");
+
+        // SQLite tuning, validated here so that bad values are reported before connecting
+        if (const auto profile = program.present<std::string>("--sqliteProfile"))
+        {
+            try
+            {
+                m_sqliteProfile = json::parse(profile.value());
+                [[maybe_unused]] auto _ = SqliteProfile::fromJson(m_sqliteProfile);
+            }
+            catch (const std::exception& e)
+            {
+                quit(-1, std::format("Invalid `--sqliteProfile`: {}", e.what()));
+            }
+        }
+
         // If directory paths are not valid, we default back to the
         // default directory for the respective items (`public`, `data` and `scripts`)
         // relative to the application binary.
@@ -344,6 +431,23 @@ namespace mantis
             quit(-1, std::format("Backend Database `{}` is unsupported!", db));
         }
 
+        // Pool sizes have to be known before the pools are created on connect
+        if (program.is_subcommand_used("serve"))
+        {
+            const int default_pool_size = m_dbType == DbType::SQLITE ? 4 : m_dbType == DbType::PSQL ? 10 : 1;
+            const auto pools = serve_command.present<int>("--poolSize").value_or(default_pool_size);
+            setPoolSize(pools > 0 ? pools : 1);
+
+            // Reads scale with the available cores, SQLite readers don't block each other in WAL mode
+            const int cores = static_cast<int>(std::thread::hardware_concurrency());
+            const int default_read_pool_size = m_dbType == DbType::SQLITE ? std::max(4, cores) : m_poolSize;
+            const auto read_pools = serve_command.present<int>("--readPoolSize").value_or(default_read_pool_size);
+            setReadPoolSize(read_pools > 0 ? read_pools : 1);
+
+            // Streams get HTTP workers of their own, on top of those serving requests
+            setMaxSubscribers(serve_command.present<int>("--maxSubscribers").value_or(m_maxSubscribers));
+        }
+
         // Initialize database connection & Migration
         if (!m_database->connect(m_dbType, connString))
         {
@@ -367,12 +471,8 @@ namespace mantis
             const auto host = serve_command.get<std::string>("--host");
             const auto port = serve_command.get<int>("--port");
 
-            int default_pool_size = m_dbType == DbType::SQLITE ? 4 : m_dbType == DbType::PSQL ? 10 : 1;
-            const auto pools = serve_command.present<int>("--poolSize").value_or(default_pool_size);
-
             setHost(host);
             setPort(port);
-            setPoolSize(pools > 0 ? pools : 1);
 
             // Set the serve flag to true, will be checked later before
             // running the listen on port & host above.
@@ -479,6 +579,54 @@ namespace mantis
             // Do sync actions
             Log::info("Sync CMD support has not been implemented yet!");
         }
+        else if (program.is_subcommand_used("import"))
+        {
+            const auto table_name = import_command.get<std::string>("--table");
+            const auto file = import_command.get<std::string>("--file");
+            const auto format = import_command.present<std::string>("--format")
+                                              .value_or(RecordImporter::formatFromPath(file));
+
+            const auto sql = m_database->session();
+            soci::row row;
+            *sql << "SELECT id, name, schema FROM __tables WHERE name = :name", soci::use(table_name), soci::into(row);
+            if (!sql->got_data())
+                quit(-1, std::format("Table `{}` not found!", table_name));
+
+            TableUnit table{row.get<json>("schema")};
+            table.setTableName(row.get<std::string>("name"));
+            table.setTableId(row.get<std::string>("id"));
+
+            std::ifstream in(file, std::ios::binary);
+            if (!in)
+                quit(-1, std::format("Could not open `{}`!", file));
+
+            try
+            {
+                RecordImporter importer(table, format);
+                if (const auto batch_size = import_command.present<int>("--batchSize"))
+                    importer.setBatchSize(std::max(batch_size.value(), 1));
+                importer.setSkipInvalid(import_command.get<bool>("--skipInvalid"));
+
+                importer.onProgress([](const ImportStats& stats)
+                {
+                    const auto seconds = std::max<double>(static_cast<double>(stats.elapsed.count()) / 1000.0, 0.001);
+                    Log::info("Imported {} rows, {} skipped ({:.0f} rows/s)", stats.inserted, stats.skipped,
+                              static_cast<double>(stats.inserted) / seconds);
+                });
+
+                const auto stats = importer.run(in);
+                for (const auto& error : stats.errors) Log::warn("Skipped {}", error);
+
+                Log::info("Import done: {} rows inserted, {} skipped in {}ms", stats.inserted, stats.skipped,
+                          stats.elapsed.count());
+                quit(0, "");
+            }
+            catch (const std::exception& e)
+            {
+                Log::critical("Import failed: {}", e.what());
+                quit(-1, "");
+            }
+        }
     }
 
     void MantisApp::init_units()
@@ -630,6 +778,16 @@ namespace mantis
         return m_isDevMode;
     }
 
+    bool MantisApp::isWriteQueueEnabled() const
+    {
+        return m_writeQueue;
+    }
+
+    const json& MantisApp::sqliteProfile() const
+    {
+        return m_sqliteProfile;
+    }
+
     void MantisApp::setDbType(const DbType& dbType)
     {
         m_dbType = dbType;
@@ -720,6 +878,41 @@ namespace mantis
         m_poolSize = pool_size;
     }
 
+    int MantisApp::readPoolSize() const
+    {
+        return m_readPoolSize;
+    }
+
+    void MantisApp::setReadPoolSize(const int& pool_size)
+    {
+        if (pool_size <= 0)
+            return;
+
+        m_readPoolSize = pool_size;
+    }
+
+    int MantisApp::maxSubscribers() const
+    {
+        return m_maxSubscribers;
+    }
+
+    void MantisApp::setMaxSubscribers(const int& max_subscribers)
+    {
+        if (max_subscribers <= 0)
+            return;
+
+        // Each stream holds a pre-started HTTP worker, keep the pool bounded
+        if (max_subscribers > MAX_SUBSCRIBERS)
+            Log::warn("Realtime subscribers capped at {}, not {}", MAX_SUBSCRIBERS, max_subscribers);
+
+        m_maxSubscribers = std::min(max_subscribers, MAX_SUBSCRIBERS);
+    }
+
+    std::string MantisApp::replicaConnString() const
+    {
+        return m_replicaConnString;
+    }
+
     std::string MantisApp::publicDir() const
     {
         return m_publicDir;
@@ -832,6 +1025,7 @@ namespace mantis
         dukglue_register_property(m_dukCtx, &MantisApp::host, &MantisApp::setHost, "host");
         dukglue_register_property(m_dukCtx, &MantisApp::port, &MantisApp::setPort, "port");
         dukglue_register_property(m_dukCtx, &MantisApp::poolSize, &MantisApp::setPoolSize, "poolSize");
+        dukglue_register_property(m_dukCtx, &MantisApp::readPoolSize, &MantisApp::setReadPoolSize, "readPoolSize");
         dukglue_register_property(m_dukCtx, &MantisApp::publicDir, &MantisApp::setPublicDir, "publicDir");
         dukglue_register_property(m_dukCtx, &MantisApp::dataDir, &MantisApp::setDataDir, "dataDir");
         dukglue_register_property(m_dukCtx, &MantisApp::isDevMode, nullptr, "devMode");
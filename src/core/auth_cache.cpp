@@ -0,0 +1,73 @@
+#include "../../include/mantis/core/auth_cache.h"
+
+#define __file__ "core/auth_cache.cpp"
+
+namespace mantis
+{
+    std::optional<json> AuthCache::get(const std::string& table, const std::string& id)
+    {
+        return m_users.get(key(table, id));
+    }
+
+    uint64_t AuthCache::generation(const std::string& table, const std::string& id) const
+    {
+        return m_users.generation(key(table, id));
+    }
+
+    void AuthCache::put(const std::string& table, const std::string& id, json user, const uint64_t generation)
+    {
+        m_users.put(key(table, id), std::move(user), std::chrono::steady_clock::now() + TTL, generation);
+    }
+
+    void AuthCache::invalidate(const std::string& table, const std::string& id)
+    {
+        m_users.invalidate(key(table, id));
+        notify(table, id);
+    }
+
+    void AuthCache::invalidate(const std::string& table)
+    {
+        const auto prefix = key(table, "");
+        m_users.invalidateIf([&](const std::string& k, const json&) { return k.starts_with(prefix); });
+        notify(table, "");
+    }
+
+    void AuthCache::clear()
+    {
+        m_users.clear();
+        notify("", "");
+    }
+
+    json AuthCache::stats() const
+    {
+        return m_users.stats();
+    }
+
+    void AuthCache::setListener(Listener listener)
+    {
+        std::lock_guard lock(m_listenerMutex);
+        m_listener = std::move(listener);
+    }
+
+    void AuthCache::notify(const std::string& table, const std::string& id) const
+    {
+        Listener listener;
+        {
+            std::lock_guard lock(m_listenerMutex);
+            listener = m_listener;
+        }
+
+        if (listener) listener(table, id);
+    }
+
+    std::string AuthCache::key(const std::string& table, const std::string& id)
+    {
+        // Table names can't hold a NUL, the key is unambiguous
+        std::string k;
+        k.reserve(table.size() + id.size() + 1);
+        k += table;
+        k.push_back('\0');
+        k += id;
+        return k;
+    }
+}
@@ -0,0 +1,494 @@
+#include "../../include/mantis/core/change_feed.h"
+#include "../../include/mantis/core/logging.h"
+
+#include <algorithm>
+#include <format>
+#include <soci/sqlite3/soci-sqlite3.h>
+
+#if MANTIS_HAS_POSTGRESQL
+#include <soci/postgresql/soci-postgresql.h>
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+#endif
+
+#define __file__ "core/change_feed.cpp"
+
+namespace mantis
+{
+    namespace sqlite = soci::sqlite_api;
+
+    namespace
+    {
+        sqlite::sqlite3* sqliteHandle(soci::session& sql)
+        {
+            return static_cast<soci::sqlite3_session_backend*>(sql.get_backend())->conn_;
+        }
+
+        ///> SQL function called by the delete triggers, registered on captured connections only
+        constexpr auto DELETED_FUNCTION = "mantis_deleted";
+
+        /// `value` with each `quote` doubled, to be wrapped in `quote`.
+        std::string escapeQuotes(const std::string& value, const char quote)
+        {
+            std::string escaped;
+            for (const char c : value)
+            {
+                if (c == quote) escaped.push_back(quote);
+                escaped.push_back(c);
+            }
+            return escaped;
+        }
+
+        constexpr auto PG_TRIGGER_FUNCTION = R"(
+CREATE OR REPLACE FUNCTION mantis_notify_change() RETURNS trigger AS $$
+BEGIN
+    IF TG_OP = 'DELETE' THEN
+        PERFORM pg_notify('mantis_changes', json_build_object('table', TG_TABLE_NAME, 'op', 'delete', 'id', OLD.id)::text);
+    ELSE
+        PERFORM pg_notify('mantis_changes', json_build_object('table', TG_TABLE_NAME, 'op', lower(TG_OP), 'id', NEW.id)::text);
+    END IF;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql)";
+    }
+
+    ChangeFeed::ChangeFeed() = default;
+
+    ChangeFeed::~ChangeFeed()
+    {
+        stop();
+    }
+
+    ChangeRing& ChangeFeed::ring()
+    {
+        return m_ring;
+    }
+
+    void ChangeFeed::startSqlite(std::unique_ptr<soci::session> resolver)
+    {
+        std::lock_guard lock(m_resolverMutex);
+        m_resolver = std::move(resolver);
+    }
+
+    void ChangeFeed::attach(soci::session& sql)
+    {
+        const auto db = sqliteHandle(sql);
+
+        auto capture = std::make_unique<Capture>();
+        capture->feed = this;
+        capture->db = db;
+
+        sqlite::sqlite3_update_hook(db, &ChangeFeed::onUpdate, capture.get());
+        sqlite::sqlite3_commit_hook(db, &ChangeFeed::onCommit, capture.get());
+        sqlite::sqlite3_rollback_hook(db, &ChangeFeed::onRollback, capture.get());
+        sqlite::sqlite3_create_function_v2(db, DELETED_FUNCTION, 3, SQLITE_UTF8, capture.get(),
+                                           &ChangeFeed::onDeleted, nullptr, nullptr, nullptr);
+
+        std::lock_guard lock(m_capturesMutex);
+        m_captures[db] = std::move(capture);
+    }
+
+    void ChangeFeed::prepare(soci::session& sql)
+    {
+        const auto c = capture(sql);
+        if (!c) return;
+
+        const auto db = static_cast<sqlite::sqlite3*>(c->db);
+
+        // Checked on every lease, tables are only listed again once the schema changed
+        int version = -1;
+        std::vector<std::string> tables;
+        {
+            sqlite::sqlite3_stmt* stmt = nullptr;
+            if (sqlite::sqlite3_prepare_v2(db, "PRAGMA main.schema_version", -1, &stmt, nullptr) == SQLITE_OK
+                && sqlite::sqlite3_step(stmt) == SQLITE_ROW)
+                version = sqlite::sqlite3_column_int(stmt, 0);
+            sqlite::sqlite3_finalize(stmt);
+        }
+        if (version < 0 || version == c->schemaVersion) return;
+
+        {
+            sqlite::sqlite3_stmt* stmt = nullptr;
+            if (sqlite::sqlite3_prepare_v2(db, "SELECT name FROM main.sqlite_master WHERE type = 'table'", -1, &stmt,
+                                           nullptr) == SQLITE_OK)
+            {
+                while (sqlite::sqlite3_step(stmt) == SQLITE_ROW)
+                {
+                    const std::string table = reinterpret_cast<const char*>(sqlite::sqlite3_column_text(stmt, 0));
+                    if (isCaptured(table)) tables.push_back(table);
+                }
+            }
+            sqlite::sqlite3_finalize(stmt);
+        }
+
+        // Renamed & dropped tables leave stale triggers behind, install them all again
+        for (const auto& table : c->triggers)
+        {
+            const auto drop = std::format("DROP TRIGGER IF EXISTS temp.\"__changes_{}\"", escapeQuotes(table, '"'));
+            sqlite::sqlite3_exec(db, drop.c_str(), nullptr, nullptr, nullptr);
+        }
+        c->triggers.clear();
+
+        for (const auto& table : tables)
+        {
+            const auto create = std::format(
+                "CREATE TEMP TRIGGER \"__changes_{0}\" AFTER DELETE ON main.\"{0}\" "
+                "BEGIN SELECT {1}('{2}', OLD.rowid, OLD.id); END",
+                escapeQuotes(table, '"'), DELETED_FUNCTION, escapeQuotes(table, '\''));
+
+            if (sqlite::sqlite3_exec(db, create.c_str(), nullptr, nullptr, nullptr) == SQLITE_OK)
+                c->triggers.push_back(table);
+            else
+                Log::debug("Change feed could not capture deletes of `{}`: {}", table, sqlite::sqlite3_errmsg(db));
+        }
+
+        c->schemaVersion = version;
+    }
+
+    size_t ChangeFeed::mark(soci::session& sql)
+    {
+        const auto c = capture(sql);
+        if (!c) return 0;
+
+        std::lock_guard lock(c->mutex);
+        return c->pending.size();
+    }
+
+    void ChangeFeed::discard(soci::session& sql, const size_t mark)
+    {
+        const auto c = capture(sql);
+        if (!c) return;
+
+        std::lock_guard lock(c->mutex);
+        if (mark < c->pending.size()) c->pending.resize(mark);
+    }
+
+    void ChangeFeed::flush(soci::session& sql)
+    {
+        const auto c = capture(sql);
+        if (!c) return;
+
+        std::vector<Pending> changes;
+        {
+            std::lock_guard lock(c->mutex);
+            changes.swap(c->committed);
+        }
+        if (changes.empty()) return;
+
+        // Rows inserted & deleted within the same transaction never existed for readers
+        std::vector<bool> skip(changes.size(), false);
+        for (size_t i = 0; i < changes.size(); ++i)
+        {
+            if (!changes[i].transient) continue;
+
+            skip[i] = true;
+            for (size_t j = 0; j < i; ++j)
+            {
+                if (changes[j].op != ChangeOp::Delete && changes[j].rowid == changes[i].rowid
+                    && changes[j].table == changes[i].table)
+                    skip[j] = true;
+            }
+        }
+
+        for (size_t i = 0; i < changes.size(); ++i)
+        {
+            if (skip[i]) continue;
+
+            auto& change = changes[i];
+            if (change.op != ChangeOp::Delete)
+            {
+                change.id = resolveId(change.table, change.rowid).value_or("");
+
+                // Deleted by a later transaction already, which publishes its own event
+                if (change.id.empty())
+                {
+                    ++m_dropped;
+                    continue;
+                }
+            }
+            else if (change.id.empty())
+            {
+                ++m_unresolved;
+            }
+
+            m_ring.publish(change.op, change.table, change.id);
+        }
+    }
+
+    void ChangeFeed::startPostgres([[maybe_unused]] soci::session& sql, [[maybe_unused]] const std::string& conn_str)
+    {
+#if MANTIS_HAS_POSTGRESQL
+        try
+        {
+            sql << PG_TRIGGER_FUNCTION;
+        }
+        catch (const std::exception& e)
+        {
+            Log::warn("Could not install the change trigger function: {}", e.what());
+            return;
+        }
+
+        m_postgres = true;
+        m_stop = false;
+        m_listener = std::thread(&ChangeFeed::listen, this, conn_str);
+#else
+        Log::warn("Change capture on PostgreSQL requires a build with PostgreSQL support");
+#endif
+    }
+
+    std::vector<std::string> ChangeFeed::captureSql(const std::string& table) const
+    {
+        if (!m_postgres || !isCaptured(table)) return {};
+
+        return {
+            std::format("DROP TRIGGER IF EXISTS mantis_changes ON {}", table),
+            std::format("CREATE TRIGGER mantis_changes AFTER INSERT OR UPDATE OR DELETE ON {} "
+                        "FOR EACH ROW EXECUTE PROCEDURE mantis_notify_change()", table)
+        };
+    }
+
+    void ChangeFeed::stop()
+    {
+        m_stop = true;
+        if (m_listener.joinable()) m_listener.join();
+
+        {
+            std::lock_guard lock(m_capturesMutex);
+            for (const auto& [db, capture] : m_captures)
+            {
+                const auto handle = static_cast<sqlite::sqlite3*>(db);
+                sqlite::sqlite3_update_hook(handle, nullptr, nullptr);
+                sqlite::sqlite3_commit_hook(handle, nullptr, nullptr);
+                sqlite::sqlite3_rollback_hook(handle, nullptr, nullptr);
+
+                // The triggers outlive the capture, leave them calling a no-op
+                sqlite::sqlite3_create_function_v2(handle, DELETED_FUNCTION, 3, SQLITE_UTF8, nullptr,
+                                                   &ChangeFeed::onDeleted, nullptr, nullptr, nullptr);
+            }
+            m_captures.clear();
+        }
+
+        // Statements first, then the resolver session they were prepared on
+        std::lock_guard lock(m_resolverMutex);
+        for (const auto& [table, stmt] : m_resolverStmts)
+            sqlite::sqlite3_finalize(static_cast<sqlite::sqlite3_stmt*>(stmt));
+        m_resolverStmts.clear();
+        m_resolver.reset();
+    }
+
+    json ChangeFeed::stats() const
+    {
+        auto stats = m_ring.stats();
+        stats["dropped"] = m_dropped.load();
+        stats["unresolved"] = m_unresolved.load();
+        stats["notifications"] = m_notifications.load();
+        return stats;
+    }
+
+    void ChangeFeed::onUpdate(void* arg, const int op, const char* db, const char* table, const long long rowid)
+    {
+        const auto c = static_cast<Capture*>(arg);
+        if (std::string_view(db) != "main" || !isCaptured(table)) return;
+
+        Pending change;
+        change.table = table;
+        change.rowid = rowid;
+        change.op = op == SQLITE_INSERT ? ChangeOp::Create : op == SQLITE_UPDATE ? ChangeOp::Update : ChangeOp::Delete;
+
+        std::lock_guard lock(c->mutex);
+
+        // The id is filled in by the delete trigger, which runs right after this hook
+        if (change.op == ChangeOp::Delete)
+        {
+            for (auto it = c->pending.rbegin(); it != c->pending.rend(); ++it)
+            {
+                if (it->rowid != rowid || it->table != change.table) continue;
+                if (it->op == ChangeOp::Delete) break;
+
+                // Inserted by this transaction, readers never saw the row
+                if (it->op == ChangeOp::Create)
+                {
+                    change.transient = true;
+                    break;
+                }
+            }
+        }
+
+        c->pending.push_back(std::move(change));
+    }
+
+    void ChangeFeed::onDeleted(sqlite::sqlite3_context* ctx, const int argc, sqlite::sqlite3_value** argv)
+    {
+        sqlite::sqlite3_result_null(ctx);
+
+        const auto c = static_cast<Capture*>(sqlite::sqlite3_user_data(ctx));
+        if (!c || argc != 3) return;
+
+        const auto table = reinterpret_cast<const char*>(sqlite::sqlite3_value_text(argv[0]));
+        const auto rowid = sqlite::sqlite3_value_int64(argv[1]);
+        const auto id = reinterpret_cast<const char*>(sqlite::sqlite3_value_text(argv[2]));
+        if (!table || !id) return;
+
+        std::lock_guard lock(c->mutex);
+        for (auto it = c->pending.rbegin(); it != c->pending.rend(); ++it)
+        {
+            if (it->op == ChangeOp::Delete && it->rowid == rowid && it->table == table)
+            {
+                if (it->id.empty()) it->id = id;
+                break;
+            }
+        }
+    }
+
+    int ChangeFeed::onCommit(void* arg)
+    {
+        const auto c = static_cast<Capture*>(arg);
+
+        std::lock_guard lock(c->mutex);
+        std::ranges::move(c->pending, std::back_inserter(c->committed));
+        c->pending.clear();
+        return 0; // Go on with the commit
+    }
+
+    void ChangeFeed::onRollback(void* arg)
+    {
+        const auto c = static_cast<Capture*>(arg);
+
+        std::lock_guard lock(c->mutex);
+        c->pending.clear();
+    }
+
+    ChangeFeed::Capture* ChangeFeed::capture(soci::session& sql)
+    {
+        if (m_postgres || sql.get_backend_name() != "sqlite3") return nullptr;
+
+        std::lock_guard lock(m_capturesMutex);
+        const auto it = m_captures.find(sqliteHandle(sql));
+        return it == m_captures.end() ? nullptr : it->second.get();
+    }
+
+    std::optional<std::string> ChangeFeed::resolveId(const std::string& table, const int64_t rowid)
+    {
+        std::lock_guard lock(m_resolverMutex);
+        if (!m_resolver) return std::nullopt;
+
+        sqlite::sqlite3_stmt* stmt = nullptr;
+        if (const auto it = m_resolverStmts.find(table); it != m_resolverStmts.end())
+        {
+            stmt = static_cast<sqlite::sqlite3_stmt*>(it->second);
+        }
+        else
+        {
+            const auto query = std::format("SELECT id FROM \"{}\" WHERE rowid = ?", table);
+            if (sqlite::sqlite3_prepare_v2(sqliteHandle(*m_resolver), query.c_str(), -1, &stmt, nullptr)
+                != SQLITE_OK)
+            {
+                sqlite::sqlite3_finalize(stmt);
+                return std::nullopt;
+            }
+            m_resolverStmts[table] = stmt;
+        }
+
+        std::string id;
+        sqlite::sqlite3_bind_int64(stmt, 1, rowid);
+
+        if (const auto rc = sqlite::sqlite3_step(stmt); rc == SQLITE_ROW)
+        {
+            if (const auto text = sqlite::sqlite3_column_text(stmt, 0))
+                id = reinterpret_cast<const char*>(text);
+        }
+        else if (rc != SQLITE_DONE)
+        {
+            // Table dropped or locked, prepare it again next time
+            Log::debug("Change feed could not resolve `{}` row {}: {}", table, rowid,
+                       sqlite::sqlite3_errmsg(sqliteHandle(*m_resolver)));
+            sqlite::sqlite3_finalize(stmt);
+            m_resolverStmts.erase(table);
+            return std::nullopt;
+        }
+
+        sqlite::sqlite3_reset(stmt);
+        return id;
+    }
+
+    void ChangeFeed::listen([[maybe_unused]] std::string conn_str)
+    {
+#if MANTIS_HAS_POSTGRESQL
+        PGconn* conn = nullptr;
+
+        while (!m_stop)
+        {
+            if (!conn || PQstatus(conn) != CONNECTION_OK)
+            {
+                if (conn) PQfinish(conn);
+                conn = PQconnectdb(conn_str.c_str());
+
+                bool listening = PQstatus(conn) == CONNECTION_OK;
+                if (listening)
+                {
+                    PGresult* result = PQexec(conn, std::format("LISTEN {}", PG_CHANNEL).c_str());
+                    listening = PQresultStatus(result) == PGRES_COMMAND_OK;
+                    PQclear(result);
+                }
+
+                if (!listening)
+                {
+                    Log::warn("Change feed could not listen for notifications: {}", PQerrorMessage(conn));
+                    PQfinish(conn);
+                    conn = nullptr;
+
+                    // Retry in a second, unless stopping
+                    for (int i = 0; i < 10 && !m_stop; ++i)
+                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                    continue;
+                }
+            }
+
+            // Wake up regularly to check for `stop()`
+            pollfd fd{};
+            fd.fd = PQsocket(conn);
+            fd.events = POLLIN;
+#ifdef _WIN32
+            WSAPoll(&fd, 1, 250);
+#else
+            ::poll(&fd, 1, 250);
+#endif
+
+            if (!PQconsumeInput(conn))
+            {
+                Log::warn("Change feed lost its connection: {}", PQerrorMessage(conn));
+                continue;
+            }
+
+            while (PGnotify* notify = PQnotifies(conn))
+            {
+                ++m_notifications;
+
+                const auto payload = json::parse(notify->extra, nullptr, false);
+                if (payload.is_object())
+                {
+                    const auto op = payload.value("op", "");
+                    m_ring.publish(op == "delete"
+                                       ? ChangeOp::Delete
+                                       : op == "update"
+                                       ? ChangeOp::Update
+                                       : ChangeOp::Create,
+                                   payload.value("table", ""), payload.value("id", ""));
+                }
+
+                PQfreemem(notify);
+            }
+        }
+
+        if (conn) PQfinish(conn);
+#endif
+    }
+
+    bool ChangeFeed::isCaptured(const std::string& table)
+    {
+        return !table.starts_with("__") && !table.starts_with("sqlite_");
+    }
+}
@@ -0,0 +1,195 @@
+#include "../../include/mantis/core/change_ring.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <thread>
+
+#define __file__ "core/change_ring.cpp"
+
+namespace mantis
+{
+    std::string_view changeOpName(const ChangeOp op)
+    {
+        switch (op)
+        {
+        case ChangeOp::Create: return "create";
+        case ChangeOp::Update: return "update";
+        case ChangeOp::Delete: return "delete";
+        }
+        return "";
+    }
+
+    json ChangeEvent::toJson() const
+    {
+        return {
+            {"seq", seq},
+            {"op", changeOpName(op)},
+            {"table", table},
+            {"id", id},
+            {"timestamp", timestamp}
+        };
+    }
+
+    ChangeRing::ChangeRing(const size_t capacity)
+        : m_mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1),
+          m_slots(std::make_unique<Slot[]>(m_mask + 1))
+    {
+    }
+
+    uint64_t ChangeRing::publish(const ChangeOp op, const std::string_view table, const std::string_view id)
+    {
+        const auto seq = m_head.fetch_add(1) + 1;
+        auto& slot = m_slots[seq & m_mask];
+
+        // Take the slot over from the previous lap's event once it's published. Odd while
+        // writing, readers copying the previous event see it changed under them.
+        auto version = slot.version.load(std::memory_order_relaxed);
+        bool claimed = false;
+        while (version < 2 * seq)
+        {
+            if (version % 2 == 1)
+            {
+                // The previous lap's publisher is still writing
+                std::this_thread::yield();
+                version = slot.version.load(std::memory_order_relaxed);
+            }
+            else if (slot.version.compare_exchange_weak(version, 2 * seq - 1, std::memory_order_relaxed))
+            {
+                claimed = true;
+                break;
+            }
+        }
+
+        // Otherwise lapped while preempted, a newer event holds the slot and this one is lost
+        if (claimed)
+        {
+            std::atomic_thread_fence(std::memory_order_release);
+
+            // A truncated id would name another record, leave it out instead
+            const auto table_size = std::min(table.size(), MAX_FIELD_SIZE);
+            const auto id_size = id.size() <= MAX_FIELD_SIZE ? id.size() : 0;
+
+            slot.meta.store(static_cast<uint32_t>(op) | static_cast<uint32_t>(table_size) << 8
+                            | static_cast<uint32_t>(id_size) << 16, std::memory_order_relaxed);
+            slot.timestamp.store(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     std::chrono::system_clock::now().time_since_epoch()).count(),
+                                 std::memory_order_relaxed);
+            storeField(slot.table, table.substr(0, table_size));
+            storeField(slot.id, id.substr(0, id_size));
+
+            slot.version.store(2 * seq, std::memory_order_release);
+        }
+
+        if (m_waiters.load() > 0)
+        {
+            std::lock_guard lock(m_waitMutex);
+            m_waitCv.notify_all();
+        }
+
+        return seq;
+    }
+
+    size_t ChangeRing::poll(uint64_t& cursor, std::vector<ChangeEvent>& out, const size_t max) const
+    {
+        out.clear();
+
+        const auto head = m_head.load(std::memory_order_acquire);
+        const auto capacity = m_mask + 1;
+        size_t lost = 0;
+
+        // Fell behind by more than the ring holds, skip to the oldest event still in it
+        if (head > capacity && cursor < head - capacity)
+        {
+            lost = head - capacity - cursor;
+            cursor = head - capacity;
+        }
+
+        while (out.size() < max && cursor < head)
+        {
+            const auto seq = cursor + 1;
+            const auto& slot = m_slots[seq & m_mask];
+
+            const auto version = slot.version.load(std::memory_order_acquire);
+            if (version < 2 * seq) break; // Not published yet, keep the order
+
+            if (version == 2 * seq)
+            {
+                const auto meta = slot.meta.load(std::memory_order_relaxed);
+
+                ChangeEvent event;
+                event.seq = seq;
+                event.op = static_cast<ChangeOp>(meta & 0xff);
+                event.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+                loadField(slot.table, std::min<size_t>(meta >> 8 & 0xff, MAX_FIELD_SIZE), event.table);
+                loadField(slot.id, std::min<size_t>(meta >> 16 & 0xff, MAX_FIELD_SIZE), event.id);
+
+                // Only keep the copy if the slot wasn't rewritten meanwhile
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.version.load(std::memory_order_relaxed) == version)
+                {
+                    out.push_back(std::move(event));
+                    cursor = seq;
+                    continue;
+                }
+            }
+
+            // Overwritten by a publisher a full lap ahead
+            ++lost;
+            cursor = seq;
+        }
+
+        return lost;
+    }
+
+    void ChangeRing::storeField(Field& field, const std::string_view value)
+    {
+        for (size_t i = 0; i * sizeof(uint64_t) < value.size(); ++i)
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, value.data() + i * sizeof(uint64_t),
+                        std::min(sizeof(uint64_t), value.size() - i * sizeof(uint64_t)));
+            field[i].store(word, std::memory_order_relaxed);
+        }
+    }
+
+    void ChangeRing::loadField(const Field& field, const size_t size, std::string& out)
+    {
+        out.resize(size);
+        for (size_t i = 0; i * sizeof(uint64_t) < size; ++i)
+        {
+            const auto word = field[i].load(std::memory_order_relaxed);
+            std::memcpy(out.data() + i * sizeof(uint64_t), &word, std::min(sizeof(uint64_t), size - i * sizeof(uint64_t)));
+        }
+    }
+
+    bool ChangeRing::wait(const uint64_t cursor, const std::chrono::milliseconds timeout) const
+    {
+        if (m_head.load() > cursor) return true;
+
+        ++m_waiters;
+        std::unique_lock lock(m_waitMutex);
+        const auto ready = m_waitCv.wait_for(lock, timeout, [&] { return m_head.load() > cursor; });
+        --m_waiters;
+
+        return ready;
+    }
+
+    uint64_t ChangeRing::head() const
+    {
+        return m_head.load();
+    }
+
+    size_t ChangeRing::capacity() const
+    {
+        return m_mask + 1;
+    }
+
+    json ChangeRing::stats() const
+    {
+        return {
+            {"published", m_head.load()},
+            {"capacity", capacity()}
+        };
+    }
+}
@@ -4,6 +4,7 @@
 #include "../../include/mantis/utils/utils.h"
 #include "../../include/mantis/core/models/models.h"
 #include "../../include/mantis/core/settings.h"
+#include "../../include/mantis/core/sync.h"
 
 #include <soci/sqlite3/soci-sqlite3.h>
 #include <private/soci-mktime.h>
@@ -16,7 +17,99 @@
 
 namespace mantis
 {
-    DatabaseUnit::DatabaseUnit() : m_connPool(nullptr)
+    SqliteProfile SqliteProfile::fromJson(const json& j, const SqliteProfile& base)
+    {
+        if (!j.is_object())
+            throw std::invalid_argument("SQLite profile should be a JSON object");
+
+        // Values of the wrong type or out of range would otherwise be converted, or throw a json error
+        const auto integer = [](const std::string& key, const json& value, const long long min, const long long max)
+        {
+            // Positive numbers are parsed unsigned, `min` is never negative here
+            const auto fits = value.is_number_unsigned()
+                                  ? value.get<unsigned long long>() >= static_cast<unsigned long long>(min) &&
+                                  value.get<unsigned long long>() <= static_cast<unsigned long long>(max)
+                                  : value.is_number_integer() && value.get<long long>() >= min &&
+                                  value.get<long long>() <= max;
+            if (!fits)
+                throw std::invalid_argument(std::format("SQLite `{}` should be an integer between {} and {}",
+                                                        key, min, max));
+            return value.get<long long>();
+        };
+
+        auto profile = base;
+        for (const auto& [key, value] : j.items())
+        {
+            if (key == "mmapSize")
+                profile.mmapSize = integer(key, value, 0, std::numeric_limits<long long>::max());
+            else if (key == "cacheSize")
+                profile.cacheSize = integer(key, value, 1, std::numeric_limits<long long>::max());
+            else if (key == "pageSize")
+                profile.pageSize = static_cast<int>(integer(key, value, 512, 65536));
+            else if (key == "busyTimeout")
+                profile.busyTimeout = static_cast<int>(integer(key, value, 0, std::numeric_limits<int>::max()));
+            else if (key == "tempStore")
+            {
+                if (!value.is_string())
+                    throw std::invalid_argument("SQLite `tempStore` should be a string");
+                profile.tempStore = value.get<std::string>();
+            }
+            else if (key == "sharedCache")
+            {
+                if (!value.is_boolean())
+                    throw std::invalid_argument("SQLite `sharedCache` should be a boolean");
+                profile.sharedCache = value.get<bool>();
+            }
+            else throw std::invalid_argument(std::format("Unknown SQLite profile option `{}`", key));
+        }
+
+        toLowerCase(profile.tempStore);
+        if (profile.tempStore != "default" && profile.tempStore != "file" && profile.tempStore != "memory")
+            throw std::invalid_argument("SQLite `tempStore` should be one of `default`, `file` or `memory`");
+        if ((profile.pageSize & (profile.pageSize - 1)) != 0)
+            throw std::invalid_argument("SQLite `pageSize` should be a power of two between 512 and 65536");
+
+        return profile;
+    }
+
+    SqliteProfile SqliteProfile::fromJson(const json& j)
+    {
+        return fromJson(j, SqliteProfile{});
+    }
+
+    json SqliteProfile::toJson() const
+    {
+        return {
+            {"mmapSize", mmapSize},
+            {"cacheSize", cacheSize},
+            {"tempStore", tempStore},
+            {"pageSize", pageSize},
+            {"busyTimeout", busyTimeout},
+            {"sharedCache", sharedCache}
+        };
+    }
+
+    std::vector<std::string> SqliteProfile::pragmas() const
+    {
+        return {
+            // Has to come before WAL mode is set, ignored once the database has content
+            std::format("PRAGMA page_size={}", pageSize),
+            std::format("PRAGMA mmap_size={}", mmapSize),
+            std::format("PRAGMA cache_size=-{}", cacheSize), // Negative values are in KiB
+            std::format("PRAGMA temp_store={}", tempStore),
+            std::format("PRAGMA busy_timeout={}", busyTimeout)
+        };
+    }
+
+    DatabaseUnit::DatabaseUnit()
+        : m_connPool(nullptr),
+          m_readPool(nullptr),
+          m_stmtCache(std::make_unique<StatementCache>()),
+          m_counters(std::make_unique<RecordCounter>()),
+          m_recordCache(std::make_unique<RecordCache>()),
+          m_authCache(std::make_unique<AuthCache>()),
+          m_versions(std::make_unique<TableVersions>()),
+          m_changes(std::make_unique<ChangeFeed>())
     {
     }
 
@@ -35,79 +128,76 @@ namespace mantis
         if (MantisApp::instance().dbType() != DbType::SQLITE && conn_str.empty())
             throw std::runtime_error("Connection string for database is required!");
 
+        // SQLite tuning has to be known before the first session is opened
+        if (MantisApp::instance().dbType() == DbType::SQLITE)
+            m_sqliteProfile = loadSqliteProfile();
+
         try
         {
-            // Create connection pool instance
+            // Create connection pool instances, writes & general use vs read-only queries
             m_connPool = std::make_unique<soci::connection_pool>(MantisApp::instance().poolSize());
+            m_readPool = std::make_unique<soci::connection_pool>(MantisApp::instance().readPoolSize());
 
             // Populate the pools with db connections
             for (int i = 0; i < MantisApp::instance().poolSize(); ++i)
             {
-                switch (MantisApp::instance().dbType())
-                {
-                case DbType::SQLITE:
-                    {
-                        // For SQLite, lets explicitly define location and name of the database
-                        // we intend to use within the `dataDir`
-                        auto sqlite_db_path = joinPaths(MantisApp::instance().dataDir(), "mantis.db").string();
-                        soci::session& sql = m_connPool->at(i);
-
-                        auto sqlite_conn_str = std::format(
-                            "db={} timeout=30 shared_cache=true synchronous=normal foreign_keys=on", sqlite_db_path);
-                        sql.open(soci::sqlite3, sqlite_conn_str);
-                        sql.set_logger(new MantisLoggerImpl()); // Set custom query logger
-
-                        // Log SQL insert values in DevMode only!
-                        if (MantisApp::instance().isDevMode())
-                            sql.set_query_context_logging_mode(soci::log_context::always);
-                        else
-                            sql.set_query_context_logging_mode(soci::log_context::on_error);
-
-                        // Open SQLite in WAL mode, helps in enabling multiple readers, single writer
-                        sql << "PRAGMA journal_mode=WAL";
-                        sql << "PRAGMA wal_autocheckpoint=500"; // Checkpoint every 500 pages
-
-                        break;
-                    }
-                case DbType::PSQL:
-                    {
-#if MANTIS_HAS_POSTGRESQL
-                        // Connection Options
-                        ///> Basic: "dbname=mydb user=scott password=tiger"
-                        ///> With Host: "host=localhost port=5432 dbname=test user=postgres password=postgres");
-                        ///> With Config: "dbname=mydatabase user=myuser password=mypass singlerows=true"
-
-                        soci::session& sql = m_connPool->at(i);
-                        sql.open(soci::postgresql, conn_str);
-                        sql.set_logger(new MantisLoggerImpl()); // Set custom query logger
-
-                        // Log SQL insert values in DevMode only!
-                        if (MantisApp::instance().isDevMode())
-                            sql.set_query_context_logging_mode(soci::log_context::always);
-                        else
-                            sql.set_query_context_logging_mode(soci::log_context::on_error);
-
-                        break;
-#else
-                        Log::warn("Database Connection for `PostgreSQL` has not been implemented yet!");
-                        return false;
-#endif
-                    }
-                case DbType::MYSQL:
-                    {
-                        Log::warn("Database Connection for `MySQL` not implemented yet!");
-                        return false;
-                    }
+                if (!openSession(m_connPool->at(i), conn_str, false))
+                    return false;
+            }
 
-                // For other DB types
-                // Connect to the database URL, no checks here,
-                // make your damn checks to ensure the URL is VALID!
-                // TODO maybe add checks?
+            // Readers can be pointed to a replica, PostgreSQL only
+            const auto replica = MantisApp::instance().replicaConnString();
+            const auto& read_conn_str = replica.empty() ? conn_str : replica;
+            if (!replica.empty() && MantisApp::instance().dbType() == DbType::PSQL)
+                Log::info("Routing reads to the replica database");
 
-                default:
-                    Log::warn("Database Connection to `{}` Not Implemented Yet!", conn_str);
+            for (int i = 0; i < MantisApp::instance().readPoolSize(); ++i)
+            {
+                if (!openSession(m_readPool->at(i), read_conn_str, true))
                     return false;
-                }
+            }
+
+            // For SQLite, funnel all writes through a single writer connection
+            if (MantisApp::instance().dbType() == DbType::SQLITE && MantisApp::instance().isWriteQueueEnabled())
+            {
+                auto writer = std::make_unique<soci::session>();
+                openSqliteSession(*writer);
+
+                m_writeQueue = std::make_unique<WriteQueue>(std::move(writer));
+                m_writeQueue->setChangeFeed(m_changes.get());
+                m_changes->attach(m_writeQueue->session());
+                m_writeQueue->start();
+                m_stmtCache->addSession(m_writeQueue->session());
+            }
+
+            // Capture record changes on every connection that writes, @see ChangeFeed
+            if (MantisApp::instance().dbType() == DbType::SQLITE)
+            {
+                auto resolver = std::make_unique<soci::session>();
+                openSqliteSession(*resolver, true);
+                m_changes->startSqlite(std::move(resolver));
+
+                for (int i = 0; i < MantisApp::instance().poolSize(); ++i)
+                    m_changes->attach(m_connPool->at(i));
+            }
+            else if (MantisApp::instance().dbType() == DbType::PSQL)
+            {
+                m_changes->startPostgres(m_connPool->at(0), conn_str);
+            }
+
+            // For SQLite, checkpoint the WAL in the background instead of on committing requests
+            if (MantisApp::instance().dbType() == DbType::SQLITE)
+            {
+                auto checkpointer = std::make_unique<soci::session>();
+                openSqliteSession(*checkpointer);
+
+                const auto wal_path = joinPaths(MantisApp::instance().dataDir(), "mantis.db-wal");
+                m_checkpointer = std::make_unique<WalCheckpointer>(std::move(checkpointer), wal_path);
+                m_checkpointer->start();
+
+                // No automatic checkpoints on commit from now on, these stall whichever request
+                // commits past the threshold
+                setAutoCheckpoint(false);
             }
         }
 
@@ -129,6 +219,34 @@ namespace mantis
             return false;
         }
 
+        // Writes read back their rows in the same statement, where supported
+        try
+        {
+            m_supportsReturning = hasReturningSupport(m_connPool->at(0));
+        }
+        catch (const std::exception& e)
+        {
+            Log::warn("Could not check for RETURNING support: {}", e.what());
+        }
+
+        // Report the effective SQLite tuning, values the database ignored show up here
+        if (MantisApp::instance().dbType() == DbType::SQLITE)
+        {
+            try
+            {
+                m_sqlitePragmas = sqlitePragmas(m_connPool->at(0));
+                Log::info("SQLite pragmas: {}", m_sqlitePragmas.dump());
+            }
+            catch (const std::exception& e)
+            {
+                Log::warn("Could not read back SQLite pragmas: {}", e.what());
+            }
+        }
+
+        // Cache prepared statements per pooled connection
+        m_stmtCache->addPool(*m_connPool, MantisApp::instance().poolSize());
+        m_stmtCache->addPool(*m_readPool, MantisApp::instance().readPoolSize());
+
         if (MantisApp::instance().dbType() == DbType::SQLITE)
         {
             // Write checkpoint out
@@ -140,27 +258,32 @@ namespace mantis
 
     void DatabaseUnit::disconnect() const
     {
-        // Write checkpoint out
-        writeCheckpoint();
+        // Commit any queued writes, then stop the writer thread
+        if (m_writeQueue) m_writeQueue->stop();
+
+        // No more writes to capture, release the hooks & the feed's own connections
+        m_changes->stop();
 
-        // Pool size cast
-        const auto pool_size = static_cast<size_t>(MantisApp::instance().poolSize());
-        // Close all sessions in the pool
-        for (std::size_t i = 0; i < pool_size; ++i)
+        // Stop background checkpoints, then write out whatever is left in the WAL
+        if (m_checkpointer)
         {
-            try
-            {
-                if (soci::session& sess = m_connPool->at(i); sess.is_connected())
-                {
-                    // Check if session is connected
-                    sess.close();
-                }
-            }
-            catch (const soci::soci_error& e)
-            {
-                Log::critical("Database disconnection soci::error at index `{}`: {}", i, e.what());
-            }
+            m_checkpointer->stop();
+            setAutoCheckpoint(true);
         }
+        writeCheckpoint();
+
+        // Finalize cached statements while their sessions are still open
+        m_stmtCache->clear();
+
+        if (m_writeQueue && m_writeQueue->session().is_connected())
+            m_writeQueue->session().close();
+
+        if (m_checkpointer && m_checkpointer->session().is_connected())
+            m_checkpointer->session().close();
+
+        // Close all sessions in the pools
+        closePool(m_connPool.get(), MantisApp::instance().poolSize());
+        closePool(m_readPool.get(), MantisApp::instance().readPoolSize());
     }
 
     bool DatabaseUnit::migrate() const
@@ -179,6 +302,8 @@ namespace mantis
             AdminTable admin;
             admin.name = "__admins";
             *sql << admin.to_sql();
+            for (const auto& index_ddl : admin.to_index_sql())
+                *sql << index_ddl;
 
             // Create and manage other db tables, keeping track of access rules, schema, etc.!
             SystemTable tables;
@@ -195,6 +320,9 @@ namespace mantis
             _sys.fields.emplace_back("value", FieldType::JSON, true, false, true);
             *sql << _sys.to_sql();
 
+            // __sync_seq & __sync_log for incremental sync of user tables
+            SyncLog::migrate(*sql);
+
             // Commit changes
             tr.commit();
 
@@ -212,7 +340,31 @@ namespace mantis
 
     std::shared_ptr<soci::session> DatabaseUnit::session() const
     {
-        return std::make_shared<soci::session>(*m_connPool);
+        // Changes committed on the session outside write() & query() are published as it's
+        // returned to the pool, before another thread can lease it
+        const auto changes = m_changes.get();
+        std::shared_ptr<soci::session> sql(new soci::session(*m_connPool), [changes](soci::session* s)
+        {
+            try
+            {
+                changes->flush(*s);
+            }
+            catch (const std::exception& e)
+            {
+                Log::critical("Publishing record changes failed: {}", e.what());
+            }
+            delete s;
+        });
+
+        changes->prepare(*sql);
+        return sql;
+    }
+
+    std::shared_ptr<soci::session> DatabaseUnit::readSession() const
+    {
+        // Read pool is created alongside the main pool, but be safe
+        if (!m_readPool) return session();
+        return std::make_shared<soci::session>(*m_readPool);
     }
 
     soci::connection_pool& DatabaseUnit::connectionPool() const
@@ -220,6 +372,110 @@ namespace mantis
         return *m_connPool;
     }
 
+    StatementCache& DatabaseUnit::statements() const
+    {
+        return *m_stmtCache;
+    }
+
+    RecordCounter& DatabaseUnit::counters() const
+    {
+        return *m_counters;
+    }
+
+    RecordCache& DatabaseUnit::recordCache() const
+    {
+        return *m_recordCache;
+    }
+
+    AuthCache& DatabaseUnit::authCache() const
+    {
+        return *m_authCache;
+    }
+
+    TableVersions& DatabaseUnit::versions() const
+    {
+        return *m_versions;
+    }
+
+    ChangeFeed& DatabaseUnit::changes() const
+    {
+        return *m_changes;
+    }
+
+    bool DatabaseUnit::write(const WriteJob& job) const
+    {
+        if (m_writeQueue)
+            return m_writeQueue->submit(job);
+
+        // No writer queue, run the job within a transaction on a pooled session
+        const auto sql = session();
+        soci::transaction tr(*sql);
+
+        if (!job(*sql))
+        {
+            tr.rollback();
+            return false;
+        }
+
+        tr.commit();
+        m_changes->flush(*sql);
+        return true;
+    }
+
+    WriteQueue* DatabaseUnit::writeQueue() const
+    {
+        return m_writeQueue.get();
+    }
+
+    const SqliteProfile& DatabaseUnit::sqliteProfile() const
+    {
+        return m_sqliteProfile;
+    }
+
+    WalCheckpointer* DatabaseUnit::checkpointer() const
+    {
+        return m_checkpointer.get();
+    }
+
+    void DatabaseUnit::setAutoCheckpoint(const bool enabled) const
+    {
+        if (MantisApp::instance().dbType() != DbType::SQLITE) return;
+
+        // Only writing connections checkpoint, readers are `query_only`
+        const auto pragma = std::format("PRAGMA wal_autocheckpoint={}",
+                                        enabled ? WalCheckpointer::AUTOCHECKPOINT_PAGES : 0);
+        try
+        {
+            for (int i = 0; i < MantisApp::instance().poolSize(); ++i)
+                m_connPool->at(i) << pragma;
+
+            if (m_writeQueue) m_writeQueue->session() << pragma;
+        }
+        catch (const std::exception& e)
+        {
+            Log::warn("Could not set `wal_autocheckpoint`: {}", e.what());
+        }
+    }
+
+    json DatabaseUnit::metrics() const
+    {
+        json metrics;
+        metrics["statements"] = m_stmtCache->stats();
+        metrics["recordCounts"] = m_counters->stats();
+        metrics["recordCache"] = m_recordCache->stats();
+        metrics["authCache"] = m_authCache->stats();
+        metrics["changes"] = m_changes->stats();
+        metrics["writeQueue"] = m_writeQueue ? m_writeQueue->stats() : json(nullptr);
+        metrics["checkpoints"] = m_checkpointer ? m_checkpointer->stats() : json(nullptr);
+        metrics["sqlite"] = m_sqlitePragmas.empty() ? json(nullptr) : m_sqlitePragmas;
+        return metrics;
+    }
+
+    bool DatabaseUnit::supportsReturning() const
+    {
+        return m_supportsReturning;
+    }
+
     nlohmann::json DatabaseUnit::rowToJson(const soci::row& r)
     {
         nlohmann::json j;
@@ -427,8 +683,9 @@ namespace mantis
 
         }
 
-        // Get SQL Session
-        auto sql = session();
+        // Get SQL Session, plain SELECTs can be served by the read pool
+        const auto is_select = isSelectQuery(query);
+        auto sql = is_select ? readSession() : session();
 
         Log::trace("[JS] soci::value binding? {}", nargs-1);
 
@@ -439,6 +696,15 @@ namespace mantis
                                          : (sql->prepare << query, soci::use(vals), soci::into(data_row));
         st.execute(); // Execute statement
 
+        // Raw writes may touch any record, don't serve cached ones past them
+        if (!is_select)
+        {
+            m_recordCache->clear();
+            m_authCache->clear();
+            m_versions->bumpAll();
+            m_changes->flush(*sql);
+        }
+
         json results = json::array();
         while (st.fetch())
         {
@@ -462,6 +728,259 @@ namespace mantis
         return 1; // Return the object
     }
 
+    bool DatabaseUnit::openSession(soci::session& sql, const std::string& conn_str, const bool readOnly) const
+    {
+        switch (MantisApp::instance().dbType())
+        {
+        case DbType::SQLITE:
+            {
+                openSqliteSession(sql, readOnly);
+                return true;
+            }
+        case DbType::PSQL:
+            {
+#if MANTIS_HAS_POSTGRESQL
+                // Connection Options
+                ///> Basic: "dbname=mydb user=scott password=tiger"
+                ///> With Host: "host=localhost port=5432 dbname=test user=postgres password=postgres");
+                ///> With Config: "dbname=mydatabase user=myuser password=mypass singlerows=true"
+
+                sql.open(soci::postgresql, conn_str);
+                sql.set_logger(new MantisLoggerImpl()); // Set custom query logger
+
+                // Log SQL insert values in DevMode only!
+                if (MantisApp::instance().isDevMode())
+                    sql.set_query_context_logging_mode(soci::log_context::always);
+                else
+                    sql.set_query_context_logging_mode(soci::log_context::on_error);
+
+                // Reject writes on the read pool, even when it points to the primary database
+                if (readOnly)
+                    sql << "SET SESSION CHARACTERISTICS AS TRANSACTION READ ONLY";
+
+                return true;
+#else
+                Log::warn("Database Connection for `PostgreSQL` has not been implemented yet!");
+                return false;
+#endif
+            }
+        case DbType::MYSQL:
+            {
+                Log::warn("Database Connection for `MySQL` not implemented yet!");
+                return false;
+            }
+
+        // For other DB types
+        // Connect to the database URL, no checks here,
+        // make your damn checks to ensure the URL is VALID!
+        // TODO maybe add checks?
+
+        default:
+            Log::warn("Database Connection to `{}` Not Implemented Yet!", conn_str);
+            return false;
+        }
+    }
+
+    void DatabaseUnit::openSqliteSession(soci::session& sql, const bool readOnly) const
+    {
+        // For SQLite, lets explicitly define location and name of the database
+        // we intend to use within the `dataDir`
+        const auto sqlite_db_path = joinPaths(MantisApp::instance().dataDir(), "mantis.db").string();
+
+        // Busy timeout is set through the profile pragmas, in milliseconds
+        const auto sqlite_conn_str = std::format(
+            "db={} shared_cache={} synchronous=normal foreign_keys=on", sqlite_db_path,
+            m_sqliteProfile.sharedCache ? "true" : "false");
+        sql.open(soci::sqlite3, sqlite_conn_str);
+        sql.set_logger(new MantisLoggerImpl()); // Set custom query logger
+
+        // Log SQL insert values in DevMode only!
+        if (MantisApp::instance().isDevMode())
+            sql.set_query_context_logging_mode(soci::log_context::always);
+        else
+            sql.set_query_context_logging_mode(soci::log_context::on_error);
+
+        for (const auto& pragma : m_sqliteProfile.pragmas())
+            sql << pragma;
+
+        // Open SQLite in WAL mode, helps in enabling multiple readers, single writer
+        sql << "PRAGMA journal_mode=WAL";
+
+        // Readers never write, any attempt fails with SQLITE_READONLY
+        if (readOnly)
+            sql << "PRAGMA query_only=1";
+    }
+
+    SqliteProfile DatabaseUnit::loadSqliteProfile()
+    {
+        SqliteProfile profile;
+
+        // Stored settings, the settings table may not exist yet on the first start
+        try
+        {
+            const auto sqlite_db_path = joinPaths(MantisApp::instance().dataDir(), "mantis.db").string();
+            soci::session sql;
+            sql.open(soci::sqlite3, std::format("db={}", sqlite_db_path));
+
+            int tables = 0;
+            sql << "SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = '__settings'",
+                soci::into(tables);
+
+            if (tables > 0)
+            {
+                json settings;
+                const auto id = std::to_string(std::hash<std::string>{}("configs"));
+                sql << "SELECT value FROM __settings WHERE id = :id LIMIT 1", soci::use(id), soci::into(settings);
+
+                if (sql.got_data() && settings.contains("sqliteProfile"))
+                    profile = SqliteProfile::fromJson(settings["sqliteProfile"], profile);
+            }
+        }
+        catch (const std::exception& e)
+        {
+            Log::warn("Ignoring the stored SQLite profile: {}", e.what());
+        }
+
+        // Command line values take precedence, validated when parsing the args
+        return SqliteProfile::fromJson(MantisApp::instance().sqliteProfile(), profile);
+    }
+
+    json DatabaseUnit::sqlitePragmas(soci::session& sql)
+    {
+        json pragmas = json::object();
+        for (const auto& name : {
+                 "page_size", "mmap_size", "cache_size", "temp_store", "busy_timeout", "synchronous",
+                 "wal_autocheckpoint"
+             })
+        {
+            long long value = 0;
+            sql << std::format("PRAGMA {}", name), soci::into(value);
+            pragmas[name] = value;
+        }
+
+        std::string journal_mode;
+        sql << "PRAGMA journal_mode", soci::into(journal_mode);
+        pragmas["journal_mode"] = journal_mode;
+
+        return pragmas;
+    }
+
+    void DatabaseUnit::closePool(soci::connection_pool* pool, const int size)
+    {
+        if (pool == nullptr) return;
+
+        for (std::size_t i = 0; i < static_cast<size_t>(size); ++i)
+        {
+            try
+            {
+                if (soci::session& sess = pool->at(i); sess.is_connected())
+                {
+                    // Check if session is connected
+                    sess.close();
+                }
+            }
+            catch (const soci::soci_error& e)
+            {
+                Log::critical("Database disconnection soci::error at index `{}`: {}", i, e.what());
+            }
+        }
+    }
+
+    bool DatabaseUnit::isSelectQuery(const std::string& query)
+    {
+        // Words of the statement, skipping comments, string literals & quoted identifiers
+        std::vector<std::string> words;
+        bool ended = false;
+        for (size_t i = 0; i < query.size();)
+        {
+            const auto c = query[i];
+            const auto next = i + 1 < query.size() ? query[i + 1] : '\0';
+
+            if (c == '-' && next == '-')
+            {
+                i = query.find('\n', i);
+                if (i == std::string::npos) break;
+                continue;
+            }
+
+            if (c == '/' && next == '*')
+            {
+                const auto end = query.find("*/", i + 2);
+                if (end == std::string::npos) return false;
+                i = end + 2;
+                continue;
+            }
+
+            if (std::isspace(static_cast<unsigned char>(c)))
+            {
+                ++i;
+                continue;
+            }
+
+            // Anything past the end of the first statement is a second statement
+            if (ended) return false;
+            if (c == ';')
+            {
+                ended = true;
+                ++i;
+                continue;
+            }
+
+            // Doubled quotes within are read as two adjacent literals
+            if (c == '\'' || c == '"' || c == '`' || c == '[')
+            {
+                const auto end = query.find(c == '[' ? ']' : c, i + 1);
+                if (end == std::string::npos) return false;
+                i = end + 1;
+                continue;
+            }
+
+            if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+            {
+                auto end = i;
+                while (end < query.size() && (std::isalnum(static_cast<unsigned char>(query[end])) || query[end] == '_'))
+                    ++end;
+
+                auto word = query.substr(i, end - i);
+                toLowerCase(word);
+                words.push_back(std::move(word));
+                i = end;
+                continue;
+            }
+
+            ++i;
+        }
+
+        if (words.empty()) return false;
+
+        const auto& first = words.front();
+        if (first != "select" && first != "values" && first != "with") return false;
+
+        // Writes through a CTE (`WITH ... DELETE`), row locks & `SELECT INTO` need the primary
+        return std::ranges::none_of(words, [](const std::string& word)
+        {
+            return word == "insert" || word == "update" || word == "delete" || word == "into" || word == "merge";
+        });
+    }
+
+    bool DatabaseUnit::hasReturningSupport(soci::session& sql)
+    {
+        const auto backend = sql.get_backend_name();
+        if (backend == "postgresql") return true;
+        if (backend != "sqlite3") return false;
+
+        // Added in SQLite 3.35.0, check the linked library rather than the headers
+        std::string version;
+        sql << "SELECT sqlite_version()", soci::into(version);
+
+        const auto parts = splitString(version, ".");
+        if (parts.size() < 2) return false;
+
+        const auto major = std::stoi(parts[0]);
+        const auto minor = std::stoi(parts[1]);
+        return major > 3 || (major == 3 && minor >= 35);
+    }
+
     void DatabaseUnit::writeCheckpoint() const
     {
         // Enable this write checkpoint for SQLite databases ONLY
@@ -0,0 +1,287 @@
+#include "../../include/mantis/core/exporter.h"
+#include "../../include/mantis/core/database.h"
+#include "../../include/mantis/core/json_writer.h"
+#include "../../include/mantis/core/query_filter.h"
+#include "../../include/mantis/app/app.h"
+#include "../../include/mantis/utils/utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <format>
+
+#define __file__ "core/exporter.cpp"
+
+namespace mantis
+{
+    namespace
+    {
+        constexpr auto CURSOR_NAME = "mantis_export";
+
+        ///> Exports holding a slot, across all tables
+        std::atomic<size_t> g_activeExports{0};
+
+        bool isTextType(const std::string& type)
+        {
+            return type == "xml" || type == "string" || type == "file";
+        }
+    }
+
+    RecordExporter::RecordExporter(std::string format)
+        : m_format(std::move(format))
+    {
+        if (m_format != "ndjson" && m_format != "csv")
+            throw std::invalid_argument(std::format("Unsupported export format `{}`, expected `ndjson` or `csv`",
+                                                    m_format));
+    }
+
+    RecordExporter::~RecordExporter()
+    {
+        // Statement first, the bound values & the cursor's transaction have to outlive it
+        m_stmt.reset();
+        m_row.reset();
+        m_tr.reset();
+        m_sql.reset();
+
+        if (m_slot) --g_activeExports;
+    }
+
+    size_t RecordExporter::slots()
+    {
+        return static_cast<size_t>(std::max(1, MantisApp::instance().readPoolSize() / 2));
+    }
+
+    bool RecordExporter::acquire(const size_t limit)
+    {
+        if (m_slot) return true;
+
+        auto active = g_activeExports.load();
+        do
+        {
+            if (active >= limit) return false;
+        }
+        while (!g_activeExports.compare_exchange_weak(active, active + 1));
+
+        m_slot = true;
+        return true;
+    }
+
+    std::string RecordExporter::open(TableUnit& table, const json& opts)
+    {
+        TRACE_CLASS_METHOD()
+
+        m_tableName = table.tableName();
+        m_tableType = table.tableType();
+        m_fields = table.fields();
+
+        CompiledQuery compiled;
+        try
+        {
+            compiled = QueryFilter(m_fields).compile(opts.value("filter", ""), opts.value("sort", ""));
+        }
+        catch (const std::invalid_argument& e)
+        {
+            return e.what();
+        }
+
+        std::string columns;
+        if (const auto err = table.selectColumns(opts.value("fields", ""), columns); !err.empty())
+            return err;
+
+        // Header of empty CSV exports, there is no row to read the columns from
+        if (columns == "*")
+        {
+            for (const auto& field : m_fields)
+            {
+                const auto name = field.value("name", "");
+                const auto type = field.value("type", "");
+                if (type == "blob" || (m_tableType == "auth" && name == "password")) continue;
+                m_header.push_back(name);
+            }
+        }
+        else
+        {
+            m_header = splitString(columns, ", ");
+        }
+
+        // Newest first, as for lists; `id` breaks ties so the order is stable
+        auto query = "SELECT " + columns + " FROM " + m_tableName;
+        if (!compiled.where.empty()) query += " WHERE " + compiled.where;
+        query += " ORDER BY " + (compiled.orderBy.empty() ? std::string("created DESC, id DESC") : compiled.orderBy);
+
+        QueryFilter::bind(m_values, compiled.params);
+
+        // Exports are long-lived, keep them off the statement cache
+        m_sql = MantisApp::instance().db().readSession();
+        m_row = std::make_unique<soci::row>();
+
+        if (m_sql->get_backend_name() == "postgresql")
+        {
+            // The whole result would be buffered by libpq, fetch it in batches from a cursor instead
+            m_cursor = true;
+            m_tr = std::make_unique<soci::transaction>(*m_sql);
+
+            const auto declare = std::format("DECLARE {} NO SCROLL CURSOR FOR {}", CURSOR_NAME, query);
+            if (compiled.params.empty()) *m_sql << declare;
+            else *m_sql << declare, soci::use(m_values);
+        }
+        else
+        {
+            // SQLite steps through the result, one row at a time
+            m_stmt = compiled.params.empty()
+                         ? std::make_unique<soci::statement>((m_sql->prepare << query, soci::into(*m_row)))
+                         : std::make_unique<soci::statement>((m_sql->prepare << query, soci::use(m_values),
+                                                              soci::into(*m_row)));
+            m_stmt->execute(false);
+        }
+
+        // Column types are resolved once, from the first row, while the table is at hand
+        if (fetch())
+        {
+            m_pending = true;
+
+            std::vector<std::string> hidden;
+            if (m_tableType == "auth") hidden.emplace_back("password");
+            m_columns = table.rowColumns(*m_row, m_fields, hidden);
+
+            // CSV columns follow the select order, NDJSON objects sort their keys
+            if (m_format == "csv")
+                std::ranges::sort(m_columns, {}, &TableUnit::RowColumn::index);
+        }
+
+        return "";
+    }
+
+    bool RecordExporter::next(std::string& chunk)
+    {
+        chunk.clear();
+        if (m_done) return false;
+
+        if (m_format == "csv" && m_rows == 0)
+        {
+            // Header row, from the columns if any record matched
+            std::vector<std::string> names;
+            if (m_columns.empty()) names = m_header;
+            else for (const auto& column : m_columns) names.push_back(column.name);
+
+            for (size_t i = 0; i < names.size(); ++i)
+            {
+                if (i > 0) chunk.push_back(',');
+                appendCsvField(chunk, names[i]);
+            }
+            chunk += "\r\n";
+        }
+
+        while (chunk.size() < CHUNK_SIZE)
+        {
+            if (m_pending) m_pending = false;
+            else if (!fetch())
+            {
+                m_done = true;
+                break;
+            }
+
+            if (m_format == "csv")
+            {
+                writeCsvRow(chunk);
+            }
+            else
+            {
+                JsonWriter w(chunk);
+                TableUnit::writeDbRowJson(w, *m_row, m_columns);
+                chunk.push_back('\n');
+            }
+
+            ++m_rows;
+        }
+
+        // Release the cursor as soon as it's drained, not when the response is
+        if (m_done)
+        {
+            m_stmt.reset();
+            m_tr.reset();
+        }
+
+        return !chunk.empty();
+    }
+
+    std::string RecordExporter::contentType() const
+    {
+        return m_format == "csv" ? "text/csv; charset=utf-8" : "application/x-ndjson";
+    }
+
+    size_t RecordExporter::rows() const
+    {
+        return m_rows;
+    }
+
+    void RecordExporter::appendCsvField(std::string& out, const std::string_view value)
+    {
+        if (value.find_first_of(",\"\r\n") == std::string_view::npos)
+        {
+            out += value;
+            return;
+        }
+
+        out.push_back('"');
+        for (const char c : value)
+        {
+            if (c == '"') out.push_back('"');
+            out.push_back(c);
+        }
+        out.push_back('"');
+    }
+
+    bool RecordExporter::fetch()
+    {
+        if (!m_cursor) return m_stmt->fetch();
+
+        if (m_stmt && m_stmt->fetch())
+        {
+            ++m_batchRows;
+            return true;
+        }
+
+        // A short batch means the cursor is drained
+        if (m_stmt && m_batchRows < FETCH_SIZE) return false;
+
+        m_stmt.reset();
+        m_row = std::make_unique<soci::row>();
+        m_stmt = std::make_unique<soci::statement>(
+            (m_sql->prepare << std::format("FETCH {} FROM {}", FETCH_SIZE, CURSOR_NAME), soci::into(*m_row)));
+        m_stmt->execute(true);
+
+        m_batchRows = m_stmt->got_data() ? 1 : 0;
+        return m_batchRows > 0;
+    }
+
+    void RecordExporter::writeCsvRow(std::string& chunk)
+    {
+        const auto& row = *m_row;
+        for (size_t n = 0; n < m_columns.size(); ++n)
+        {
+            if (n > 0) chunk.push_back(',');
+
+            const auto& column = m_columns[n];
+            if (row.get_indicator(column.index) == soci::i_null) continue;
+
+            if (isTextType(column.type))
+            {
+                appendCsvField(chunk, row.get<std::string>(column.index, ""));
+            }
+            else if (column.type == "date")
+            {
+                appendCsvField(chunk, dbDateToString(MantisApp::instance().dbTypeByName(), row,
+                                                     static_cast<int>(column.index)));
+            }
+            else
+            {
+                // Numbers, booleans & JSON values, written as JSON text
+                m_scratch.clear();
+                JsonWriter w(m_scratch);
+                TableUnit::writeDbValueJson(w, row, column);
+                appendCsvField(chunk, m_scratch);
+            }
+        }
+        chunk += "\r\n";
+    }
+}
@@ -1,6 +1,8 @@
 #include "../../include/mantis/core/expr_evaluator.h"
 #include "../../include/mantis/core/logging.h"
 
+#include <vector>
+
 #define __file__ "core/evaluator.cpp"
 
 namespace mantis
@@ -24,6 +26,93 @@ namespace mantis
         return evaluate(expr, t_vars);
     }
 
+    bool ExprEvaluator::evaluate(const CompiledRule& rule, const TokenMap& vars)
+    {
+        if (!rule.program) return false;
+
+        try
+        {
+            return rule.program->eval(vars).asBool(); // true/false
+        } catch (std::exception& e)
+        {
+            Log::critical("Error evaluating expression '{}', error: {}", rule.expr, e.what());
+            return false;
+        }
+    }
+
+    CompiledRule ExprEvaluator::compile(const std::string& expr)
+    {
+        CompiledRule rule;
+        rule.expr = trim(expr);
+        if (rule.expr.empty()) return rule;
+
+        try
+        {
+            // Parsed without variables, so they are all resolved on evaluation
+            const TokenMap scope;
+            cparse::TokenQueue_t rpn = calculator::toRPN(rule.expr.c_str(), scope);
+
+            // The parser accepts dangling operators & brackets, e.g. `a ==` or `(a`,
+            // check every operator has its two operands & a single value is left
+            size_t depth = 0;
+            bool complete = true;
+            std::vector<const cparse::TokenBase*> tokens;
+            for (auto queue = rpn; !queue.empty(); queue.pop())
+            {
+                tokens.push_back(queue.front());
+                if (queue.front()->type != cparse::OP) ++depth;
+                else if (depth < 2) complete = false;
+                else --depth;
+            }
+
+            // Record the fields read of `auth` & `req`. A member access compiles to
+            // `<var> "<field>" .` (or `[]`), anything else needs the whole variable.
+            const auto text = [](const cparse::TokenBase* token)
+            {
+                return static_cast<const cparse::Token<std::string>*>(token)->val;
+            };
+
+            for (size_t i = 0; i < tokens.size(); ++i)
+            {
+                if (tokens[i]->type != cparse::VAR) continue;
+
+                const auto name = text(tokens[i]);
+                if (name != "auth" && name != "req") continue;
+
+                auto& refs = name == "auth" ? rule.auth : rule.req;
+                refs.used = true;
+
+                if (i + 2 < tokens.size()
+                    && tokens[i + 1]->type == cparse::STR
+                    && tokens[i + 2]->type == cparse::OP
+                    && (text(tokens[i + 2]) == "." || text(tokens[i + 2]) == "[]"))
+                {
+                    refs.fields.insert(text(tokens[i + 1]));
+                }
+                else
+                {
+                    refs.all = true;
+                }
+            }
+            cparse::rpnBuilder::cleanRPN(&rpn);
+
+            if (!complete || depth != 1)
+            {
+                rule.error = "Incomplete expression, an operand or bracket is missing";
+                return rule;
+            }
+
+            auto program = std::make_shared<calculator>();
+            program->compile(rule.expr.c_str(), scope);
+            rule.program = std::move(program);
+        } catch (std::exception& e)
+        {
+            rule.error = e.what();
+        }
+
+        return rule;
+    }
+
     TokenMap ExprEvaluator::jsonToTokenMap(const json& j)
     {
         cparse::TokenMap map;
@@ -64,6 +64,14 @@ namespace mantis
 
     HttpUnit::HttpUnit()
     {
+        // Realtime streams hold a worker each for as long as they're open, the pool is sized for
+        // requests plus the capped number of streams, all workers started upfront
+        svr.new_task_queue = []
+        {
+            const auto streams = static_cast<size_t>(MantisApp::instance().maxSubscribers());
+            return new httplib::ThreadPool(CPPHTTPLIB_THREAD_POOL_COUNT + streams);
+        };
+
         // Let's fix timing initialization, set the start time to current time
         svr.set_pre_routing_handler([](const httplib::Request& req, httplib::Response& res)
         {
@@ -0,0 +1,640 @@
+#include "../../include/mantis/core/importer.h"
+#include "../../include/mantis/core/tables/tables.h"
+#include "../../include/mantis/core/database.h"
+#include "../../include/mantis/core/logging.h"
+#include "../../include/mantis/app/app.h"
+#include "../../include/mantis/utils/utils.h"
+
+#include <algorithm>
+#include <charconv>
+#include <ctime>
+#include <filesystem>
+#include <format>
+#include <map>
+
+#if MANTIS_HAS_POSTGRESQL
+#include <soci/postgresql/soci-postgresql.h>
+#endif
+
+#define __file__ "core/importer.cpp"
+
+namespace mantis
+{
+    namespace
+    {
+        constexpr auto EOF_CHAR = std::char_traits<char>::eof();
+
+        bool isIntegerType(const std::string& type)
+        {
+            return type == "int8" || type == "uint8" || type == "int16" || type == "uint16" ||
+                type == "int32" || type == "uint32" || type == "int64" || type == "uint64";
+        }
+
+        void skipWhitespace(std::istream& in)
+        {
+            while (in.peek() != EOF_CHAR && std::isspace(in.peek())) in.get();
+        }
+
+        std::string joinColumns(const std::vector<std::string>& columns)
+        {
+            std::string out;
+            for (const auto& column : columns)
+                out += out.empty() ? column : ", " + column;
+            return out;
+        }
+
+#if MANTIS_HAS_POSTGRESQL
+        /// Append a value in the `COPY` text format, escaping the delimiters
+        void appendCopyText(std::string& out, const std::string& value)
+        {
+            for (const char c : value)
+            {
+                switch (c)
+                {
+                case '\\': out += "\\\\";
+                    break;
+                case '\t': out += "\\t";
+                    break;
+                case '\n': out += "\\n";
+                    break;
+                case '\r': out += "\\r";
+                    break;
+                default: out.push_back(c);
+                }
+            }
+        }
+#endif
+    }
+
+    json ImportStats::toJson() const
+    {
+        return {
+            {"rows", rows},
+            {"inserted", inserted},
+            {"skipped", skipped},
+            {"batches", batches},
+            {"errors", errors},
+            {"elapsedMs", elapsed.count()}
+        };
+    }
+
+    RecordImporter::RecordImporter(TableUnit& table, std::string format)
+        : m_table(table),
+          m_tableName(table.tableName()),
+          m_format(std::move(format))
+    {
+        toLowerCase(m_format);
+        if (m_format == "jsonl") m_format = "ndjson";
+
+        if (m_format != "csv" && m_format != "ndjson" && m_format != "json")
+            throw std::invalid_argument(std::format("Unsupported import format `{}`, expected `csv`, `ndjson` or `json`",
+                                                    m_format));
+
+        if (table.tableType() == "view")
+            throw std::invalid_argument(std::format("Table `{}` is a view, views are read only", m_tableName));
+    }
+
+    void RecordImporter::setBatchSize(const size_t size)
+    {
+        m_batchSize = std::clamp<size_t>(size, 1, MAX_BATCH_SIZE);
+    }
+
+    size_t RecordImporter::parseBatchSize(const std::string& value)
+    {
+        size_t size = 0;
+        const auto end = value.data() + value.size();
+        if (const auto [ptr, ec] = std::from_chars(value.data(), end, size);
+            ec != std::errc() || ptr != end || size < 1 || size > MAX_BATCH_SIZE)
+            throw std::invalid_argument(std::format("`batchSize` should be an integer between 1 and {}",
+                                                    MAX_BATCH_SIZE));
+        return size;
+    }
+
+    size_t RecordImporter::batchSize() const
+    {
+        return m_batchSize;
+    }
+
+    void RecordImporter::setSkipInvalid(const bool skip)
+    {
+        m_skipInvalid = skip;
+    }
+
+    void RecordImporter::onProgress(ProgressCallback callback)
+    {
+        m_onProgress = std::move(callback);
+    }
+
+    ImportStats RecordImporter::run(std::istream& in)
+    {
+        TRACE_CLASS_METHOD()
+
+        const auto start = std::chrono::steady_clock::now();
+        m_stats = ImportStats{};
+        m_csvHeader.clear();
+        m_started = false;
+
+        std::vector<Row> batch;
+        batch.reserve(m_batchSize);
+
+        json row;
+        std::string error;
+        while (nextRow(in, row, error))
+        {
+            ++m_stats.rows;
+
+            if (error.empty())
+            {
+                if (!row.is_object()) error = "Expected a JSON object";
+                else if (const auto err = m_table.validateRequestBody(row)) error = err.value();
+            }
+
+            if (!error.empty())
+            {
+                auto msg = std::format("Row {}: {}", m_stats.rows, error);
+                if (!m_skipInvalid) throw std::invalid_argument(msg);
+
+                ++m_stats.skipped;
+                if (m_stats.errors.size() < MAX_REPORTED_ERRORS) m_stats.errors.push_back(std::move(msg));
+                continue;
+            }
+
+            // Keep the schema fields only, as for record creation. Timestamps are set on insert.
+            Row r;
+            for (auto it = row.begin(); it != row.end();)
+            {
+                const auto field = m_table.findFieldByKey(it.key());
+                const auto drop = !field.has_value() || it.key() == "created" || it.key() == "updated"
+                    || field->value("type", "") == "blob"
+                    || (it.key() == "id" && (!it->is_string() || it->get<std::string>().empty()));
+
+                if (drop) it = row.erase(it);
+                else ++it;
+            }
+
+            r.hasId = row.contains("id");
+            r.entity = std::move(row);
+            batch.push_back(std::move(r));
+
+            if (batch.size() >= m_batchSize)
+            {
+                insertBatch(batch);
+                batch.clear();
+                m_stats.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+                if (m_onProgress) m_onProgress(m_stats);
+            }
+        }
+
+        if (!batch.empty())
+        {
+            insertBatch(batch);
+            m_stats.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start);
+            if (m_onProgress) m_onProgress(m_stats);
+        }
+
+        m_stats.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+        return m_stats;
+    }
+
+    const ImportStats& RecordImporter::stats() const
+    {
+        return m_stats;
+    }
+
+    std::string RecordImporter::formatFromPath(const std::string& path)
+    {
+        auto ext = std::filesystem::path(path).extension().string();
+        toLowerCase(ext);
+
+        if (ext == ".csv") return "csv";
+        if (ext == ".ndjson" || ext == ".jsonl") return "ndjson";
+        if (ext == ".json") return "json";
+        return "";
+    }
+
+    bool RecordImporter::readCsvRecord(std::istream& in, std::vector<std::string>& fields)
+    {
+        fields.clear();
+
+        auto c = in.get();
+        if (c == EOF_CHAR) return false;
+
+        std::string field;
+        bool in_quotes = false;
+        while (true)
+        {
+            if (in_quotes)
+            {
+                if (c == EOF_CHAR)
+                    throw std::invalid_argument("Unterminated quoted CSV value");
+
+                if (c == '"')
+                {
+                    // Doubled quotes are a literal quote, else the value ends here
+                    if (in.peek() == '"')
+                    {
+                        field.push_back('"');
+                        in.get();
+                    }
+                    else in_quotes = false;
+                }
+                else field.push_back(static_cast<char>(c));
+            }
+            else if (c == '"' && field.empty())
+            {
+                in_quotes = true;
+            }
+            else if (c == ',')
+            {
+                fields.push_back(std::move(field));
+                field.clear();
+            }
+            else if (c == '\n' || c == '\r' || c == EOF_CHAR)
+            {
+                if (c == '\r' && in.peek() == '\n') in.get();
+                fields.push_back(std::move(field));
+                return true;
+            }
+            else
+            {
+                field.push_back(static_cast<char>(c));
+            }
+
+            c = in.get();
+        }
+    }
+
+    bool RecordImporter::readJsonArrayElement(std::istream& in, std::string& element, bool& started)
+    {
+        element.clear();
+        skipWhitespace(in);
+
+        if (!started)
+        {
+            if (in.get() != '[')
+                throw std::invalid_argument("Expected a JSON array of objects");
+
+            started = true;
+            skipWhitespace(in);
+            if (in.peek() == ']')
+            {
+                in.get();
+                return false;
+            }
+        }
+        else
+        {
+            const auto c = in.get();
+            if (c == ']' || c == EOF_CHAR) return false;
+            if (c != ',')
+                throw std::invalid_argument("Expected `,` or `]` between JSON array elements");
+            skipWhitespace(in);
+        }
+
+        if (in.peek() != '{')
+            throw std::invalid_argument("Expected a JSON array of objects");
+
+        // Copy the object text up to its closing brace, braces within strings don't count
+        int depth = 0;
+        bool in_string = false, escaped = false;
+        for (auto c = in.get(); c != EOF_CHAR; c = in.get())
+        {
+            element.push_back(static_cast<char>(c));
+
+            if (in_string)
+            {
+                if (escaped) escaped = false;
+                else if (c == '\\') escaped = true;
+                else if (c == '"') in_string = false;
+            }
+            else if (c == '"') in_string = true;
+            else if (c == '{' || c == '[') ++depth;
+            else if ((c == '}' || c == ']') && --depth == 0) return true;
+        }
+
+        throw std::invalid_argument("Unexpected end of the JSON array");
+    }
+
+    bool RecordImporter::nextRow(std::istream& in, json& row, std::string& error)
+    {
+        error.clear();
+        row = json::object();
+
+        if (m_format == "ndjson")
+        {
+            std::string line;
+            while (std::getline(in, line))
+            {
+                if (trim(line).empty()) continue;
+
+                try { row = json::parse(line); }
+                catch (const std::exception& e)
+                {
+                    error = std::format("Invalid JSON: {}", e.what());
+                }
+                return true;
+            }
+            return false;
+        }
+
+        if (m_format == "json")
+        {
+            std::string element;
+            if (!readJsonArrayElement(in, element, m_started)) return false;
+
+            try { row = json::parse(element); }
+            catch (const std::exception& e)
+            {
+                error = std::format("Invalid JSON: {}", e.what());
+            }
+            return true;
+        }
+
+        // CSV, the header names the field of each column
+        std::vector<std::string> values;
+        if (m_csvHeader.empty())
+        {
+            if (!readCsvRecord(in, m_csvHeader))
+                throw std::invalid_argument("Expected a CSV header row");
+
+            // Drop the UTF-8 byte order mark, if any
+            if (m_csvHeader[0].starts_with("\xEF\xBB\xBF")) m_csvHeader[0].erase(0, 3);
+
+            for (auto& name : m_csvHeader)
+            {
+                name = trim(name);
+                const auto field = m_table.findFieldByKey(name);
+                if (!field.has_value())
+                    throw std::invalid_argument(std::format("Unknown field `{}` in the CSV header", name));
+                if (field->value("type", "") == "blob")
+                    throw std::invalid_argument(std::format("Field `{}` of type `blob` can't be imported", name));
+            }
+        }
+
+        // Skip blank lines
+        do
+        {
+            if (!readCsvRecord(in, values)) return false;
+        }
+        while (values.size() == 1 && values[0].empty());
+
+        if (values.size() != m_csvHeader.size())
+        {
+            error = std::format("Expected {} values, got {}", m_csvHeader.size(), values.size());
+            return true;
+        }
+
+        try
+        {
+            for (size_t i = 0; i < values.size(); ++i)
+                row[m_csvHeader[i]] = csvValue(m_csvHeader[i], values[i]);
+        }
+        catch (const std::exception& e)
+        {
+            error = e.what();
+        }
+
+        return true;
+    }
+
+    json RecordImporter::csvValue(const std::string& name, const std::string& value) const
+    {
+        if (value.empty()) return nullptr;
+
+        const auto type = m_table.findFieldByKey(name).value_or(json::object()).value("type", "");
+
+        try
+        {
+            if (isIntegerType(type))
+            {
+                size_t pos = 0;
+                const json v = type.starts_with("u")
+                                   ? json(std::stoull(value, &pos))
+                                   : json(std::stoll(value, &pos));
+                if (pos != value.size()) throw std::invalid_argument(value);
+                return v;
+            }
+
+            if (type == "double")
+            {
+                size_t pos = 0;
+                const auto v = std::stod(value, &pos);
+                if (pos != value.size()) throw std::invalid_argument(value);
+                return v;
+            }
+
+            if (type == "bool")
+            {
+                auto v = value;
+                toLowerCase(v);
+                if (v == "true" || v == "1" || v == "yes") return true;
+                if (v == "false" || v == "0" || v == "no") return false;
+                throw std::invalid_argument(value);
+            }
+
+            if (type == "json" || type == "files")
+                return json::parse(value);
+        }
+        catch (const std::exception&)
+        {
+            throw std::invalid_argument(std::format("Invalid `{}` value for field `{}`", type, name));
+        }
+
+        return value;
+    }
+
+    void RecordImporter::insertBatch(std::vector<Row>& batch)
+    {
+        for (auto& row : batch)
+        {
+            if (!row.hasId) row.entity["id"] = m_table.newRecordId();
+        }
+
+        // Group rows by their columns, missing columns keep their table defaults
+        std::map<std::vector<std::string>, std::vector<Row*>> groups;
+        for (auto& row : batch)
+        {
+            std::vector<std::string> columns;
+            for (const auto& [key, _] : row.entity.items()) columns.push_back(key);
+            groups[columns].push_back(&row);
+        }
+
+        const auto generated = std::ranges::any_of(batch, [](const Row& row) { return !row.hasId; });
+
+        // On id conflicts, retry the batch with new ids
+        for (int attempt = 1;; ++attempt)
+        {
+            try
+            {
+                const std::time_t current_t = time(nullptr);
+                const std::tm now = *std::localtime(&current_t);
+
+                MantisApp::instance().db().write([&](soci::session& sql)
+                {
+                    for (const auto& [columns, rows] : groups)
+                    {
+#if MANTIS_HAS_POSTGRESQL
+                        if (sql.get_backend_name() == "postgresql")
+                        {
+                            copyRows(sql, rows, columns, now);
+                            continue;
+                        }
+#endif
+                        insertRows(sql, rows, columns, now);
+                    }
+                    return true;
+                });
+                break;
+            }
+            catch (const soci::soci_error& e)
+            {
+                if (!generated || !m_table.isIdConflict(e) || attempt >= TableUnit::MAX_ID_ATTEMPTS) throw;
+
+                Log::debug("Record id conflict importing into `{}`, retrying the batch", m_tableName);
+                for (auto& row : batch)
+                {
+                    if (!row.hasId) row.entity["id"] = m_table.newRecordId();
+                }
+            }
+        }
+
+        MantisApp::instance().db().counters().add(m_tableName, static_cast<long long>(batch.size()));
+        MantisApp::instance().db().versions().bump(m_tableName);
+        m_stats.inserted += batch.size();
+        ++m_stats.batches;
+    }
+
+    void RecordImporter::insertRows(soci::session& sql, const std::vector<Row*>& rows,
+                                    const std::vector<std::string>& columns, const std::tm& now) const
+    {
+        auto all_columns = columns;
+        all_columns.emplace_back("created");
+        all_columns.emplace_back("updated");
+
+        const auto column_list = joinColumns(all_columns);
+        const auto per_statement = std::max<size_t>(1, MAX_BIND_PARAMS / all_columns.size());
+
+        for (size_t offset = 0; offset < rows.size(); offset += per_statement)
+        {
+            const auto count = std::min(per_statement, rows.size() - offset);
+
+            soci::values values;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const auto& entity = rows[offset + i]->entity;
+                const auto suffix = "_" + std::to_string(i);
+
+                values.set("id" + suffix, entity.at("id").get<std::string>());
+                values.set("created" + suffix, now);
+                values.set("updated" + suffix, now);
+
+                if (const auto status = m_table.bindEntityToSociValue(values, entity, suffix); status.has_value())
+                    throw std::invalid_argument(status->value("error", "Could not bind row values"));
+            }
+
+            const auto query = [&]
+            {
+                std::string rows_sql;
+                for (size_t i = 0; i < count; ++i)
+                {
+                    std::string placeholders;
+                    for (const auto& column : all_columns)
+                        placeholders += std::format("{}:{}_{}", placeholders.empty() ? "" : ", ", column, i);
+
+                    rows_sql += (rows_sql.empty() ? "(" : ", (") + placeholders + ")";
+                }
+
+                return "INSERT INTO " + m_tableName + " (" + column_list + ") VALUES " + rows_sql;
+            };
+
+            // Statements are reused for every full chunk of the same columns, the last, shorter
+            // chunk varies in size from batch to batch and would crowd out the cache
+            if (count < per_statement)
+            {
+                soci::statement st = (sql.prepare << query(), soci::use(values));
+                st.execute(true);
+                continue;
+            }
+
+            const auto st = MantisApp::instance().db().statements().prepare(
+                sql, m_tableName, std::format("import:{}|{}", column_list, count), query);
+
+            st->exchange(soci::use(values));
+            st->define_and_bind();
+            st->execute(true);
+        }
+    }
+
+#if MANTIS_HAS_POSTGRESQL
+    void RecordImporter::copyRows(soci::session& sql, const std::vector<Row*>& rows,
+                                  const std::vector<std::string>& columns, const std::tm& now) const
+    {
+        // COPY is not exposed by soci, talk to libpq on the session's connection
+        const auto backend = static_cast<soci::postgresql_session_backend*>(sql.get_backend());
+        PGconn* conn = backend->conn_;
+
+        std::vector<std::string> types;
+        for (const auto& column : columns)
+            types.push_back(m_table.findFieldByKey(column).value_or(json::object()).value("type", ""));
+
+        const auto query = std::format("COPY {} ({}, created, updated) FROM STDIN", m_tableName, joinColumns(columns));
+        PGresult* result = PQexec(conn, query.c_str());
+        const auto status = PQresultStatus(result);
+        PQclear(result);
+
+        if (status != PGRES_COPY_IN)
+            throw soci::soci_error(PQerrorMessage(conn));
+
+        const auto timestamp = tmToStr(now);
+        std::string buffer;
+        bool sent = true;
+        for (const auto* row : rows)
+        {
+            for (size_t i = 0; i < columns.size(); ++i)
+            {
+                const auto& value = row->entity.at(columns[i]);
+                const auto& type = types[i];
+
+                if (value.is_null()) buffer += "\\N";
+                else if (columns[i] == "password") appendCopyText(buffer, hashPassword(value.get<std::string>()));
+                else if (value.is_boolean()) buffer += value.get<bool>() ? "t" : "f";
+                else if (value.is_string() && type != "json" && type != "files")
+                    appendCopyText(buffer, value.get<std::string>());
+                else appendCopyText(buffer, value.dump());
+
+                buffer.push_back('\t');
+            }
+
+            buffer += timestamp + "\t" + timestamp + "\n";
+
+            // Send in chunks, keeping memory flat
+            if (buffer.size() >= 1024 * 1024)
+            {
+                sent = PQputCopyData(conn, buffer.data(), static_cast<int>(buffer.size())) == 1;
+                buffer.clear();
+                if (!sent) break;
+            }
+        }
+
+        if (sent && !buffer.empty())
+            sent = PQputCopyData(conn, buffer.data(), static_cast<int>(buffer.size())) == 1;
+
+        PQputCopyEnd(conn, sent ? nullptr : "Import aborted");
+
+        // Collect the outcome, the connection has to be drained before it can be reused
+        std::string error;
+        while ((result = PQgetResult(conn)) != nullptr)
+        {
+            if (PQresultStatus(result) != PGRES_COMMAND_OK && error.empty())
+                error = PQresultErrorMessage(result);
+            PQclear(result);
+        }
+
+        if (!sent && error.empty()) error = PQerrorMessage(conn);
+        if (!error.empty()) throw soci::soci_error(error);
+    }
+#endif
+}
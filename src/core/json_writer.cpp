@@ -0,0 +1,191 @@
+#include "../../include/mantis/core/json_writer.h"
+
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+
+#define __file__ "core/json_writer.cpp"
+
+namespace mantis
+{
+    JsonWriter::JsonWriter(std::string& out)
+        : m_out(out)
+    {
+    }
+
+    void JsonWriter::beginObject()
+    {
+        separate();
+        m_out.push_back('{');
+        m_hasElements.push_back(false);
+    }
+
+    void JsonWriter::endObject()
+    {
+        m_out.push_back('}');
+        m_hasElements.pop_back();
+    }
+
+    void JsonWriter::beginArray()
+    {
+        separate();
+        m_out.push_back('[');
+        m_hasElements.push_back(false);
+    }
+
+    void JsonWriter::endArray()
+    {
+        m_out.push_back(']');
+        m_hasElements.pop_back();
+    }
+
+    void JsonWriter::key(const std::string_view k)
+    {
+        separate();
+        escape(m_out, k);
+        m_out.push_back(':');
+        m_afterKey = true;
+    }
+
+    void JsonWriter::value(const std::string_view v)
+    {
+        separate();
+        escape(m_out, v);
+    }
+
+    void JsonWriter::value(const char* v)
+    {
+        if (v == nullptr) null();
+        else value(std::string_view(v));
+    }
+
+    void JsonWriter::value(const bool v)
+    {
+        separate();
+        m_out.append(v ? "true" : "false");
+    }
+
+    void JsonWriter::value(const int64_t v)
+    {
+        separate();
+        char buf[24];
+        const auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+        m_out.append(buf, end);
+    }
+
+    void JsonWriter::value(const uint64_t v)
+    {
+        separate();
+        char buf[24];
+        const auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+        m_out.append(buf, end);
+    }
+
+    void JsonWriter::value(const double v)
+    {
+        separate();
+
+        // Same as nlohmann::json, NaN & infinity are not representable
+        if (!std::isfinite(v))
+        {
+            m_out.append("null");
+            return;
+        }
+
+        // Shortest representation that round trips
+        char buf[32];
+        const auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), v);
+        const std::string_view num(buf, end - buf);
+        m_out.append(num);
+
+        // Keep it a floating point number when read back, i.e. `2.0` and not `2`
+        if (num.find_first_of(".e") == std::string_view::npos)
+            m_out.append(".0");
+    }
+
+    void JsonWriter::value(const json& v)
+    {
+        separate();
+        m_out.append(v.dump());
+    }
+
+    void JsonWriter::null()
+    {
+        separate();
+        m_out.append("null");
+    }
+
+    void JsonWriter::raw(const std::string_view serialized)
+    {
+        separate();
+        m_out.append(serialized);
+    }
+
+    void JsonWriter::jsonText(const std::string_view serialized)
+    {
+        // The parser rejects invalid UTF-8, dumping sorts the keys of nested objects
+        const auto parsed = json::parse(serialized, nullptr, false);
+        if (parsed.is_discarded())
+            throw std::invalid_argument("Invalid JSON value");
+
+        value(parsed);
+    }
+
+    void JsonWriter::escape(std::string& out, const std::string_view v)
+    {
+        static constexpr char hex[] = "0123456789abcdef";
+
+        out.push_back('"');
+        size_t start = 0;
+        for (size_t i = 0; i < v.size(); ++i)
+        {
+            const auto c = static_cast<unsigned char>(v[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+            // Flush the run of plain characters before the one to escape
+            out.append(v.data() + start, i - start);
+            start = i + 1;
+
+            switch (c)
+            {
+            case '"': out.append("\\\"");
+                break;
+            case '\\': out.append("\\\\");
+                break;
+            case '\b': out.append("\\b");
+                break;
+            case '\f': out.append("\\f");
+                break;
+            case '\n': out.append("\\n");
+                break;
+            case '\r': out.append("\\r");
+                break;
+            case '\t': out.append("\\t");
+                break;
+            default:
+                out.append("\\u00");
+                out.push_back(hex[c >> 4]);
+                out.push_back(hex[c & 0x0f]);
+                break;
+            }
+        }
+
+        out.append(v.data() + start, v.size() - start);
+        out.push_back('"');
+    }
+
+    void JsonWriter::separate()
+    {
+        // Values following a key are already separated by the `:`
+        if (m_afterKey)
+        {
+            m_afterKey = false;
+            return;
+        }
+
+        if (m_hasElements.empty()) return;
+
+        if (m_hasElements.back()) m_out.push_back(',');
+        else m_hasElements.back() = true;
+    }
+}
@@ -60,24 +60,41 @@ namespace mantis
 
         try
         {
+            const auto secretKey = MantisApp::jwtSecretKey();
+            const auto& config = MantisApp::instance().settings().configs();
+            const bool check_issuer = !config.value("jwtEnableSetIssuer", false);
+            const bool check_audience = !config.value("jwtEnableSetAudience", false);
+            const auto issuer = check_issuer ? config.at("appName").get<std::string>() : "";
+            const auto audience = check_audience ? config.at("baseUrl").get<std::string>() : "";
+
+            // Tokens verified before under the same secret, issuer & audience
+            std::string context = secretKey;
+            context.push_back('\0');
+            context += check_issuer ? "iss:" + issuer : "";
+            context.push_back('\0');
+            context += check_audience ? "aud:" + audience : "";
+
+            if (auto cached = tokenCache().get(token, context); cached.has_value())
+            {
+                return cached.value();
+            }
+
             // Decode the token
             const auto decoded = jwt::decode(token);
 
-            const auto secretKey = MantisApp::jwtSecretKey();
             // Create verifier with your validation rules
             auto verifier = jwt::verify()
                 .allow_algorithm(jwt::algorithm::hs256{secretKey});
 
-            const auto& config = MantisApp::instance().settings().configs();
             // Add JWT Issuer if enabled
-            if (!config.value("jwtEnableSetIssuer", false))
+            if (check_issuer)
             {
-                verifier.with_issuer(config.at("appName").get<std::string>());
+                verifier.with_issuer(issuer);
             }
             // Add JWT audience if enabled
-            if (!config.value("jwtEnableSetAudience", false))
+            if (check_audience)
             {
-                verifier.with_audience(config.at("baseUrl").get<std::string>());
+                verifier.with_audience(audience);
             }
 
             // Verify with error_code to capture errors
@@ -107,6 +124,7 @@ namespace mantis
             }
 
             result["verified"] = true;
+            tokenCache().put(token, context, result);
             return result;
         }
         catch (const std::exception& e)
@@ -117,4 +135,10 @@ namespace mantis
             return result;
         }
     }
+
+    TokenCache& JwtUnit::tokenCache()
+    {
+        static TokenCache cache;
+        return cache;
+    }
 };
@@ -1,5 +1,7 @@
 #include "../../../include/mantis/mantis.h"
+#include "../../../include/mantis/core/query_filter.h"
 #include "soci/sqlite3/soci-sqlite3.h"
+#include <regex>
 
 mantis::Validator::Validator()
 {
@@ -121,6 +123,11 @@ bool mantis::isValidFieldType(const std::string& fieldType)
     return it != fieldTypes.end();
 }
 
+bool mantis::isValidIdStrategy(const std::string& strategy)
+{
+    return std::ranges::find(idStrategies, strategy) != idStrategies.end();
+}
+
 mantis::Field::Field(std::string n, const FieldType t, const bool req, const bool pk, const bool sys, json opts)
     : name(std::move(n)), type(t), required(req), primaryKey(pk), system(sys)
 {
@@ -144,6 +151,11 @@ mantis::Field::Field(std::string n, const FieldType t, const bool req, const boo
                 isUnique = opts["unique"];
         }
 
+        if (opts.contains("indexed"))
+        {
+            isIndexed = !opts["indexed"].is_null() && opts["indexed"].get<bool>();
+        }
+
         if (opts.contains("defaultValue"))
         {
             // Log::trace("Default Value ...? {}", opts["defaultValue"].is_null());
@@ -191,6 +203,7 @@ json mantis::Field::to_json() const
         {"primaryKey", primaryKey},
         {"system", system},
         {"unique", isUnique},
+        {"indexed", isIndexed},
         {"validator", validator},
         {"defaultValue", defaultValue},
         {"minValue", minValue},
@@ -235,9 +248,14 @@ json mantis::Table::to_json() const
     j["system"] = system;
     j["fields"] = json::array();
     j["has_api"] = has_api;
+    j["idStrategy"] = idStrategy;
+    j["sync"] = sync;
 
     for (const auto& f : fields) j["fields"].push_back(f.to_json());
 
+    j["indexes"] = json::array();
+    for (const auto& index : indexes) j["indexes"].push_back(index.to_json());
+
     j["listRule"] = listRule;
     j["getRule"] = getRule;
     j["addRule"] = addRule;
@@ -301,6 +319,198 @@ std::string mantis::Table::to_sql() const
     return ddl.str();
 }
 
+std::vector<std::string> mantis::Table::to_index_sql() const
+{
+    // Views have no indexes of their own
+    if (type == TableType::View) return {};
+
+    const auto has_field = [&](const std::string& field_name)
+    {
+        return std::any_of(fields.begin(), fields.end(), [&](const Field& f) { return f.name == field_name; });
+    };
+
+    std::vector<std::string> ddls;
+
+    // List records are paginated by `(created, id)`
+    if (has_field("created") && has_field("id"))
+        ddls.push_back(keysetIndexSql(name));
+
+    for (const auto& index : schemaIndexes(to_json()))
+        ddls.push_back(index.to_sql(name));
+
+    return ddls;
+}
+
+std::vector<mantis::Index> mantis::Table::schemaIndexes(const json& schema)
+{
+    if (schema.value("type", "") == "view") return {};
+
+    const auto table = schema.value("name", "");
+    std::vector<std::string> field_names;
+    std::vector<Index> result;
+
+    const auto fields = schema.value("fields", std::vector<json>{});
+    for (const auto& field : fields)
+    {
+        const auto field_name = field.value("name", "");
+        field_names.push_back(field_name);
+
+        if (!field.contains("indexed") || field["indexed"].is_null() || !field["indexed"].get<bool>())
+            continue;
+
+        Index index;
+        index.columns = {field_name};
+        index.name = Index::defaultName(table, index.columns);
+        result.push_back(index);
+    }
+
+    for (const auto& index_json : schema.value("indexes", json::array()))
+    {
+        auto index = Index::from_json(index_json, table);
+
+        // Partial index conditions use the filter syntax, validated against the fields & inlined
+        if (index.where.has_value())
+        {
+            try
+            {
+                const auto compiled = QueryFilter(fields).compileLiteral(index.where.value());
+                index.condition = compiled.where;
+                index.conditionColumns = compiled.columns;
+            }
+            catch (const std::invalid_argument& e)
+            {
+                throw std::invalid_argument("Index '" + index.name + "' condition: " + e.what());
+            }
+        }
+
+        result.push_back(index);
+    }
+
+    for (const auto& index : result)
+    {
+        // Index names share one namespace per database, they must at least be unique here
+        if (std::ranges::count_if(result, [&](const Index& i) { return i.name == index.name; }) > 1)
+            throw std::invalid_argument("Duplicate index name '" + index.name + "'");
+
+        for (const auto& column : index.columns)
+        {
+            const auto column_name = column.starts_with("-") ? column.substr(1) : column;
+            if (std::ranges::find(field_names, column_name) == field_names.end())
+                throw std::invalid_argument("Index '" + index.name + "' column '" + column_name + "' is not a field");
+        }
+    }
+
+    return result;
+}
+
+json mantis::Index::to_json() const
+{
+    return {
+        {"name", name},
+        {"columns", columns},
+        {"unique", unique},
+        {"where", where.has_value() ? json(where.value()) : json(nullptr)}
+    };
+}
+
+mantis::Index mantis::Index::from_json(const json& j, const std::string& table)
+{
+    const auto is_identifier = [](const std::string& s)
+    {
+        static const std::regex re(R"(^[A-Za-z_][A-Za-z0-9_]*$)");
+        return std::regex_match(s, re);
+    };
+
+    if (!j.is_object())
+        throw std::invalid_argument("Index definition must be an object");
+
+    Index index;
+    index.unique = j.value("unique", false);
+
+    const auto columns = j.value("columns", json::array());
+    if (!columns.is_array() || columns.empty())
+        throw std::invalid_argument("Index 'columns' must be a non empty array");
+
+    for (const auto& column : columns)
+    {
+        const auto column_name = column.is_string() ? trim(column.get<std::string>()) : "";
+        const auto bare_name = column_name.starts_with("-") ? column_name.substr(1) : column_name;
+        if (!is_identifier(bare_name))
+            throw std::invalid_argument("Invalid index column '" + column_name + "'");
+
+        index.columns.push_back(column_name);
+    }
+
+    index.name = trim(j.value("name", ""));
+    if (index.name.empty()) index.name = defaultName(table, index.columns);
+    if (!is_identifier(index.name))
+        throw std::invalid_argument("Invalid index name '" + index.name + "'");
+
+    // Names starting with `__` are kept for the indexes Mantis creates itself, e.g. @see Table::keysetIndexName()
+    if (index.name.starts_with("__"))
+        throw std::invalid_argument("Index name '" + index.name + "' is reserved, names can't start with '__'");
+
+    // Compiled against the table fields by Table::schemaIndexes()
+    if (j.contains("where") && j["where"].is_string() && !trim(j["where"].get<std::string>()).empty())
+        index.where = trim(j["where"].get<std::string>());
+
+    return index;
+}
+
+std::string mantis::Index::to_sql(const std::string& table) const
+{
+    std::string sql = unique ? "CREATE UNIQUE INDEX IF NOT EXISTS " : "CREATE INDEX IF NOT EXISTS ";
+    sql += name + " ON " + table + " (";
+
+    for (size_t i = 0; i < columns.size(); ++i)
+    {
+        if (i > 0) sql += ", ";
+        if (columns[i].starts_with("-")) sql += columns[i].substr(1) + " DESC";
+        else sql += columns[i];
+    }
+    sql += ")";
+
+    if (where.has_value())
+    {
+        if (condition.empty())
+            throw std::logic_error("Condition of index '" + name + "' wasn't compiled");
+
+        sql += " WHERE " + condition;
+    }
+
+    return sql;
+}
+
+bool mantis::Index::references(const std::string& column) const
+{
+    return std::ranges::any_of(columns, [&](const std::string& c) { return c == column || c == "-" + column; })
+        || std::ranges::find(conditionColumns, column) != conditionColumns.end();
+}
+
+std::string mantis::Index::defaultName(const std::string& table, const std::vector<std::string>& columns)
+{
+    std::string name = "idx_" + table;
+    for (const auto& column : columns)
+        name += "_" + (column.starts_with("-") ? column.substr(1) : column);
+
+    return name;
+}
+
+std::string mantis::Table::keysetIndexSql(const std::string& table)
+{
+    return "CREATE INDEX IF NOT EXISTS " + keysetIndexName(table) + " ON " + table + " (created, id)";
+}
+
+std::string mantis::Table::keysetIndexName(const std::string& table)
+{
+    return "__keyset_" + table;
+}
+
+std::string mantis::Table::legacyKeysetIndexName(const std::string& table)
+{
+    return "idx_" + table + "_created_id";
+}
+
 mantis::BaseTable::BaseTable()
 {
     type = TableType::Base;
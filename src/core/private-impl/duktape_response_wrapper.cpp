@@ -129,6 +129,13 @@ namespace mantis
         m_res.set_file_content(path);
     }
 
+    void MantisResponse::setChunkedContentProvider(const std::string& content_type,
+                                                   httplib::ContentProviderWithoutLength provider,
+                                                   httplib::ContentProviderResourceReleaser releaser) const
+    {
+        m_res.set_chunked_content_provider(content_type, std::move(provider), std::move(releaser));
+    }
+
     void MantisResponse::send(int statusCode = 200, const std::string& data, const std::string& content_type) const
     {
         m_res.set_content(data, content_type);
@@ -165,6 +172,12 @@ namespace mantis
         duk_error(ctx, DUK_ERR_TYPE_ERROR, "Could not parse data to JSON");
     }
 
+    void MantisResponse::sendRawJson(const int statusCode, std::string&& data) const
+    {
+        m_res.set_content(std::move(data), "application/json");
+        m_res.status = statusCode;
+    }
+
     void MantisResponse::sendHtml(const int statusCode, const std::string& data) const
     {
         send(statusCode, data, "application/json");
@@ -0,0 +1,451 @@
+#include "../../include/mantis/core/query_filter.h"
+#include "../../include/mantis/utils/utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <format>
+#include <optional>
+#include <stdexcept>
+
+#define __file__ "core/query_filter.cpp"
+
+namespace mantis
+{
+    namespace
+    {
+        enum class TokenType
+        {
+            Ident,
+            String,
+            Number,
+            Op,
+            And,
+            Or,
+            LParen,
+            RParen,
+            End
+        };
+
+        struct Token
+        {
+            TokenType type = TokenType::End;
+            std::string text;
+        };
+
+        bool isStringType(const std::string& type)
+        {
+            return type == "string" || type == "xml" || type == "file";
+        }
+
+        bool isIntegerType(const std::string& type)
+        {
+            return type == "int8" || type == "uint8" || type == "int16" || type == "uint16" ||
+                type == "int32" || type == "uint32" || type == "int64" || type == "uint64";
+        }
+
+        /// `text` as a number, if it's one as a whole & in range of `T`
+        template <typename T>
+        std::optional<T> parseNumber(const std::string& text)
+        {
+            T value{};
+            const auto end = text.data() + text.size();
+            if (const auto [ptr, ec] = std::from_chars(text.data(), end, value); ec != std::errc() || ptr != end)
+                return std::nullopt;
+            return value;
+        }
+    }
+
+    /**
+     * Recursive descent parser for the filter expression, emitting SQL as it goes.
+     *
+     *  expr       := and_expr ( '||' and_expr )*
+     *  and_expr   := term ( '&&' term )*
+     *  term       := '(' expr ')' | comparison
+     *  comparison := IDENT OP value
+     */
+    class QueryFilter::Parser
+    {
+    public:
+        Parser(const QueryFilter& filter, const std::string& input, CompiledQuery& out, const bool literal)
+            : m_filter(filter), m_input(input), m_out(out), m_literal(literal)
+        {
+            advance();
+        }
+
+        void parse()
+        {
+            m_out.where = expr();
+            if (m_token.type != TokenType::End)
+                fail(std::format("Unexpected `{}`", m_token.text));
+        }
+
+    private:
+        std::string expr()
+        {
+            std::string sql = andExpr();
+            while (m_token.type == TokenType::Or)
+            {
+                advance();
+                sql += " OR " + andExpr();
+            }
+            return sql;
+        }
+
+        std::string andExpr()
+        {
+            std::string sql = term();
+            while (m_token.type == TokenType::And)
+            {
+                advance();
+                sql += " AND " + term();
+            }
+            return sql;
+        }
+
+        std::string term()
+        {
+            if (m_token.type == TokenType::LParen)
+            {
+                if (++m_depth > MAX_DEPTH)
+                    fail("Filter is nested too deeply");
+
+                advance();
+                auto sql = "(" + expr() + ")";
+                if (m_token.type != TokenType::RParen)
+                    fail("Expected `)`");
+
+                advance();
+                --m_depth;
+                return sql;
+            }
+
+            return comparison();
+        }
+
+        std::string comparison()
+        {
+            if (m_token.type != TokenType::Ident)
+                fail("Expected a field name");
+
+            const auto column = m_token.text;
+            const auto it = m_filter.m_columns.find(column);
+            if (it == m_filter.m_columns.end())
+                fail(std::format("Field `{}` can't be filtered on", column));
+            const auto& type = it->second;
+            if (std::ranges::find(m_out.columns, column) == m_out.columns.end())
+                m_out.columns.push_back(column);
+
+            advance();
+            if (m_token.type != TokenType::Op)
+                fail(std::format("Expected an operator after `{}`", column));
+            const auto op = m_token.text;
+
+            advance();
+            const auto value = m_token;
+            advance();
+
+            if (++m_conditions > MAX_CONDITIONS)
+                fail(std::format("Filter has more than {} conditions", MAX_CONDITIONS));
+
+            // NULL checks
+            if (value.type == TokenType::Ident && value.text == "null")
+            {
+                if (op == "=") return column + " IS NULL";
+                if (op == "!=") return column + " IS NOT NULL";
+                fail("`null` can only be compared with `=` or `!=`");
+            }
+
+            // Contains / not contains
+            if (op == "~" || op == "!~")
+            {
+                if (!isStringType(type) || value.type != TokenType::String)
+                    fail(std::format("`{}` expects a text field & value", op));
+
+                // Match the value as is anywhere in the text, `%` & `_` in it aren't wildcards
+                std::string pattern = "%";
+                for (const char ch : value.text)
+                {
+                    if (ch == '%' || ch == '_' || ch == '\\') pattern.push_back('\\');
+                    pattern.push_back(ch);
+                }
+                pattern.push_back('%');
+
+                return column + (op == "~" ? " LIKE " : " NOT LIKE ") + bind(pattern, quoted(pattern)) + " ESCAPE '\\'";
+            }
+
+            const auto sql_op = op == "!=" ? std::string("<>") : op;
+            std::string operand;
+
+            if (isStringType(type))
+            {
+                if (value.type != TokenType::String)
+                    fail(std::format("Field `{}` expects a quoted text value", column));
+
+                operand = bind(value.text, quoted(value.text));
+            }
+            else if (type == "date")
+            {
+                if (value.type != TokenType::String)
+                    fail(std::format("Field `{}` expects a quoted date value", column));
+
+                std::tm date{};
+                try
+                {
+                    date = strToTM(value.text);
+                }
+                catch (const std::exception&)
+                {
+                    fail(std::format("Invalid date value `{}`", value.text));
+                }
+                operand = bind(date, quoted(tmToStr(date)));
+            }
+            else if (isIntegerType(type))
+            {
+                if (value.type != TokenType::Number || value.text.find_first_of(".eE") != std::string::npos)
+                    fail(std::format("Field `{}` expects an integer value", column));
+
+                const auto number = parseNumber<long long>(value.text);
+                if (!number.has_value())
+                    fail(std::format("Invalid integer value `{}`", value.text));
+
+                operand = bind(number.value(), std::to_string(number.value()));
+            }
+            else if (type == "double")
+            {
+                if (value.type != TokenType::Number)
+                    fail(std::format("Field `{}` expects a numeric value", column));
+
+                const auto number = parseNumber<double>(value.text);
+                if (!number.has_value())
+                    fail(std::format("Invalid numeric value `{}`", value.text));
+
+                operand = bind(number.value(), std::format("{}", number.value()));
+            }
+            else if (type == "bool")
+            {
+                if (value.type != TokenType::Ident || (value.text != "true" && value.text != "false"))
+                    fail(std::format("Field `{}` expects `true` or `false`", column));
+                if (op != "=" && op != "!=")
+                    fail("Boolean fields can only be compared with `=` or `!=`");
+
+                operand = bind(value.text == "true" ? 1LL : 0LL, value.text == "true" ? "TRUE" : "FALSE");
+            }
+            else
+            {
+                fail(std::format("Field `{}` can't be filtered on", column));
+            }
+
+            return column + " " + sql_op + " " + operand;
+        }
+
+        /// Placeholder of `value`, added to the parameters; or `literal` when inlining values.
+        std::string bind(decltype(QueryParam::value) value, const std::string& literal)
+        {
+            if (m_literal) return literal;
+
+            const auto param = std::format("f{:02}", m_out.params.size());
+            m_out.params.push_back({param, std::move(value)});
+            return ":" + param;
+        }
+
+        /// `value` as an SQL string literal
+        static std::string quoted(const std::string& value)
+        {
+            std::string out = "'";
+            for (const char ch : value)
+            {
+                if (ch == '\'') out.push_back('\'');
+                out.push_back(ch);
+            }
+            return out + "'";
+        }
+
+        void advance()
+        {
+            // Skip whitespaces
+            while (m_pos < m_input.size() && std::isspace(static_cast<unsigned char>(m_input[m_pos])))
+                ++m_pos;
+
+            if (m_pos >= m_input.size())
+            {
+                m_token = {TokenType::End, "end of filter"};
+                return;
+            }
+
+            const char c = m_input[m_pos];
+            const auto next = m_pos + 1 < m_input.size() ? m_input[m_pos + 1] : '\0';
+
+            if (c == '(' || c == ')')
+            {
+                m_token = {c == '(' ? TokenType::LParen : TokenType::RParen, std::string(1, c)};
+                ++m_pos;
+            }
+            else if ((c == '&' && next == '&') || (c == '|' && next == '|'))
+            {
+                m_token = {c == '&' ? TokenType::And : TokenType::Or, m_input.substr(m_pos, 2)};
+                m_pos += 2;
+            }
+            else if ((c == '!' || c == '>' || c == '<') && next == '=')
+            {
+                m_token = {TokenType::Op, m_input.substr(m_pos, 2)};
+                m_pos += 2;
+            }
+            else if (c == '!' && next == '~')
+            {
+                m_token = {TokenType::Op, "!~"};
+                m_pos += 2;
+            }
+            else if (c == '=' || c == '>' || c == '<' || c == '~')
+            {
+                m_token = {TokenType::Op, std::string(1, c)};
+                ++m_pos;
+            }
+            else if (c == '\'' || c == '"')
+            {
+                m_token = {TokenType::String, readString(c)};
+            }
+            else if (std::isdigit(static_cast<unsigned char>(c)) || (c == '-' && std::isdigit(static_cast<unsigned char>(next))))
+            {
+                const auto start = m_pos++;
+                while (m_pos < m_input.size() &&
+                    (std::isdigit(static_cast<unsigned char>(m_input[m_pos])) || m_input[m_pos] == '.' ||
+                        m_input[m_pos] == 'e' || m_input[m_pos] == 'E' ||
+                        ((m_input[m_pos] == '-' || m_input[m_pos] == '+') &&
+                            (m_input[m_pos - 1] == 'e' || m_input[m_pos - 1] == 'E'))))
+                    ++m_pos;
+                m_token = {TokenType::Number, m_input.substr(start, m_pos - start)};
+            }
+            else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_')
+            {
+                const auto start = m_pos++;
+                while (m_pos < m_input.size() &&
+                    (std::isalnum(static_cast<unsigned char>(m_input[m_pos])) || m_input[m_pos] == '_'))
+                    ++m_pos;
+                m_token = {TokenType::Ident, m_input.substr(start, m_pos - start)};
+            }
+            else
+            {
+                fail(std::format("Unexpected character `{}` at position {}", c, m_pos));
+            }
+        }
+
+        std::string readString(const char quote)
+        {
+            std::string value;
+            ++m_pos; // Opening quote
+            while (m_pos < m_input.size() && m_input[m_pos] != quote)
+            {
+                // Escaped quotes & backslashes
+                if (m_input[m_pos] == '\\' && m_pos + 1 < m_input.size())
+                    ++m_pos;
+
+                value.push_back(m_input[m_pos++]);
+            }
+
+            if (m_pos >= m_input.size())
+                fail("Unterminated string value");
+
+            ++m_pos; // Closing quote
+            return value;
+        }
+
+        [[noreturn]] static void fail(const std::string& msg)
+        {
+            throw std::invalid_argument("Invalid filter: " + msg);
+        }
+
+        const QueryFilter& m_filter;
+        const std::string& m_input;
+        CompiledQuery& m_out;
+        bool m_literal; ///> Values inlined as SQL literals, rather than bound
+
+        size_t m_pos = 0;
+        size_t m_depth = 0;
+        size_t m_conditions = 0;
+        Token m_token;
+    };
+
+    QueryFilter::QueryFilter(const std::vector<nlohmann::json>& fields)
+    {
+        for (const auto& field : fields)
+        {
+            const auto name = field.value("name", "");
+            const auto type = field.value("type", "");
+
+            // Never allow probing password hashes
+            if (name.empty() || name == "password" || !isFilterableType(type)) continue;
+
+            m_columns[name] = type;
+        }
+    }
+
+    CompiledQuery QueryFilter::compile(const std::string& filter, const std::string& sort) const
+    {
+        CompiledQuery out;
+
+        if (!trim(filter).empty())
+        {
+            Parser parser(*this, filter, out, false);
+            parser.parse();
+        }
+
+        out.orderBy = compileSort(sort);
+        return out;
+    }
+
+    CompiledQuery QueryFilter::compileLiteral(const std::string& filter) const
+    {
+        CompiledQuery out;
+        Parser parser(*this, filter, out, true);
+        parser.parse();
+        return out;
+    }
+
+    void QueryFilter::bind(soci::values& vals, const std::vector<QueryParam>& params)
+    {
+        for (const auto& [name, value] : params)
+        {
+            std::visit([&](const auto& v) { vals.set(name, v); }, value);
+        }
+    }
+
+    bool QueryFilter::isFilterableType(const std::string& type)
+    {
+        return isStringType(type) || isIntegerType(type) || type == "double" || type == "date" || type == "bool";
+    }
+
+    std::string QueryFilter::compileSort(const std::string& sort) const
+    {
+        if (trim(sort).empty()) return "";
+
+        std::string order;
+        const auto parts = splitString(sort, ",");
+        if (parts.size() > MAX_SORT_FIELDS)
+            throw std::invalid_argument(std::format("Invalid sort: more than {} fields", MAX_SORT_FIELDS));
+
+        bool has_id = false;
+        for (const auto& part : parts)
+        {
+            auto column = trim(part);
+            bool desc = false;
+            if (!column.empty() && (column[0] == '-' || column[0] == '+'))
+            {
+                desc = column[0] == '-';
+                column = trim(column.substr(1));
+            }
+
+            if (!m_columns.contains(column))
+                throw std::invalid_argument(std::format("Invalid sort: field `{}` can't be sorted on", column));
+
+            if (!order.empty()) order += ", ";
+            order += column + (desc ? " DESC" : " ASC");
+            has_id = has_id || column == "id";
+        }
+
+        // Break ties on the primary key, pages must not overlap
+        if (!has_id) order += ", id DESC";
+
+        return order;
+    }
+}
@@ -0,0 +1,363 @@
+#include "../../include/mantis/core/realtime.h"
+#include "../../include/mantis/core/database.h"
+#include "../../include/mantis/core/logging.h"
+#include "../../include/mantis/app/app.h"
+#include "../../include/mantis/utils/utils.h"
+
+#include <algorithm>
+#include <format>
+
+#define __file__ "core/realtime.cpp"
+
+namespace mantis
+{
+    namespace
+    {
+        constexpr auto RESET_FRAME = "event: reset\ndata: {}\n\n";
+        constexpr auto HEARTBEAT_FRAME = ": ping\n\n";
+        // Sent first, gets the stream going and has clients wait a bit before reconnecting
+        constexpr auto RETRY_FRAME = "retry: 3000\n\n";
+
+        int64_t nowSeconds()
+        {
+            return std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    RealtimeHub::RealtimeHub(TableLookup lookup, const size_t maxSubscribers)
+        : m_lookup(std::move(lookup)),
+          m_maxSubscribers(maxSubscribers)
+    {
+    }
+
+    RealtimeHub::~RealtimeHub()
+    {
+        stop();
+    }
+
+    void RealtimeHub::start()
+    {
+        std::unique_lock lock(m_mutex);
+        if (m_running) return;
+
+        m_stop = false;
+        m_running = true;
+        m_thread = std::thread(&RealtimeHub::run, this);
+    }
+
+    void RealtimeHub::stop()
+    {
+        m_stop = true;
+        if (m_thread.joinable()) m_thread.join();
+
+        // End all streams, their connections are waiting on them
+        std::unique_lock lock(m_mutex);
+        for (const auto& [table, subscribers] : m_byTable)
+        {
+            for (const auto& subscriber : subscribers)
+            {
+                std::lock_guard sub_lock(subscriber->mutex);
+                subscriber->closed = true;
+                subscriber->cv.notify_all();
+            }
+        }
+
+        m_byTable.clear();
+        m_subscribers = 0;
+        m_running = false;
+    }
+
+    std::shared_ptr<RealtimeHub::Subscriber> RealtimeHub::subscribe(std::vector<RealtimeTopic> topics, json auth,
+                                                                    TokenMap reqVars, const int64_t expires)
+    {
+        auto subscriber = std::make_shared<Subscriber>();
+        subscriber->topics = std::move(topics);
+        if (auth.contains("id") && auth["id"].is_string() && auth.contains("table") && auth["table"].is_string())
+        {
+            subscriber->userTable = auth["table"].get<std::string>();
+            subscriber->userId = auth["id"].get<std::string>();
+        }
+        subscriber->auth = std::move(auth);
+        subscriber->reqVars = std::move(reqVars);
+        subscriber->expires = expires;
+        subscriber->pending = RETRY_FRAME;
+
+        std::unique_lock lock(m_mutex);
+        if (!m_running || m_subscribers >= m_maxSubscribers) return nullptr;
+
+        std::vector<std::string> tables;
+        for (const auto& topic : subscriber->topics)
+        {
+            if (std::ranges::find(tables, topic.table) != tables.end()) continue;
+
+            tables.push_back(topic.table);
+            m_byTable[topic.table].push_back(subscriber);
+        }
+
+        ++m_subscribers;
+        return subscriber;
+    }
+
+    void RealtimeHub::unsubscribe(const std::shared_ptr<Subscriber>& subscriber)
+    {
+        std::unique_lock lock(m_mutex);
+
+        bool found = false;
+        for (auto it = m_byTable.begin(); it != m_byTable.end();)
+        {
+            auto& subscribers = it->second;
+            if (const auto pos = std::ranges::find(subscribers, subscriber); pos != subscribers.end())
+            {
+                subscribers.erase(pos);
+                found = true;
+            }
+
+            if (subscribers.empty()) it = m_byTable.erase(it);
+            else ++it;
+        }
+
+        if (found) --m_subscribers;
+    }
+
+    void RealtimeHub::invalidateUser(const std::string& table, const std::string& id)
+    {
+        std::shared_lock lock(m_mutex);
+        for (const auto& [t, subscribers] : m_byTable)
+        {
+            for (const auto& subscriber : subscribers)
+            {
+                if (subscriber->userTable.empty()) continue;
+                if (table.empty() || (subscriber->userTable == table && (id.empty() || subscriber->userId == id)))
+                    subscriber->reauth = true;
+            }
+        }
+    }
+
+    bool RealtimeHub::next(Subscriber& subscriber, std::string& out) const
+    {
+        std::unique_lock lock(subscriber.mutex);
+
+        // Woken up in time for the token expiry, ending idle streams too
+        auto wait = std::chrono::duration_cast<std::chrono::seconds>(HEARTBEAT);
+        if (subscriber.expires > 0)
+            wait = std::min(wait, std::chrono::seconds(std::max<int64_t>(0, subscriber.expires - nowSeconds())));
+
+        subscriber.cv.wait_for(lock, wait, [&]
+        {
+            return subscriber.closed || !subscriber.pending.empty();
+        });
+
+        if (subscriber.expires > 0 && nowSeconds() >= subscriber.expires) subscriber.closed = true;
+        if (subscriber.closed) return false;
+
+        out.clear();
+        if (subscriber.pending.empty()) out = HEARTBEAT_FRAME;
+        else out.swap(subscriber.pending);
+        return true;
+    }
+
+    std::vector<RealtimeTopic> RealtimeHub::parseTopics(const std::string_view value, std::string& error)
+    {
+        std::vector<RealtimeTopic> topics;
+        for (const auto& part : splitString(std::string(value), ","))
+        {
+            const auto topic = trim(part);
+            if (topic.empty()) continue;
+
+            const auto slash = topic.find('/');
+            RealtimeTopic t;
+            t.table = topic.substr(0, slash);
+            if (slash != std::string::npos) t.id = topic.substr(slash + 1);
+
+            const bool bad_id = slash != std::string::npos && (t.id.empty() || t.id.find('/') != std::string::npos);
+            if (t.table.empty() || bad_id)
+            {
+                error = std::format("Invalid topic `{}`, expected `table` or `table/id`", topic);
+                return {};
+            }
+
+            topics.push_back(std::move(t));
+        }
+
+        if (topics.empty())
+            error = "Expected at least one `table` or `table/id` topic to subscribe to";
+        else if (topics.size() > MAX_TOPICS)
+            error = std::format("A subscription can't have more than {} topics", MAX_TOPICS);
+
+        if (!error.empty()) return {};
+        return topics;
+    }
+
+    std::string RealtimeHub::formatEvent(const ChangeEvent& event)
+    {
+        return std::format("id: {}\nevent: {}\ndata: {}\n\n", event.seq, changeOpName(event.op),
+                           event.toJson().dump());
+    }
+
+    json RealtimeHub::stats() const
+    {
+        std::shared_lock lock(m_mutex);
+        return {
+            {"subscribers", m_subscribers},
+            {"maxSubscribers", m_maxSubscribers},
+            {"events", m_events.load()},
+            {"delivered", m_delivered.load()},
+            {"resets", m_resets.load()}
+        };
+    }
+
+    void RealtimeHub::run()
+    {
+        auto& ring = MantisApp::instance().db().changes().ring();
+
+        // Only changes from now on, subscribers fetch the current state themselves
+        auto cursor = ring.head();
+        std::vector<ChangeEvent> events;
+
+        while (!m_stop)
+        {
+            if (!ring.wait(cursor, std::chrono::milliseconds(250))) continue;
+
+            if (const auto lost = ring.poll(cursor, events); lost > 0)
+            {
+                Log::warn("Realtime fell {} change events behind, resetting subscribers", lost);
+
+                std::shared_lock lock(m_mutex);
+                for (const auto& [table, subscribers] : m_byTable)
+                {
+                    for (const auto& subscriber : subscribers)
+                        push(*subscriber, RESET_FRAME);
+                }
+            }
+
+            for (const auto& event : events)
+            {
+                ++m_events;
+                dispatch(event);
+            }
+        }
+    }
+
+    void RealtimeHub::dispatch(const ChangeEvent& event)
+    {
+        // Copied out, re-authorizing a subscriber reads the database, (un)subscribing mustn't wait on it
+        std::vector<std::shared_ptr<Subscriber>> subscribers;
+        {
+            std::shared_lock lock(m_mutex);
+            const auto it = m_byTable.find(event.table);
+            if (it == m_byTable.end()) return;
+            subscribers = it->second;
+        }
+
+        const auto table = m_lookup(event.table);
+        if (!table) return;
+
+        // Serialized once, for the first subscriber allowed to see it
+        std::string frame;
+        for (const auto& subscriber : subscribers)
+        {
+            if (!authorized(*subscriber)) continue;
+
+            bool all = false, record = false;
+            for (const auto& topic : subscriber->topics)
+            {
+                if (topic.table != event.table) continue;
+                if (topic.id.empty()) all = true;
+                else if (!event.id.empty() && topic.id == event.id) record = true;
+            }
+
+            if (!(all && canRead(*subscriber, *table, false)) && !(record && canRead(*subscriber, *table, true)))
+                continue;
+
+            if (frame.empty()) frame = formatEvent(event);
+            push(*subscriber, frame);
+            ++m_delivered;
+        }
+    }
+
+    void RealtimeHub::push(Subscriber& subscriber, const std::string& frame)
+    {
+        std::lock_guard lock(subscriber.mutex);
+        if (subscriber.closed) return;
+
+        // A client this far behind is better off refetching than catching up
+        if (subscriber.pending.size() + frame.size() > MAX_PENDING_BYTES)
+        {
+            subscriber.pending = RESET_FRAME;
+            ++m_resets;
+        }
+        else
+        {
+            subscriber.pending += frame;
+        }
+
+        subscriber.cv.notify_one();
+    }
+
+    bool RealtimeHub::canRead(Subscriber& subscriber, TableUnit& table, const bool record)
+    {
+        const auto rule = record ? table.getRule() : table.listRule();
+        const auto key = table.tableName() + (record ? "|get" : "|list");
+
+        // Rules only depend on the subscriber & request, not on the record
+        if (const auto it = subscriber.access.find(key); it != subscriber.access.end() && it->second.first == rule)
+            return it->second.second;
+
+        bool allowed = false;
+        try
+        {
+            allowed = !table.checkAccess(rule, subscriber.auth, subscriber.reqVars).has_value();
+        }
+        catch (const std::exception& e)
+        {
+            Log::warn("Realtime access check on `{}` failed: {}", table.tableName(), e.what());
+        }
+
+        subscriber.access[key] = {rule, allowed};
+        return allowed;
+    }
+
+    bool RealtimeHub::authorized(Subscriber& subscriber)
+    {
+        if (subscriber.expires > 0 && nowSeconds() >= subscriber.expires)
+        {
+            close(subscriber);
+            return false;
+        }
+
+        if (!subscriber.reauth.exchange(false)) return true;
+
+        // Rules are evaluated again against the user as it's now
+        subscriber.access.clear();
+        try
+        {
+            const auto user = TableUnit::principal(subscriber.userTable, subscriber.userId);
+            if (!user.has_value())
+            {
+                close(subscriber);
+                return false;
+            }
+
+            for (const auto& [key, value] : user->items())
+                subscriber.auth[key] = value;
+        }
+        catch (const std::exception& e)
+        {
+            // Tried again with the next event
+            Log::warn("Realtime could not reload user `{}` of `{}`: {}", subscriber.userId, subscriber.userTable,
+                      e.what());
+            subscriber.reauth = true;
+            return false;
+        }
+
+        return true;
+    }
+
+    void RealtimeHub::close(Subscriber& subscriber)
+    {
+        std::lock_guard lock(subscriber.mutex);
+        subscriber.closed = true;
+        subscriber.cv.notify_all();
+    }
+}
@@ -0,0 +1,147 @@
+#include "../../include/mantis/core/record_cache.h"
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+#define __file__ "core/record_cache.cpp"
+
+namespace mantis
+{
+    void RecordCache::configure(const json& config)
+    {
+        {
+            std::unique_lock lock(m_configMutex);
+
+            const auto cfg = config.is_object() ? config : json::object();
+            m_defaults.enabled = cfg.value("enabled", false);
+            m_defaults.ttlSeconds = cfg.value("ttl", 60);
+
+            m_tables.clear();
+            const auto tables = cfg.value("tables", json::object());
+            for (const auto& [table, table_cfg] : tables.items())
+            {
+                if (!table_cfg.is_object()) continue;
+                m_tables[table] = TableConfig{
+                    table_cfg.value("enabled", m_defaults.enabled),
+                    table_cfg.value("ttl", m_defaults.ttlSeconds)
+                };
+            }
+
+            const auto max_entries = std::max<int64_t>(cfg.value("maxEntries", 10000), 0);
+            m_records.setCapacity(static_cast<size_t>(max_entries));
+        }
+
+        // Records cached under the previous TTLs & flags
+        clear();
+    }
+
+    void RecordCache::validate(const json& config)
+    {
+        if (!config.is_object())
+            throw std::invalid_argument("Expected `recordCache` to be an object");
+
+        const auto check_table_config = [](const json& cfg, const std::string& prefix)
+        {
+            if (cfg.contains("enabled") && !cfg["enabled"].is_boolean())
+                throw std::invalid_argument(std::format("Record cache `{}enabled` should be a boolean", prefix));
+            if (cfg.contains("ttl") && !cfg["ttl"].is_number_integer())
+                throw std::invalid_argument(std::format("Record cache `{}ttl` should be an integer", prefix));
+        };
+
+        for (const auto& [key, value] : config.items())
+        {
+            if (key == "enabled" || key == "ttl") continue;
+            if (key == "maxEntries")
+            {
+                if (!value.is_number_integer() || value.get<int64_t>() < 0)
+                    throw std::invalid_argument("Record cache `maxEntries` should be a non-negative integer");
+            }
+            else if (key == "tables")
+            {
+                if (!value.is_object())
+                    throw std::invalid_argument("Record cache `tables` should be an object");
+
+                for (const auto& [table, table_cfg] : value.items())
+                {
+                    if (!table_cfg.is_object())
+                        throw std::invalid_argument(std::format("Record cache config of table `{}` should be an object", table));
+
+                    for (const auto& [table_key, _] : table_cfg.items())
+                        if (table_key != "enabled" && table_key != "ttl")
+                            throw std::invalid_argument(std::format("Unknown record cache option `tables.{}.{}`", table, table_key));
+
+                    check_table_config(table_cfg, std::format("tables.{}.", table));
+                }
+            }
+            else throw std::invalid_argument(std::format("Unknown record cache option `{}`", key));
+        }
+
+        check_table_config(config, "");
+    }
+
+    bool RecordCache::enabled(const std::string& table) const
+    {
+        return m_records.capacity() > 0 && tableConfig(table).enabled;
+    }
+
+    std::optional<std::string> RecordCache::get(const std::string& table, const std::string& id)
+    {
+        return m_records.get(key(table, id));
+    }
+
+    uint64_t RecordCache::generation(const std::string& table, const std::string& id) const
+    {
+        return m_records.generation(key(table, id));
+    }
+
+    void RecordCache::put(const std::string& table, const std::string& id, std::string record,
+                          const uint64_t generation)
+    {
+        const auto ttl = tableConfig(table).ttlSeconds;
+        const auto expires = ttl <= 0
+                                 ? std::chrono::steady_clock::time_point::max()
+                                 : std::chrono::steady_clock::now() + std::chrono::seconds(ttl);
+
+        m_records.put(key(table, id), std::move(record), expires, generation);
+    }
+
+    void RecordCache::invalidate(const std::string& table, const std::string& id)
+    {
+        m_records.invalidate(key(table, id));
+    }
+
+    void RecordCache::invalidate(const std::string& table)
+    {
+        const auto prefix = key(table, "");
+        m_records.invalidateIf([&](const std::string& k, const std::string&) { return k.starts_with(prefix); });
+    }
+
+    void RecordCache::clear()
+    {
+        m_records.clear();
+    }
+
+    json RecordCache::stats() const
+    {
+        return m_records.stats();
+    }
+
+    std::string RecordCache::key(const std::string& table, const std::string& id)
+    {
+        // Table names can't hold a NUL, the key is unambiguous
+        std::string k;
+        k.reserve(table.size() + id.size() + 1);
+        k += table;
+        k.push_back('\0');
+        k += id;
+        return k;
+    }
+
+    RecordCache::TableConfig RecordCache::tableConfig(const std::string& table) const
+    {
+        std::shared_lock lock(m_configMutex);
+        if (const auto it = m_tables.find(table); it != m_tables.end()) return it->second;
+        return m_defaults;
+    }
+}
@@ -0,0 +1,114 @@
+#include "../../include/mantis/core/record_counter.h"
+#include "../../include/mantis/core/logging.h"
+
+#include <algorithm>
+
+#define __file__ "core/record_counter.cpp"
+
+namespace mantis
+{
+    void RecordCounter::configure(const std::string& mode, const int64_t ttlSeconds)
+    {
+        if (mode == "exact") m_mode = RecordCountMode::Exact;
+        else if (mode == "periodic") m_mode = RecordCountMode::Periodic;
+        else m_mode = RecordCountMode::Maintained;
+
+        m_ttlSeconds = ttlSeconds;
+
+        // Counts loaded under the previous mode may not have been kept up to date
+        clear();
+    }
+
+    int64_t RecordCounter::get(const std::string& table, const CountFunc& count)
+    {
+        if (m_mode == RecordCountMode::Exact)
+            return count();
+
+        {
+            std::lock_guard lock(m_mutex);
+            if (const auto it = m_entries.find(table); it != m_entries.end())
+            {
+                const auto ttl = m_ttlSeconds.load();
+                const auto age = std::chrono::steady_clock::now() - it->second.loaded;
+                if (ttl <= 0 || age < std::chrono::seconds(ttl))
+                {
+                    ++m_hits;
+                    return it->second.value;
+                }
+            }
+        }
+
+        // Count outside the lock, other tables shouldn't wait on this scan
+        ++m_misses;
+        return refresh(table, count);
+    }
+
+    int64_t RecordCounter::refresh(const std::string& table, const CountFunc& count)
+    {
+        uint64_t taken;
+        {
+            std::lock_guard lock(m_mutex);
+            taken = generation(table);
+        }
+
+        const auto value = count();
+        if (m_mode != RecordCountMode::Exact) store(table, value, taken);
+        return value;
+    }
+
+    void RecordCounter::add(const std::string& table, const int64_t delta)
+    {
+        if (m_mode != RecordCountMode::Maintained) return;
+
+        std::lock_guard lock(m_mutex);
+        ++m_generations[table];
+        if (const auto it = m_entries.find(table); it != m_entries.end())
+            it->second.value = std::max<int64_t>(0, it->second.value + delta);
+    }
+
+    void RecordCounter::invalidate(const std::string& table)
+    {
+        std::lock_guard lock(m_mutex);
+        ++m_generations[table];
+        m_entries.erase(table);
+    }
+
+    void RecordCounter::clear()
+    {
+        std::lock_guard lock(m_mutex);
+        ++m_clears;
+        m_entries.clear();
+    }
+
+    RecordCountMode RecordCounter::mode() const
+    {
+        return m_mode.load();
+    }
+
+    json RecordCounter::stats() const
+    {
+        std::lock_guard lock(m_mutex);
+        return {
+            {"hits", m_hits.load()},
+            {"misses", m_misses.load()},
+            {"tables", m_entries.size()}
+        };
+    }
+
+    uint64_t RecordCounter::generation(const std::string& table) const
+    {
+        // Both only grow, so the sum changes whenever either does
+        const auto it = m_generations.find(table);
+        return m_clears + (it == m_generations.end() ? 0 : it->second);
+    }
+
+    void RecordCounter::store(const std::string& table, const int64_t value, const uint64_t generation)
+    {
+        std::lock_guard lock(m_mutex);
+
+        // Records were created or deleted while counting, the count may be off already
+        if (this->generation(table) != generation) return;
+
+        m_entries[table] = Entry{value, std::chrono::steady_clock::now()};
+    }
+}
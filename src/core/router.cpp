@@ -7,6 +7,9 @@
 #include "../../include/mantis/core/fileunit.h"
 #include "../../include/mantis/core/private-impl/duktape_custom_types.h"
 #include "../../include/mantis/core/settings.h"
+#include "../../include/mantis/core/realtime.h"
+#include "../../include/mantis/core/sync.h"
+#include "../../include/mantis/core/jwt.h"
 
 #include <cmrc/cmrc.hpp>
 #include <dukglue/dukglue.h>
@@ -52,6 +55,19 @@ namespace mantis
         if (!generateFileServingApi())
             return false;
 
+        // Streams run on HTTP workers set aside for them, @see HttpUnit, capped by the setting
+        m_realtime = std::make_shared<RealtimeHub>(
+            [this](const std::string& name) { return findTable(name); },
+            static_cast<size_t>(MantisApp::instance().maxSubscribers()));
+        m_realtime->start();
+
+        // Streams of updated or deleted users are checked again
+        MantisApp::instance().db().authCache().setListener(
+            [hub = std::weak_ptr(m_realtime)](const std::string& table, const std::string& id)
+            {
+                if (const auto realtime = hub.lock()) realtime->invalidateUser(table, id);
+            });
+
         // Add other necessary endpoints
         [[maybe_unused]] auto _ = generateMiscEndpoints();
 
@@ -81,8 +97,12 @@ namespace mantis
 
     void RouterUnit::close()
     {
+        // End the realtime streams first, the server waits on their connections
+        if (m_realtime) m_realtime->stop();
+
         MantisApp::instance().http().close();
         m_routes.clear();
+        publishTables();
     }
 
     json RouterUnit::addRoute(const std::string& table)
@@ -130,6 +150,7 @@ namespace mantis
                     return false;
 
                 m_routes.push_back(tableUnit);
+                publishTables();
             }
         }
         catch (const std::exception& e)
@@ -198,6 +219,7 @@ namespace mantis
         const auto basePath = "/api/v1/" + table_old_name;
         MantisApp::instance().http().routeRegistry().remove("GET", basePath);
         MantisApp::instance().http().routeRegistry().remove("GET", basePath + "/:id");
+        MantisApp::instance().http().routeRegistry().remove("GET", basePath + "/export");
 
         if (table_type != "view")
         {
@@ -213,6 +235,7 @@ namespace mantis
 
         // Remove tableUnit instance for the instance
         m_routes.erase(it);
+        publishTables();
 
         return addRoute(table_name);
     }
@@ -308,6 +331,7 @@ namespace mantis
 
         // Remove tableUnit instance for the instance
         m_routes.erase(it);
+        publishTables();
 
         res["success"] = true;
         return res;
@@ -376,36 +400,115 @@ namespace mantis
     {
         TRACE_CLASS_METHOD()
 
-        const auto sql = MantisApp::instance().db().session();
-
-        // id created updated schema has_api
-        const soci::rowset<soci::row> rs = (sql->prepare << "SELECT id, name, type, schema, has_api FROM __tables");
+        // Tables created before keyset pagination lack its index
+        std::vector<std::string> index_ddls;
+        // Synced tables created before the sync log lack its triggers, others may still have them
+        std::vector<std::string> synced, unsynced;
 
-        for (const auto& row : rs)
+        // Scoped, the session has to be released before writing, the pool may only have this one
         {
-            const auto id = row.get<std::string>("id");
-            const auto name = row.get<std::string>("name");
-            const auto type = row.get<std::string>("type");
-            const auto hasApi = row.get<bool>("has_api");
+            const auto sql = MantisApp::instance().db().session();
 
-            // If `hasApi` is set, schema is valid, then, add API endpoints
-            if (const auto schema = row.get<json>("schema"); (hasApi && !schema.empty()))
+            // id created updated schema has_api
+            const soci::rowset<soci::row> rs = (sql->prepare << "SELECT id, name, type, schema, has_api FROM __tables");
+
+            for (const auto& row : rs)
             {
-                // We need to persist this instance, else it'll be cleaned up causing a crash
-                const auto tableUnit = std::make_shared<TableUnit>(schema);
-                tableUnit->setTableName(name);
-                tableUnit->setTableId(id);
+                const auto id = row.get<std::string>("id");
+                const auto name = row.get<std::string>("name");
+                const auto type = row.get<std::string>("type");
+                const auto hasApi = row.get<bool>("has_api");
+                const auto schema = row.get<json>("schema");
 
-                if (!tableUnit->setupRoutes())
-                    return false;
+                if (type != "view")
+                {
+                    index_ddls.push_back(Table::keysetIndexSql(name));
 
-                m_routes.push_back(tableUnit);
+                    // Renamed since, keep the old index only if the schema declares one by that name
+                    try
+                    {
+                        const auto legacy = Table::legacyKeysetIndexName(name);
+                        if (std::ranges::none_of(Table::schemaIndexes(schema),
+                                                 [&](const Index& index) { return index.name == legacy; }))
+                            index_ddls.push_back("DROP INDEX IF EXISTS " + legacy);
+                    }
+                    catch (const std::invalid_argument& e)
+                    {
+                        Log::warn("Invalid indexes in the schema of `{}`: {}", name, e.what());
+                    }
+
+                    // Change triggers, PostgreSQL only; idempotent, so older tables get them too
+                    for (auto& ddl : MantisApp::instance().db().changes().captureSql(name))
+                        index_ddls.push_back(std::move(ddl));
+
+                    // Sync is opt-in, @see SyncLog
+                    (schema.value("sync", false) ? synced : unsynced).push_back(name);
+                }
+
+                // If `hasApi` is set, schema is valid, then, add API endpoints
+                if (hasApi && !schema.empty())
+                {
+                    // We need to persist this instance, else it'll be cleaned up causing a crash
+                    const auto tableUnit = std::make_shared<TableUnit>(schema);
+                    tableUnit->setTableName(name);
+                    tableUnit->setTableId(id);
+
+                    if (!tableUnit->setupRoutes())
+                        return false;
+
+                    m_routes.push_back(tableUnit);
+                }
             }
         }
 
+        publishTables();
+
+        try
+        {
+            MantisApp::instance().db().write([&](soci::session& writer)
+            {
+                for (const auto& index_ddl : index_ddls)
+                    writer << index_ddl;
+                for (const auto& table : synced)
+                    SyncLog::track(writer, table);
+                for (const auto& table : unsynced)
+                    SyncLog::untrack(writer, table);
+                return true;
+            });
+        }
+        catch (const std::exception& e)
+        {
+            // Listing still works without the index, just slower
+            Log::warn("Could not create keyset pagination indexes, change or sync triggers: {}", e.what());
+        }
+
         return true;
     }
 
+    std::shared_ptr<TableUnit> RouterUnit::findTable(const std::string& name) const
+    {
+        // Read off the published index, `m_routes` is only touched by the thread changing it
+        const auto tables = m_tables.load();
+        if (!tables) return nullptr;
+
+        const auto it = tables->find(name);
+        return it == tables->end() ? nullptr : it->second;
+    }
+
+    void RouterUnit::publishTables()
+    {
+        auto tables = std::make_shared<TableIndex>();
+        for (const auto& route : m_routes)
+            tables->emplace(route->tableName(), route);
+
+        m_tables.store(std::move(tables));
+    }
+
+    std::shared_ptr<TableUnit> RouterUnit::adminTable() const
+    {
+        return m_adminTable;
+    }
+
     bool RouterUnit::generateMiscEndpoints() const
     {
         TRACE_CLASS_METHOD()
@@ -424,6 +527,100 @@ namespace mantis
                                              res.sendJson(200, response);
                                          });
 
+        // Batch writes across tables, in a single transaction
+        MantisApp::instance().http().Post("/api/v1/batch",
+                                          [this](MantisRequest& req, MantisResponse& res)
+                                          {
+                                              batchWrite(req, res);
+                                          },
+                                          {
+                                              [](MantisRequest& req, MantisResponse& res)-> bool
+                                              {
+                                                  return TableUnit::getAuthToken(req, res);
+                                              }
+                                          });
+
+        // Bulk imports into a table, admins only
+        MantisApp::instance().http().Post("/api/v1/import/:table",
+                                          [this](MantisRequest& req, MantisResponse& res,
+                                                 const MantisContentReader& reader)
+                                          {
+                                              importRecords(req, res, reader);
+                                          },
+                                          {
+                                              [](MantisRequest& req, MantisResponse& res)-> bool
+                                              {
+                                                  return TableUnit::getAuthToken(req, res);
+                                              },
+                                              [](MantisRequest& req, MantisResponse& res)-> bool
+                                              {
+                                                  return MantisApp::instance().settings().hasAccess(req, res);
+                                              }
+                                          });
+
+        // Realtime record changes, as Server-Sent Events
+        MantisApp::instance().http().Get("/api/v1/realtime",
+                                         [this](MantisRequest& req, MantisResponse& res)
+                                         {
+                                             realtime(req, res);
+                                         },
+                                         {
+                                             [](MantisRequest& req, MantisResponse& res)-> bool
+                                             {
+                                                 return TableUnit::getAuthToken(req, res);
+                                             }
+                                         });
+
+        // Incremental sync, pulling changes since a token & pushing offline changes
+        MantisApp::instance().http().Get("/api/v1/sync/:table",
+                                         [this](MantisRequest& req, MantisResponse& res)
+                                         {
+                                             syncPull(req, res);
+                                         },
+                                         {
+                                             [](MantisRequest& req, MantisResponse& res)-> bool
+                                             {
+                                                 return TableUnit::getAuthToken(req, res);
+                                             }
+                                         });
+
+        MantisApp::instance().http().Post("/api/v1/sync/:table",
+                                          [this](MantisRequest& req, MantisResponse& res)
+                                          {
+                                              syncPush(req, res);
+                                          },
+                                          {
+                                              [](MantisRequest& req, MantisResponse& res)-> bool
+                                              {
+                                                  return TableUnit::getAuthToken(req, res);
+                                              }
+                                          });
+
+        // Database telemetry, admins only
+        MantisApp::instance().http().Get("/api/v1/metrics",
+                                         [this](MantisRequest&, MantisResponse& res)
+                                         {
+                                             json response;
+                                             response["status"] = 200;
+                                             response["data"] = MantisApp::instance().db().metrics();
+                                             response["data"]["realtime"] = m_realtime
+                                                                                ? m_realtime->stats()
+                                                                                : json(nullptr);
+                                             response["data"]["tokens"] = JwtUnit::tokenCache().stats();
+                                             response["error"] = "";
+                                             res.sendJson(200, response);
+                                         },
+                                         {
+                                             [](MantisRequest& req, MantisResponse& res)-> bool
+                                             {
+                                                 return TableUnit::getAuthToken(req, res);
+                                             },
+                                             [](MantisRequest& req, MantisResponse& res)-> bool
+                                             {
+                                                 return MantisApp::instance().settings().hasAccess(req, res);
+                                             }
+                                         });
+
         return true;
     }
 
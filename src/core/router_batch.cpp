@@ -0,0 +1,242 @@
+#include "../../include/mantis/core/router.h"
+#include "../../include/mantis/utils/utils.h"
+#include "../../include/mantis/app/app.h"
+#include "../../include/mantis/core/database.h"
+#include "../../include/mantis/core/tables/tables.h"
+
+#include <deque>
+
+#define __file__ "core/router_batch.cpp"
+
+namespace mantis
+{
+    void RouterUnit::batchWrite(MantisRequest& req, MantisResponse& res) const
+    {
+        TRACE_CLASS_METHOD()
+
+        json response;
+        const auto sendError = [&](const int status, const std::string& error)
+        {
+            response["status"] = status;
+            response["data"] = json::array();
+            response["error"] = error;
+
+            res.sendJson(status, response);
+        };
+
+        json body;
+        try { body = json::parse(req.getBody()); }
+        catch (const std::exception&)
+        {
+            sendError(400, "Could not parse request body!");
+            return;
+        }
+
+        // Either an array of operations or an object with an `operations` array
+        const auto operations = body.is_array() ? body : body.value("operations", json());
+        if (!operations.is_array() || operations.empty())
+        {
+            sendError(400, "Expected a non empty array of operations");
+            return;
+        }
+
+        if (operations.size() > MAX_BATCH_OPERATIONS)
+        {
+            sendError(400, std::format("A batch can't have more than {} operations", MAX_BATCH_OPERATIONS));
+            return;
+        }
+
+        struct Operation
+        {
+            std::shared_ptr<TableUnit> table;
+            std::string action;
+            TableUnit::RecordWrite write;
+        };
+
+        // Writes are bound by reference, a deque keeps them in place as it grows
+        std::deque<Operation> ops;
+
+        // The user is loaded once, access rules are evaluated once per table & action
+        std::optional<json> auth;
+        const auto reqMap = TableUnit::requestVars(req);
+        std::unordered_map<std::string, std::optional<json>> access;
+
+        try
+        {
+            for (size_t i = 0; i < operations.size(); ++i)
+            {
+                const auto& item = operations[i];
+                const auto fail = [&](const int status, const std::string& error)
+                {
+                    sendError(status, std::format("Operation #{}: {}", i, error));
+                };
+
+                if (!item.is_object())
+                {
+                    fail(400, "Expected an object");
+                    return;
+                }
+
+                const auto action = item.value("action", "");
+                const auto table_name = item.value("table", "");
+                const auto id = item.value("id", "");
+                const auto data = item.value("data", json::object());
+
+                if (action != "create" && action != "update" && action != "delete")
+                {
+                    fail(400, "Expected `action` to be one of `create`, `update` or `delete`");
+                    return;
+                }
+
+                const auto table = findTable(table_name);
+                if (!table)
+                {
+                    fail(404, std::format("Table `{}` not found", table_name));
+                    return;
+                }
+
+                if (table->tableType() == "view")
+                {
+                    fail(400, std::format("Table `{}` is a view, views are read only", table_name));
+                    return;
+                }
+
+                const auto access_key = table_name + "|" + action;
+                if (!access.contains(access_key))
+                {
+                    if (!auth.has_value()) auth = table->resolveAuth(req);
+
+                    const auto rule = action == "create"
+                                          ? table->addRule()
+                                          : action == "update"
+                                          ? table->updateRule()
+                                          : table->deleteRule();
+                    access[access_key] = table->checkAccess(rule, auth.value(), reqMap);
+                }
+
+                if (const auto& denied = access.at(access_key); denied.has_value())
+                {
+                    fail(denied->at("status").get<int>(), denied->at("error").get<std::string>());
+                    return;
+                }
+
+                if (action != "create" && id.empty())
+                {
+                    fail(400, "Record `id` is required");
+                    return;
+                }
+
+                auto& op = ops.emplace_back();
+                op.table = table;
+                op.action = action;
+
+                // Same validation as the single record endpoints, JSON fields only
+                std::optional<json> status;
+                if (action == "create")
+                {
+                    if (const auto err = table->validateRequestBody(data))
+                    {
+                        fail(400, err.value());
+                        return;
+                    }
+
+                    status = table->prepareCreate(data, json::object(), op.write);
+                }
+                else if (action == "update")
+                {
+                    if (const auto err = table->validateUpdateRequestBody(data))
+                    {
+                        fail(400, err.value());
+                        return;
+                    }
+
+                    status = table->prepareUpdate(id, data, json::object(), op.write);
+                }
+                else
+                {
+                    op.write.id = id;
+                }
+
+                if (status.has_value())
+                {
+                    fail(status->value("status", 500), status->value("error", ""));
+                    return;
+                }
+            }
+
+            // All operations in one transaction, any failure rolls back the whole batch
+            std::string failure;
+            const auto committed = MantisApp::instance().db().write([&](soci::session& sql)
+            {
+                for (size_t i = 0; i < ops.size(); ++i)
+                {
+                    auto& [table, action, write] = ops[i];
+                    try
+                    {
+                        if (action == "create")
+                        {
+                            table->executeCreate(sql, write);
+                        }
+                        else if (action == "update")
+                        {
+                            if (const auto err = table->executeUpdate(sql, write); !err.empty())
+                            {
+                                failure = std::format("Operation #{}: {}", i, err);
+                                return false;
+                            }
+                        }
+                        else
+                        {
+                            table->executeRemove(sql, write);
+                        }
+                    }
+                    catch (const std::exception& e)
+                    {
+                        failure = std::format("Operation #{}: {}", i, e.what());
+                        return false;
+                    }
+                }
+
+                return true;
+            });
+
+            if (!committed)
+            {
+                sendError(400, failure);
+                return;
+            }
+
+            // Per operation results, in request order
+            json results = json::array();
+            for (auto& [table, action, write] : ops)
+            {
+                if (action == "create")
+                {
+                    table->finishCreate(write);
+                    results.push_back({{"status", 201}, {"data", write.record}});
+                }
+                else if (action == "update")
+                {
+                    table->finishUpdate(write);
+                    results.push_back({{"status", 200}, {"data", write.record}});
+                }
+                else
+                {
+                    table->finishRemove(write);
+                    results.push_back({{"status", 204}, {"data", json::object()}});
+                }
+            }
+
+            response["status"] = 200;
+            response["data"] = results;
+            response["error"] = "";
+
+            res.sendJson(200, response);
+        }
+        catch (const std::exception& e)
+        {
+            Log::critical("Batch write failed: {}", e.what());
+            sendError(500, e.what());
+        }
+    }
+}
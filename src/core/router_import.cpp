@@ -0,0 +1,110 @@
+#include "../../include/mantis/core/router.h"
+#include "../../include/mantis/utils/utils.h"
+#include "../../include/mantis/app/app.h"
+#include "../../include/mantis/core/http.h"
+#include "../../include/mantis/core/importer.h"
+#include "../../include/mantis/core/tables/tables.h"
+
+#include <fstream>
+
+#define __file__ "core/router_import.cpp"
+
+namespace mantis
+{
+    void RouterUnit::importRecords(MantisRequest& req, MantisResponse& res, const httplib::ContentReader& reader) const
+    {
+        TRACE_CLASS_METHOD()
+
+        json response;
+        const auto sendError = [&](const int status, const std::string& error, const json& data = json::object())
+        {
+            response["status"] = status;
+            response["data"] = data;
+            response["error"] = error;
+
+            res.sendJson(status, response);
+        };
+
+        const auto table_name = req.getPathParamValue("table");
+        const auto table = findTable(table_name);
+        if (!table)
+        {
+            sendError(404, std::format("Table `{}` not found", table_name));
+            return;
+        }
+
+        // Explicit format, else from the content type
+        auto format = req.getQueryParamValue("format");
+        if (format.empty())
+        {
+            const auto content_type = req.getHeaderValue("Content-Type", "", 0);
+            if (content_type.starts_with("text/csv")) format = "csv";
+            else if (content_type.starts_with("application/x-ndjson")) format = "ndjson";
+            else if (content_type.starts_with("application/json")) format = "json";
+        }
+
+        std::optional<RecordImporter> importer;
+        try
+        {
+            importer.emplace(*table, format);
+
+            if (req.hasQueryParam("batchSize"))
+                importer->setBatchSize(RecordImporter::parseBatchSize(req.getQueryParamValue("batchSize")));
+            importer->setSkipInvalid(req.getQueryParamValue("skipInvalid") == "true");
+        }
+        catch (const std::exception& e)
+        {
+            sendError(400, e.what());
+            return;
+        }
+
+        // Spool the body to disk as it arrives, the import reads it back as a stream
+        const auto path = joinPaths(MantisApp::instance().dataDir(), std::format("import-{}.tmp", generateShortId()));
+        {
+            std::ofstream out(path, std::ios::binary);
+            const auto received = out && reader([&](const char* data, const size_t length)
+            {
+                out.write(data, static_cast<std::streamsize>(length));
+                return out.good();
+            });
+
+            if (!received)
+            {
+                out.close();
+                std::filesystem::remove(path);
+                sendError(500, "Could not store the uploaded file");
+                return;
+            }
+        }
+
+        importer->onProgress([&](const ImportStats& stats)
+        {
+            Log::info("Importing into `{}`: {} rows inserted, {} skipped", table_name, stats.inserted, stats.skipped);
+        });
+
+        try
+        {
+            std::ifstream in(path, std::ios::binary);
+            const auto stats = importer->run(in);
+            in.close();
+            std::filesystem::remove(path);
+
+            response["status"] = 200;
+            response["data"] = stats.toJson();
+            response["error"] = "";
+
+            res.sendJson(200, response);
+        }
+        catch (const std::invalid_argument& e)
+        {
+            std::filesystem::remove(path);
+            sendError(400, e.what(), importer->stats().toJson());
+        }
+        catch (const std::exception& e)
+        {
+            std::filesystem::remove(path);
+            Log::critical("Import into `{}` failed: {}", table_name, e.what());
+            sendError(500, e.what(), importer->stats().toJson());
+        }
+    }
+}
@@ -0,0 +1,107 @@
+#include "../../include/mantis/core/router.h"
+#include "../../include/mantis/utils/utils.h"
+#include "../../include/mantis/app/app.h"
+#include "../../include/mantis/core/http.h"
+#include "../../include/mantis/core/jwt.h"
+#include "../../include/mantis/core/realtime.h"
+#include "../../include/mantis/core/tables/tables.h"
+
+#define __file__ "core/router_realtime.cpp"
+
+namespace mantis
+{
+    void RouterUnit::realtime(MantisRequest& req, MantisResponse& res) const
+    {
+        TRACE_CLASS_METHOD()
+
+        json response;
+        const auto sendError = [&](const int status, const std::string& error)
+        {
+            response["status"] = status;
+            response["data"] = json::object();
+            response["error"] = error;
+
+            res.sendJson(status, response);
+        };
+
+        std::string error;
+        auto topics = RealtimeHub::parseTopics(
+            req.hasQueryParam("subscribe") ? req.getQueryParamValue("subscribe") : "", error);
+        if (!error.empty())
+        {
+            sendError(400, error);
+            return;
+        }
+
+        // EventSource can't send an `Authorization` header, accept the token as a parameter
+        auto auth = req.getOr<json>("auth", json::object());
+        if (!req.hasHeader("Authorization") && req.hasQueryParam("token"))
+        {
+            auth["token"] = trim(req.getQueryParamValue("token"));
+            auth["type"] = "user";
+            req.set("auth", auth);
+        }
+
+        const auto reqVars = TableUnit::requestVars(req);
+        std::optional<json> user;
+
+        // Refuse topics that could never deliver, the broadcaster checks the rules again per event
+        for (const auto& topic : topics)
+        {
+            const auto table = findTable(topic.table);
+            if (!table)
+            {
+                sendError(404, std::format("Table `{}` not found", topic.table));
+                return;
+            }
+
+            if (!user.has_value()) user = table->resolveAuth(req);
+
+            const auto rule = topic.id.empty() ? table->listRule() : table->getRule();
+            if (const auto denied = table->checkAccess(rule, user.value(), reqVars); denied.has_value())
+            {
+                sendError(denied->at("status").get<int>(),
+                          std::format("`{}`: {}", topic.table, denied->at("error").get<std::string>()));
+                return;
+            }
+        }
+
+        // The stream ends with the token, verification is cached since resolving the user
+        int64_t expires = 0;
+        if (user->contains("id") && !(*user)["id"].is_null() && user->contains("token") && (*user)["token"].is_string())
+        {
+            const auto claims = JwtUnit::verifyJwtToken((*user)["token"].get<std::string>());
+            if (claims.contains("exp") && claims["exp"].is_number()) expires = claims["exp"].get<int64_t>();
+        }
+
+        const auto hub = m_realtime;
+        const auto subscriber = hub ? hub->subscribe(std::move(topics), user.value(), reqVars, expires) : nullptr;
+        if (!subscriber)
+        {
+            sendError(503, "Too many realtime subscribers, try again later");
+            return;
+        }
+
+        res.setStatus(200);
+        res.setHeader("Cache-Control", "no-cache");
+        res.setHeader("X-Accel-Buffering", "no"); // Keep reverse proxies from buffering the stream
+        res.setChunkedContentProvider(
+            "text/event-stream",
+            [hub, subscriber](size_t, httplib::DataSink& sink) -> bool
+            {
+                std::string frames;
+                if (!hub->next(*subscriber, frames))
+                {
+                    sink.done();
+                    return true;
+                }
+
+                // Fails once the client went away, ending the stream
+                return sink.write(frames.data(), frames.size());
+            },
+            [hub, subscriber](bool)
+            {
+                hub->unsubscribe(subscriber);
+            });
+    }
+}
@@ -0,0 +1,385 @@
+#include "../../include/mantis/core/router.h"
+#include "../../include/mantis/utils/utils.h"
+#include "../../include/mantis/app/app.h"
+#include "../../include/mantis/core/database.h"
+#include "../../include/mantis/core/sync.h"
+#include "../../include/mantis/core/tables/tables.h"
+
+#include <deque>
+#include <unordered_map>
+
+#define __file__ "core/router_sync.cpp"
+
+namespace mantis
+{
+    void RouterUnit::syncPull(MantisRequest& req, MantisResponse& res) const
+    {
+        TRACE_CLASS_METHOD()
+
+        json response;
+        const auto sendError = [&](const int status, const std::string& error)
+        {
+            response["status"] = status;
+            response["data"] = json::object();
+            response["error"] = error;
+
+            res.sendJson(status, response);
+        };
+
+        const auto table_name = req.getPathParamValue("table");
+        const auto table = findTable(table_name);
+        if (!table)
+        {
+            sendError(404, std::format("Table `{}` not found", table_name));
+            return;
+        }
+
+        if (table->tableType() == "view")
+        {
+            sendError(400, std::format("Table `{}` is a view, views aren't synced", table_name));
+            return;
+        }
+
+        if (!table->syncEnabled())
+        {
+            sendError(400, std::format("Table `{}` isn't synced, enable `sync` on its schema", table_name));
+            return;
+        }
+
+        if (const auto denied = table->checkAccess(table->listRule(), table->resolveAuth(req),
+                                                   TableUnit::requestVars(req)); denied.has_value())
+        {
+            sendError(denied->at("status").get<int>(), denied->at("error").get<std::string>());
+            return;
+        }
+
+        int64_t since = 0;
+        int limit = SyncLog::DEFAULT_PULL_LIMIT;
+        try
+        {
+            if (req.hasQueryParam("since")) since = std::stoll(req.getQueryParamValue("since"));
+            if (req.hasQueryParam("limit")) limit = std::stoi(req.getQueryParamValue("limit"));
+        }
+        catch (const std::exception&)
+        {
+            sendError(400, "Expected integer `since` and `limit` parameters");
+            return;
+        }
+
+        if (since < 0 || limit < 1)
+        {
+            sendError(400, "Expected `since` to be 0 or more and `limit` to be 1 or more");
+            return;
+        }
+        limit = std::min(limit, SyncLog::MAX_PULL_LIMIT);
+
+        try
+        {
+            const auto sql = MantisApp::instance().db().readSession();
+
+            // One extra entry tells whether there's another page
+            auto entries = SyncLog::changesSince(*sql, table_name, since, limit + 1);
+            const bool has_more = entries.size() > static_cast<size_t>(limit);
+            if (has_more) entries.resize(limit);
+
+            std::vector<std::string> ids;
+            json deleted = json::array();
+            for (const auto& entry : entries)
+            {
+                if (entry.deleted) deleted.push_back(entry.id);
+                else ids.push_back(entry.id);
+            }
+
+            // Current state of the changed records, however often they changed. Read in chunks,
+            // older SQLite builds take at most 999 parameters; chunks are padded to a few fixed
+            // sizes with their first id, so the statements are prepared once & cached.
+            std::unordered_map<std::string, json> records_by_id;
+            for (size_t offset = 0; offset < ids.size(); offset += SyncLog::PULL_CHUNK)
+            {
+                std::vector chunk(ids.begin() + static_cast<std::ptrdiff_t>(offset),
+                                  ids.begin() + static_cast<std::ptrdiff_t>(
+                                      std::min(offset + SyncLog::PULL_CHUNK, ids.size())));
+                const size_t size = chunk.size() <= 10 ? 10 : chunk.size() <= 100 ? 100 : SyncLog::PULL_CHUNK;
+                chunk.resize(size, chunk.front());
+
+                soci::row row;
+                const auto st = MantisApp::instance().db().statements().prepare(
+                    *sql, table_name, "sync|" + std::to_string(size), [&]
+                    {
+                        std::string placeholders;
+                        for (size_t i = 0; i < size; ++i)
+                            placeholders += (i == 0 ? ":id" : ", :id") + std::to_string(i);
+
+                        return std::format("SELECT * FROM {} WHERE id IN ({})", table_name, placeholders);
+                    });
+                for (auto& id : chunk) st->exchange(soci::use(id));
+                st->exchange(soci::into(row));
+                st->define_and_bind();
+                st->execute(false);
+
+                while (st->fetch())
+                {
+                    auto record = table->parseDbRowToJson(row);
+                    if (table->tableType() == "auth") record.erase("password");
+
+                    auto id = record.value("id", "");
+                    records_by_id.emplace(std::move(id), std::move(record));
+                }
+            }
+
+            // In sequence order; records deleted since the log was read come as tombstones next time
+            json records = json::array();
+            for (const auto& id : ids)
+            {
+                if (const auto it = records_by_id.find(id); it != records_by_id.end())
+                    records.push_back(std::move(it->second));
+            }
+
+            response["status"] = 200;
+            response["data"] = {
+                {"records", records},
+                {"deleted", deleted},
+                {"since", entries.empty() ? since : entries.back().seq},
+                {"hasMore", has_more}
+            };
+            response["error"] = "";
+
+            res.sendJson(200, response);
+        }
+        catch (const std::exception& e)
+        {
+            Log::critical("Sync pull from `{}` failed: {}", table_name, e.what());
+            sendError(500, e.what());
+        }
+    }
+
+    void RouterUnit::syncPush(MantisRequest& req, MantisResponse& res) const
+    {
+        TRACE_CLASS_METHOD()
+
+        json response;
+        const auto sendError = [&](const int status, const std::string& error)
+        {
+            response["status"] = status;
+            response["data"] = json::object();
+            response["error"] = error;
+
+            res.sendJson(status, response);
+        };
+
+        const auto table_name = req.getPathParamValue("table");
+        const auto table = findTable(table_name);
+        if (!table)
+        {
+            sendError(404, std::format("Table `{}` not found", table_name));
+            return;
+        }
+
+        if (table->tableType() == "view")
+        {
+            sendError(400, std::format("Table `{}` is a view, views are read only", table_name));
+            return;
+        }
+
+        if (!table->syncEnabled())
+        {
+            sendError(400, std::format("Table `{}` isn't synced, enable `sync` on its schema", table_name));
+            return;
+        }
+
+        json body;
+        try { body = json::parse(req.getBody()); }
+        catch (const std::exception&)
+        {
+            sendError(400, "Could not parse request body!");
+            return;
+        }
+
+        const auto changes = body.is_object() ? body.value("changes", json::array()) : json();
+        const auto deletes = body.is_object() ? body.value("deleted", json::array()) : json();
+        if (!changes.is_array() || !deletes.is_array())
+        {
+            sendError(400, "Expected `changes` and `deleted` arrays");
+            return;
+        }
+
+        if (changes.size() + deletes.size() > MAX_BATCH_OPERATIONS)
+        {
+            sendError(400, std::format("A push can't have more than {} records", MAX_BATCH_OPERATIONS));
+            return;
+        }
+
+        // Rules are evaluated once per action, a denied action only fails the records needing it
+        const auto auth = table->resolveAuth(req);
+        const auto reqMap = TableUnit::requestVars(req);
+        const auto denial = [&](const std::string& rule) -> std::string
+        {
+            const auto denied = table->checkAccess(rule, auth, reqMap);
+            return denied.has_value() ? denied->at("error").get<std::string>() : "";
+        };
+        const auto create_denied = changes.empty() ? "" : denial(table->addRule());
+        const auto update_denied = changes.empty() ? "" : denial(table->updateRule());
+        const auto delete_denied = deletes.empty() ? "" : denial(table->deleteRule());
+
+        struct Change
+        {
+            std::string id;
+            std::string updated; ///> Client's, normalized & clamped to the server's time
+            bool remove = false;
+            TableUnit::RecordWrite create, update, removal;
+            std::string createError, updateError; ///> Why the record can't be created or updated
+            std::string applied; ///> `create`, `update` or `delete` once written
+        };
+
+        // Writes are bound by reference, a deque keeps them in place as it grows
+        std::deque<Change> pending;
+
+        // Client times past the server's are taken as now, see SyncLog::pushedTime()
+        const std::time_t now_t = time(nullptr);
+        const auto now = tmToStr(*std::localtime(&now_t));
+
+        const auto read = [&](const json& item, const size_t i, const bool remove) -> Change*
+        {
+            const auto id = item.is_object() ? item.value("id", "") : "";
+            const auto value = item.is_object() ? item.value("updated", json()) : json();
+            const auto updated = value.is_string() ? SyncLog::pushedTime(value.get<std::string>(), now) : "";
+            if (id.empty() || updated.empty())
+            {
+                sendError(400, std::format("{} #{}: expected `id` and `updated`", remove ? "Deleted" : "Change", i));
+                return nullptr;
+            }
+
+            auto& change = pending.emplace_back();
+            change.id = id;
+            change.updated = updated;
+            change.remove = remove;
+            return &change;
+        };
+
+        try
+        {
+            for (size_t i = 0; i < changes.size(); ++i)
+            {
+                const auto& item = changes[i];
+                auto* change = read(item, i, false);
+                if (!change) return;
+
+                // Whether it's a create or an update is only known on writing, prepare both
+                if (!create_denied.empty()) change->createError = create_denied;
+                else if (const auto err = table->validateRequestBody(item)) change->createError = err.value();
+                else if (const auto status = table->prepareCreate(
+                    item, {{"id", change->id}, {"updated", change->updated}}, change->create))
+                    change->createError = status->value("error", "");
+
+                if (!update_denied.empty()) change->updateError = update_denied;
+                else if (const auto err = table->validateUpdateRequestBody(item)) change->updateError = err.value();
+                else if (const auto status = table->prepareUpdate(
+                    change->id, item, {{"updated", change->updated}}, change->update))
+                    change->updateError = status->value("error", "");
+            }
+
+            for (size_t i = 0; i < deletes.size(); ++i)
+            {
+                auto* change = read(deletes[i], i, true);
+                if (!change) return;
+                change->removal.id = change->id;
+            }
+
+            json conflicts = json::array();
+            const auto conflict = [&](const Change& change, const std::string& reason, const std::string& error = "")
+            {
+                json item = {{"id", change.id}, {"reason", reason}};
+                if (!error.empty()) item["error"] = error;
+                conflicts.push_back(item);
+            };
+
+            // Decided against the records as they are in the write transaction, last write wins on `updated`
+            std::string failure;
+            const auto committed = MantisApp::instance().db().write([&](soci::session& sql)
+            {
+                conflicts = json::array();
+                for (auto& change : pending)
+                {
+                    change.applied.clear();
+                    try
+                    {
+                        const auto server = table->updatedAt(sql, change.id);
+
+                        if (change.remove)
+                        {
+                            // Already gone, deleting again is a no-op
+                            if (!server.has_value()) change.applied = "none";
+                            // A delete of the version the client saw wins, a newer server update doesn't lose
+                            else if (server.value() > change.updated) conflict(change, "stale");
+                            else if (!delete_denied.empty()) conflict(change, "forbidden", delete_denied);
+                            else
+                            {
+                                table->executeRemove(sql, change.removal);
+                                change.applied = "delete";
+                            }
+                        }
+                        else if (server.has_value())
+                        {
+                            // Ties go to the server
+                            if (change.updated <= server.value()) conflict(change, "stale");
+                            else if (!change.updateError.empty())
+                                conflict(change, update_denied.empty() ? "invalid" : "forbidden", change.updateError);
+                            else if (const auto err = table->executeUpdate(sql, change.update); !err.empty())
+                                conflict(change, "invalid", err);
+                            else change.applied = "update";
+                        }
+                        else
+                        {
+                            // Deleted on the server after the client's change
+                            if (const auto deleted = SyncLog::deletedAt(sql, table_name, change.id);
+                                !deleted.empty() && deleted >= change.updated)
+                                conflict(change, "deleted");
+                            else if (!change.createError.empty())
+                                conflict(change, create_denied.empty() ? "invalid" : "forbidden", change.createError);
+                            else
+                            {
+                                table->executeCreate(sql, change.create);
+                                change.applied = "create";
+                            }
+                        }
+                    }
+                    catch (const std::exception& e)
+                    {
+                        failure = std::format("Record `{}`: {}", change.id, e.what());
+                        return false;
+                    }
+                }
+
+                return true;
+            });
+
+            if (!committed)
+            {
+                sendError(400, failure);
+                return;
+            }
+
+            json applied = json::array();
+            for (auto& change : pending)
+            {
+                if (change.applied.empty()) continue;
+
+                if (change.applied == "create") table->finishCreate(change.create);
+                else if (change.applied == "update") table->finishUpdate(change.update);
+                else if (change.applied == "delete") table->finishRemove(change.removal);
+                applied.push_back(change.id);
+            }
+
+            response["status"] = 200;
+            response["data"] = {{"applied", applied}, {"conflicts", conflicts}};
+            response["error"] = "";
+
+            res.sendJson(200, response);
+        }
+        catch (const std::exception& e)
+        {
+            Log::critical("Sync push to `{}` failed: {}", table_name, e.what());
+            sendError(500, e.what());
+        }
+    }
+}
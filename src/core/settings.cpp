@@ -61,13 +61,21 @@ namespace mantis
             settings["sessionTimeout"] = 24 * 60 * 60; // 24 hours
             settings["adminSessionTimeout"] = 1 * 60 * 60; // 1 hour
             settings["mode"] = "PROD";
+            settings["recordCountMode"] = "maintained"; // exact | maintained | periodic
+            settings["recordCountTTL"] = 60; // in seconds
+            settings["recordCache"] = {{"enabled", false}, {"maxEntries", 10000}, {"ttl", 60}, {"tables", json::object()}};
 
             *sql <<
                 "INSERT INTO __settings (id, value, created, updated) VALUES (:id, :value, :created, :updated)"
                 ,
                 soci::use(id), soci::use(settings),
                 soci::use(*created_tm), soci::use(*created_tm);
+
+            m_configs = settings;
         }
+
+        applyRecordCountConfig();
+        applyRecordCacheConfig();
     }
 
     bool SettingsUnit::hasAccess(MantisRequest& req, MantisResponse& res) const
@@ -133,18 +141,9 @@ namespace mantis
             return REQUEST_HANDLED;
         }
 
-        // Query for user with given ID, this info will be populated to the
-        // expression evaluator args as well as available through
-        // the session context, queried by:
-        //  ` ctx.get<json>("auth").value("id", ""); // returns the user ID
-        //  ` ctx.get<json>("auth").value("name", ""); // returns the user's name
-        auto sql = MantisApp::instance().db().session();
-        soci::row r;
-        std::string query = "SELECT * FROM __admins WHERE id = :id LIMIT 1";
-        *sql << query, soci::use(_id), soci::into(r);
-
+        // Check the admin with given ID still exists, read once & then served from the auth cache
         // Return 404 if user was not found
-        if (!sql->got_data())
+        if (!TableUnit::principal("__admins", _id).has_value())
         {
             json response;
             response["status"] = 404;
@@ -178,6 +177,18 @@ namespace mantis
         return m_configs;
     }
 
+    void SettingsUnit::applyRecordCountConfig() const
+    {
+        MantisApp::instance().db().counters().configure(
+            m_configs.value("recordCountMode", "maintained"),
+            m_configs.value("recordCountTTL", 60));
+    }
+
+    void SettingsUnit::applyRecordCacheConfig() const
+    {
+        MantisApp::instance().db().recordCache().configure(m_configs.value("recordCache", json::object()));
+    }
+
     json SettingsUnit::initSettingsConfig()
     {
         // Get app session
@@ -282,6 +293,61 @@ namespace mantis
                     return;
                 }
 
+                // SQLite tuning is applied as sessions are opened, on the next start
+                json sqlite_profile;
+                if (body.contains("sqliteProfile"))
+                {
+                    try
+                    {
+                        sqlite_profile = SqliteProfile::fromJson(body["sqliteProfile"]).toJson();
+                    }
+                    catch (const std::exception& e)
+                    {
+                        json response;
+                        response["status"] = 400;
+                        response["error"] = e.what();
+                        response["data"] = json::object();
+
+                        res.sendJson(400, response);
+                        return;
+                    }
+                }
+
+                if (body.contains("recordCache"))
+                {
+                    try
+                    {
+                        RecordCache::validate(body["recordCache"]);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        json response;
+                        response["status"] = 400;
+                        response["error"] = e.what();
+                        response["data"] = json::object();
+
+                        res.sendJson(400, response);
+                        return;
+                    }
+                }
+
+                std::string count_error;
+                if (body.contains("recordCountMode") && !body["recordCountMode"].is_string())
+                    count_error = "Expected `recordCountMode` to be a string";
+                else if (body.contains("recordCountTTL") && !body["recordCountTTL"].is_number_integer())
+                    count_error = "Expected `recordCountTTL` to be an integer";
+
+                if (!count_error.empty())
+                {
+                    json response;
+                    response["status"] = 400;
+                    response["error"] = count_error;
+                    response["data"] = json::object();
+
+                    res.sendJson(400, response);
+                    return;
+                }
+
                 // Get app session
                 const auto sql = MantisApp::instance().db().session();
 
@@ -326,6 +392,29 @@ namespace mantis
                 toUpperCase(mode); // Ensure mode is in upper case
                 m_configs["mode"] = mode == "TEST" ? "TEST" : "PROD"; // Limit update modes to prod/test only
 
+                // How list pagination counts records
+                auto count_mode = body.contains("recordCountMode")
+                                      ? body.value("recordCountMode", "maintained")
+                                      : m_configs.value("recordCountMode", "maintained");
+                toLowerCase(count_mode);
+                m_configs["recordCountMode"] = count_mode == "exact" || count_mode == "periodic"
+                                                   ? count_mode
+                                                   : "maintained";
+                m_configs["recordCountTTL"] = body.contains("recordCountTTL")
+                                                  ? body["recordCountTTL"].get<int64_t>()
+                                                  : m_configs.value("recordCountTTL", 60);
+                applyRecordCountConfig();
+
+                // Point read cache, replaced as a whole
+                if (body.contains("recordCache"))
+                {
+                    m_configs["recordCache"] = body["recordCache"];
+                    applyRecordCacheConfig();
+                }
+
+                if (!sqlite_profile.is_null())
+                    m_configs["sqliteProfile"] = sqlite_profile;
+
                 // Create default time values
                 const std::time_t updated_t = time(nullptr);
                 std::tm* updated_tm = std::localtime(&updated_t);
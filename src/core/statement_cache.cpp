@@ -0,0 +1,207 @@
+#include "../../include/mantis/core/statement_cache.h"
+#include "../../include/mantis/core/logging.h"
+
+#define __file__ "core/statement_cache.cpp"
+
+namespace mantis
+{
+    CachedStatement::CachedStatement(StatementCache& cache,
+                                     const void* conn,
+                                     std::string key,
+                                     soci::statement& stmt,
+                                     bool& busy)
+        : m_cache(cache),
+          m_conn(conn),
+          m_key(std::move(key)),
+          m_stmt(stmt),
+          m_busy(&busy)
+    {
+        busy = true;
+    }
+
+    CachedStatement::CachedStatement(StatementCache& cache, std::unique_ptr<soci::statement> stmt)
+        : m_cache(cache),
+          m_conn(nullptr),
+          m_owned(std::move(stmt)),
+          m_stmt(*m_owned)
+    {
+    }
+
+    CachedStatement::~CachedStatement()
+    {
+        // One-off statements are simply destroyed
+        if (m_owned) return;
+
+        try
+        {
+            // Drain any pending rows so that the statement is no longer active,
+            // SQLite would otherwise hold on to the read snapshot of this connection.
+            while (m_stmt.fetch())
+            {
+            }
+
+            // Release the bound into/use elements, the next caller binds its own.
+            m_stmt.bind_clean_up();
+            *m_busy = false;
+        }
+        catch (const std::exception& e)
+        {
+            // Statement is in an unknown state, don't hand it out again
+            Log::trace("Evicting cached statement `{}`: {}", m_key, e.what());
+            m_cache.evict(m_conn, m_key);
+        }
+    }
+
+    void StatementCache::addPool(soci::connection_pool& pool, const size_t size)
+    {
+        std::lock_guard lock(m_mutex);
+        for (size_t i = 0; i < size; ++i)
+            m_sessions.push_back(&pool.at(i));
+    }
+
+    void StatementCache::addSession(soci::session& sql)
+    {
+        std::lock_guard lock(m_mutex);
+        m_sessions.push_back(&sql);
+    }
+
+    CachedStatement StatementCache::prepare(soci::session& sql,
+                                            const std::string& table,
+                                            const std::string& key,
+                                            const std::function<std::string()>& query)
+    {
+        const auto one_off = [&]
+        {
+            ++m_misses;
+            auto stmt = std::make_unique<soci::statement>(sql);
+            stmt->alloc();
+            stmt->prepare(query());
+            return CachedStatement(*this, std::move(stmt));
+        };
+
+        // Session does not come from any of our pools, we can't safely keep
+        // the statement around beyond this session's lifetime.
+        Connection* conn = connection(sql);
+        if (conn == nullptr) return one_off();
+
+        // Once a table has been invalidated, drop the stale statements of this connection.
+        // Only the thread holding the lease touches `conn->entries`.
+        if (const auto epoch = m_epoch.load(); conn->epoch != epoch)
+        {
+            std::erase_if(conn->entries, [&](const auto& item)
+            {
+                return !item.second.busy && item.second.version != version(item.second.table);
+            });
+            conn->epoch = epoch;
+        }
+
+        const auto full_key = table + "#" + key;
+        const auto current = version(table);
+
+        const auto it = conn->entries.find(full_key);
+        if (it != conn->entries.end())
+        {
+            // Same statement already in use further up this thread's stack
+            if (it->second.busy) return one_off();
+
+            if (it->second.version == current)
+            {
+                ++m_hits;
+                return CachedStatement(*this, conn->session->get_backend(), full_key,
+                                       *it->second.stmt, it->second.busy);
+            }
+
+            conn->entries.erase(it);
+        }
+
+        // Keep the number of statements per connection bounded
+        if (conn->entries.size() >= MAX_STATEMENTS_PER_CONNECTION) return one_off();
+
+        ++m_misses;
+
+        // Prepare against the pooled session itself, the leased session is only a
+        // short-lived handle and must not be referenced by the cached statement.
+        auto stmt = std::make_unique<soci::statement>(*conn->session);
+        stmt->alloc();
+        stmt->prepare(query());
+
+        auto& entry = conn->entries[full_key];
+        entry.stmt = std::move(stmt);
+        entry.table = table;
+        entry.version = current;
+
+        return CachedStatement(*this, conn->session->get_backend(), full_key, *entry.stmt, entry.busy);
+    }
+
+    void StatementCache::invalidate(const std::string& table)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            ++m_versions[table];
+        }
+        ++m_epoch;
+
+        Log::trace("Invalidated cached statements for table `{}`", table);
+    }
+
+    void StatementCache::clear()
+    {
+        std::lock_guard lock(m_mutex);
+        m_connections.clear();
+        m_sessions.clear();
+    }
+
+    json StatementCache::stats() const
+    {
+        return {
+            {"hits", m_hits.load()},
+            {"misses", m_misses.load()}
+        };
+    }
+
+    StatementCache::Connection* StatementCache::connection(soci::session& sql)
+    {
+        const void* backend = sql.get_backend();
+        if (backend == nullptr) return nullptr;
+
+        std::lock_guard lock(m_mutex);
+        if (const auto it = m_connections.find(backend); it != m_connections.end())
+            return it->second.get();
+
+        // First use of this connection, find the registered session sharing the backend
+        for (auto* registered : m_sessions)
+        {
+            if (registered->get_backend() == backend)
+            {
+                auto conn = std::make_unique<Connection>();
+                conn->session = registered;
+                conn->epoch = m_epoch.load();
+
+                auto* ptr = conn.get();
+                m_connections[backend] = std::move(conn);
+                return ptr;
+            }
+        }
+
+        return nullptr;
+    }
+
+    uint64_t StatementCache::version(const std::string& table) const
+    {
+        std::lock_guard lock(m_mutex);
+        const auto it = m_versions.find(table);
+        return it == m_versions.end() ? 0 : it->second;
+    }
+
+    void StatementCache::evict(const void* conn, const std::string& key)
+    {
+        Connection* slot = nullptr;
+        {
+            std::lock_guard lock(m_mutex);
+            if (const auto it = m_connections.find(conn); it != m_connections.end())
+                slot = it->second.get();
+        }
+
+        if (slot) slot->entries.erase(key);
+    }
+}
@@ -0,0 +1,205 @@
+#include "../../include/mantis/core/sync.h"
+#include "../../include/mantis/core/logging.h"
+#include "../../include/mantis/utils/utils.h"
+
+#include <algorithm>
+#include <format>
+
+#define __file__ "core/sync.cpp"
+
+namespace mantis
+{
+    namespace
+    {
+        constexpr auto PG_SYNC_FUNCTION = R"(
+CREATE OR REPLACE FUNCTION mantis_sync_log() RETURNS trigger AS $$
+DECLARE
+    next_seq BIGINT;
+BEGIN
+    INSERT INTO __sync_seq (name, seq) VALUES (TG_TABLE_NAME, 1)
+        ON CONFLICT (name) DO UPDATE SET seq = __sync_seq.seq + 1
+        RETURNING seq INTO next_seq;
+
+    IF TG_OP = 'DELETE' THEN
+        INSERT INTO __sync_log (table_name, record_id, seq, deleted, changed)
+            VALUES (TG_TABLE_NAME, OLD.id, next_seq, 1, to_char(LOCALTIMESTAMP, 'YYYY-MM-DD HH24:MI:SS'))
+            ON CONFLICT (table_name, record_id)
+            DO UPDATE SET seq = EXCLUDED.seq, deleted = 1, changed = EXCLUDED.changed;
+    ELSE
+        INSERT INTO __sync_log (table_name, record_id, seq, deleted, changed)
+            VALUES (TG_TABLE_NAME, NEW.id, next_seq, 0, NULL)
+            ON CONFLICT (table_name, record_id)
+            DO UPDATE SET seq = EXCLUDED.seq, deleted = 0, changed = NULL;
+    END IF;
+    RETURN NULL;
+END;
+$$ LANGUAGE plpgsql)";
+
+        /// `value` as an SQL string literal
+        std::string quoted(const std::string& value)
+        {
+            std::string out = "'";
+            for (const char c : value)
+            {
+                if (c == '\'') out.push_back('\'');
+                out.push_back(c);
+            }
+            out.push_back('\'');
+            return out;
+        }
+    }
+
+    void SyncLog::migrate(soci::session& sql)
+    {
+        const bool pg = isPostgres(sql);
+
+        sql << std::format("CREATE TABLE IF NOT EXISTS __sync_seq (name TEXT PRIMARY KEY, seq {} NOT NULL)",
+                           pg ? "BIGINT" : "INTEGER");
+        sql << std::format(
+            "CREATE TABLE IF NOT EXISTS __sync_log (table_name TEXT NOT NULL, record_id TEXT NOT NULL, "
+            "seq {} NOT NULL, deleted SMALLINT NOT NULL DEFAULT 0, changed TEXT, "
+            "PRIMARY KEY (table_name, record_id))", pg ? "BIGINT" : "INTEGER");
+
+        // Pulls scan a table's entries past a sequence number
+        sql << "CREATE INDEX IF NOT EXISTS __sync_log_seq ON __sync_log (table_name, seq)";
+
+        if (pg) sql << PG_SYNC_FUNCTION;
+    }
+
+    void SyncLog::track(soci::session& sql, const std::string& table)
+    {
+        int installed = 0;
+        if (isPostgres(sql))
+        {
+            sql << "SELECT COUNT(*) FROM pg_trigger WHERE tgname = 'mantis_sync' AND tgrelid = CAST(:t AS regclass)",
+                soci::use(table), soci::into(installed);
+            if (installed > 0) return;
+
+            sql << std::format("CREATE TRIGGER mantis_sync AFTER INSERT OR UPDATE OR DELETE ON {} "
+                               "FOR EACH ROW EXECUTE PROCEDURE mantis_sync_log()", table);
+        }
+        else
+        {
+            const auto name = "mantis_sync_insert_" + table;
+            sql << "SELECT COUNT(*) FROM sqlite_master WHERE type = 'trigger' AND name = :name",
+                soci::use(name), soci::into(installed);
+            if (installed > 0) return;
+
+            for (const auto& trigger : sqliteTriggers(table))
+                sql << trigger;
+        }
+
+        // Records written before the log existed, pulled by clients starting from scratch
+        sql << std::format("INSERT INTO __sync_log (table_name, record_id, seq, deleted) "
+                           "SELECT {}, id, 1, 0 FROM {} WHERE true "
+                           "ON CONFLICT (table_name, record_id) DO NOTHING", quoted(table), table);
+        sql << "INSERT INTO __sync_seq (name, seq) VALUES (:name, 1) ON CONFLICT (name) DO NOTHING",
+            soci::use(table);
+    }
+
+    void SyncLog::rename(soci::session& sql, const std::string& from, const std::string& to)
+    {
+        // SQLite triggers name the table in their body, PostgreSQL's read it at runtime
+        if (!isPostgres(sql))
+        {
+            dropSqliteTriggers(sql, from);
+            for (const auto& trigger : sqliteTriggers(to))
+                sql << trigger;
+        }
+
+        sql << "UPDATE __sync_log SET table_name = :to WHERE table_name = :from", soci::use(to), soci::use(from);
+        sql << "UPDATE __sync_seq SET name = :to WHERE name = :from", soci::use(to), soci::use(from);
+    }
+
+    void SyncLog::untrack(soci::session& sql, const std::string& table)
+    {
+        if (isPostgres(sql)) sql << std::format("DROP TRIGGER IF EXISTS mantis_sync ON {}", table);
+        else dropSqliteTriggers(sql, table);
+
+        sql << "DELETE FROM __sync_log WHERE table_name = :t", soci::use(table);
+        sql << "DELETE FROM __sync_seq WHERE name = :t", soci::use(table);
+    }
+
+    std::vector<SyncLog::Entry> SyncLog::changesSince(soci::session& sql, const std::string& table,
+                                                      const int64_t since, const int limit)
+    {
+        std::vector<Entry> entries;
+
+        Entry entry;
+        long long seq = 0;
+        int deleted = 0;
+        soci::statement st = (sql.prepare <<
+            "SELECT record_id, seq, deleted FROM __sync_log WHERE table_name = :t AND seq > :since "
+            "ORDER BY seq LIMIT :lim",
+            soci::use(table), soci::use(static_cast<long long>(since)), soci::use(limit),
+            soci::into(entry.id), soci::into(seq), soci::into(deleted));
+        st.execute();
+
+        while (st.fetch())
+        {
+            entry.seq = seq;
+            entry.deleted = deleted != 0;
+            entries.push_back(entry);
+        }
+
+        return entries;
+    }
+
+    std::string SyncLog::deletedAt(soci::session& sql, const std::string& table, const std::string& id)
+    {
+        std::string changed;
+        soci::indicator ind = soci::i_null;
+        sql << "SELECT changed FROM __sync_log WHERE table_name = :t AND record_id = :id AND deleted = 1",
+            soci::use(table), soci::use(id), soci::into(changed, ind);
+
+        return sql.got_data() && ind == soci::i_ok ? changed : "";
+    }
+
+    std::string SyncLog::pushedTime(const std::string& value, const std::string& now)
+    {
+        if (value.empty()) return "";
+
+        std::string updated;
+        try { updated = tmToStr(strToTM(value)); }
+        catch (const std::exception&) { return ""; }
+
+        // Same format both, compared as strings
+        return std::min(updated, now);
+    }
+
+    std::vector<std::string> SyncLog::sqliteTriggers(const std::string& table)
+    {
+        const auto name = quoted(table);
+        const auto trigger = [&](const std::string& event, const std::string& row, const bool deleted)
+        {
+            return std::format(
+                "CREATE TRIGGER IF NOT EXISTS mantis_sync_{0}_{1} AFTER {2} ON {1} BEGIN "
+                "INSERT INTO __sync_seq (name, seq) VALUES ({3}, 1) ON CONFLICT (name) DO UPDATE SET seq = seq + 1; "
+                "INSERT INTO __sync_log (table_name, record_id, seq, deleted, changed) "
+                "VALUES ({3}, {4}.id, (SELECT seq FROM __sync_seq WHERE name = {3}), {5}, {6}) "
+                "ON CONFLICT (table_name, record_id) "
+                "DO UPDATE SET seq = excluded.seq, deleted = excluded.deleted, changed = excluded.changed; "
+                "END",
+                event == "INSERT" ? "insert" : event == "UPDATE" ? "update" : "delete",
+                table, event, name, row, deleted ? 1 : 0,
+                deleted ? "datetime('now', 'localtime')" : "NULL");
+        };
+
+        return {
+            trigger("INSERT", "NEW", false),
+            trigger("UPDATE", "NEW", false),
+            trigger("DELETE", "OLD", true)
+        };
+    }
+
+    void SyncLog::dropSqliteTriggers(soci::session& sql, const std::string& table)
+    {
+        for (const auto event : {"insert", "update", "delete"})
+            sql << std::format("DROP TRIGGER IF EXISTS mantis_sync_{}_{}", event, table);
+    }
+
+    bool SyncLog::isPostgres(soci::session& sql)
+    {
+        return sql.get_backend_name() == "postgresql";
+    }
+}
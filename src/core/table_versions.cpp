@@ -0,0 +1,36 @@
+#include "../../include/mantis/core/table_versions.h"
+#include "../../include/mantis/utils/utils.h"
+
+#include <format>
+
+#define __file__ "core/table_versions.cpp"
+
+namespace mantis
+{
+    TableVersions::TableVersions()
+        : m_epoch(generateShortId(8))
+    {
+    }
+
+    std::string TableVersions::tag(const std::string& table) const
+    {
+        uint64_t version = 0;
+        {
+            std::lock_guard lock(m_mutex);
+            if (const auto it = m_versions.find(table); it != m_versions.end()) version = it->second;
+        }
+
+        return std::format("{}.{}.{}", m_epoch, m_global.load(), version);
+    }
+
+    void TableVersions::bump(const std::string& table)
+    {
+        std::lock_guard lock(m_mutex);
+        ++m_versions[table];
+    }
+
+    void TableVersions::bumpAll()
+    {
+        ++m_global;
+    }
+}
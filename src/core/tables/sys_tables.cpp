@@ -598,14 +598,10 @@ namespace mantis
         // the session context, queried by:
         //  ` req.get<json>("auth").value("id", ""); // returns the user ID
         //  ` req.get<json>("auth").value("name", ""); // returns the user's name
-        auto sql = MantisApp::instance().db().session();
-
-        soci::row admin_row;
-        *sql << "SELECT id, email, created, updated FROM __admins WHERE id = :id LIMIT 1",
-        soci::use(auth_user_id), soci::into(admin_row);
+        const auto admin = principal("__admins", auth_user_id);
 
         // Return 404 if user was not found
-        if (!sql->got_data())
+        if (!admin.has_value())
         {
             json response;
             response["status"] = 404;
@@ -621,23 +617,10 @@ namespace mantis
             // Populate the auth object with additional data from the database
             // remove `password` field if available
             json user;
-            user["id"] = admin_row.get<std::string>(0);
-            user["email"] = admin_row.get<std::string>(1);
-
-            // Handle date parsing, SQLITE uses `string` type
-            if (admin_row.get_properties(2).get_db_type() == soci::db_date)
-            {
-                auto t = admin_row.get<std::tm>(2);
-                user["created"] = tmToStr(t);
-
-                t = admin_row.get<std::tm>(3);
-                user["updated"] = tmToStr(t);
-            }
-            else
-            {
-                user["created"] = admin_row.get<std::string>(2);
-                user["updated"] = admin_row.get<std::string>(3);
-            }
+            user["id"] = admin->at("id");
+            user["email"] = admin->at("email");
+            user["created"] = admin->at("created");
+            user["updated"] = admin->at("updated");
 
             // Enrich auth object with auth information
             auth["type"] = "user";
@@ -7,6 +7,7 @@
 #include "../../../include/mantis/utils/utils.h"
 #include "../../../include/mantis/core/fileunit.h"
 #include "../../../include/mantis/core/router.h"
+#include "../../../include/mantis/core/sync.h"
 
 #include <soci/soci.h>
 #include <private/soci-mktime.h>
@@ -25,6 +26,9 @@ namespace mantis
             const auto type = entity.value("type", "");
             const auto has_api = entity.value("has_api", true);
             const auto fields = entity.value("fields", json::array());
+            const auto indexes = entity.value("indexes", json::array());
+            const auto idStrategy = entity.value("idStrategy", "random");
+            const auto sync = entity.value("sync", json(false));
 
             // Update rules in the individual table types
             const auto addRule = entity.value("addRule", "");
@@ -33,6 +37,20 @@ namespace mantis
             const auto updateRule = entity.value("updateRule", "");
             const auto deleteRule = entity.value("deleteRule", "");
 
+            if (!isValidIdStrategy(idStrategy))
+            {
+                result["error"] = "Unknown id strategy '" + idStrategy + "'";
+                result["status"] = 400;
+                return result;
+            }
+
+            if (!sync.is_boolean())
+            {
+                result["error"] = "Expected `sync` to be a boolean";
+                result["status"] = 400;
+                return result;
+            }
+
             // Hash the name for the ID
             std::string id = generateTableId(name);
 
@@ -52,11 +70,8 @@ namespace mantis
             std::time_t t = time(nullptr);
             std::tm* created_tm = std::localtime(&t);
 
-            // Database session & transaction instance
-            auto sql = MantisApp::instance().db().session();
-            soci::transaction tr(*sql);
-
             std::string schema_str, table_ddl;
+            std::vector<std::string> table_indexes;
             std::vector<Field> new_fields, rules_fields;
 
             for (const auto& field : fields)
@@ -89,10 +104,15 @@ namespace mantis
                     return result;
                 }
 
-                Field f{_name, _type.value(), _required, _primaryKey, _system};
+                Field f{_name, _type.value(), _required, _primaryKey, _system,
+                        json{{"indexed", field.value("indexed", false)}}};
                 new_fields.push_back(f);
             }
 
+            std::vector<Index> new_indexes;
+            for (const auto& index : indexes)
+                new_indexes.push_back(Index::from_json(index, name));
+
             if (type == "auth")
             {
                 AuthTable auth;
@@ -112,9 +132,13 @@ namespace mantis
                     if (fieldExists(auth.type, field.name)) continue;
                     auth.fields.push_back(field);
                 }
+                auth.indexes = new_indexes;
+                auth.idStrategy = idStrategy;
+                auth.sync = sync.get<bool>();
 
                 schema_str = auth.to_json().dump();
                 table_ddl = auth.to_sql();
+                table_indexes = auth.to_index_sql();
             }
             else if (type == "view")
             {
@@ -160,9 +184,13 @@ namespace mantis
                     if (fieldExists(base.type, field.name)) continue;
                     base.fields.push_back(field);
                 }
+                base.indexes = new_indexes;
+                base.idStrategy = idStrategy;
+                base.sync = sync.get<bool>();
 
                 schema_str = base.to_json().dump();
                 table_ddl = base.to_sql();
+                table_indexes = base.to_index_sql();
             }
 
             // Execute DDL & Save to DB
@@ -171,16 +199,31 @@ namespace mantis
 
             try
             {
-                // Insert to __tables
-                *sql <<
-                    "INSERT INTO __tables (id, name, type, has_api, schema, created, updated) VALUES (:id, :name, :type, :has_api, :schema, :created, :updated)"
-                    ,
-                    soci::use(id), soci::use(name), soci::use(type), soci::use(has_api),
-                    soci::use(schema_str), soci::use(*created_tm), soci::use(*created_tm);
+                MantisApp::instance().db().write([&](soci::session& sql)
+                {
+                    // Insert to __tables
+                    sql <<
+                        "INSERT INTO __tables (id, name, type, has_api, schema, created, updated) VALUES (:id, :name, :type, :has_api, :schema, :created, :updated)"
+                        ,
+                        soci::use(id), soci::use(name), soci::use(type), soci::use(has_api),
+                        soci::use(schema_str), soci::use(*created_tm), soci::use(*created_tm);
+
+                    // Create actual SQL table
+                    sql << table_ddl;
+                    for (const auto& index_ddl : table_indexes)
+                        sql << index_ddl;
+
+                    // Publish the table's record changes, @see ChangeFeed
+                    if (type != "view")
+                    {
+                        for (const auto& capture_ddl : MantisApp::instance().db().changes().captureSql(name))
+                            sql << capture_ddl;
 
-                // Create actual SQL table
-                *sql << table_ddl;
-                tr.commit();
+                        // Log the table's changes for incremental sync if enabled, @see SyncLog
+                        if (sync.get<bool>()) SyncLog::track(sql, name);
+                    }
+                    return true;
+                });
 
                 json obj;
                 obj["id"] = id;
@@ -206,15 +249,11 @@ namespace mantis
             }
             catch (const soci::soci_error& e)
             {
-                tr.rollback();
-
                 result["error"] = e.what();
                 result["status"] = 500;
                 return result;
             } catch (const std::exception& e)
             {
-                tr.rollback();
-
                 result["error"] = e.what();
                 result["status"] = 500;
                 return result;
@@ -222,6 +261,13 @@ namespace mantis
 
             return result;
         }
+        catch (const std::invalid_argument& e)
+        {
+            // Malformed index definitions
+            result["error"] = e.what();
+            result["status"] = 400;
+            return result;
+        }
         catch (std::exception& e)
         {
             Log::critical("SysTablesUnit::SysTablesUnit: {}", e.what());
@@ -262,372 +308,506 @@ namespace mantis
 
     json SysTablesUnit::update(const std::string& id, const json& entity, const json& opts)
     {
-        const auto sql = MantisApp::instance().db().session();
-        soci::transaction tr(*sql);
         json response;
         response["data"] = json::object();
         response["error"] = "";
 
+        // Reject rules that don't compile, before touching the table
+        if (const auto invalid = validateRules(entity); invalid.has_value())
+            return invalid.value();
+
         try
         {
-            // Get Original Object
-            soci::row rw;
-            *sql << "SELECT id,name,type,schema,has_api FROM __tables WHERE id = :id", soci::use(id), soci::into(rw);
+            // Table state, as read & updated within the write job
+            std::string t_id, t_name, t_type, old_name, old_type;
 
-            if (!sql->got_data())
+            const auto committed = MantisApp::instance().db().write([&](soci::session& writer)
             {
-                response["error"] = "Table with that ID was not found!";
-                return response;
-            }
-
-            // Old data ...
-            auto t_id = rw.get<std::string>(0);
-            auto t_name = rw.get<std::string>(1);
-            auto t_type = rw.get<std::string>(2);
-            auto t_schema = rw.get<json>(3);
-            auto t_has_api = rw.get<bool>(4);
-            std::vector<json> t_fields = t_schema.value("fields", json::array());
+                const auto sql = &writer;
 
-            // Just hold this name for later
-            const auto old_name = t_name;
-            const auto old_type = t_type;
+                // Get Original Object
+                soci::row rw;
+                *sql << "SELECT id,name,type,schema,has_api FROM __tables WHERE id = :id", soci::use(id), soci::into(rw);
 
-            // For now, we don't support changing types
-            if (entity.contains("type") && t_type != entity["type"].get<std::string>())
-            {
-                response["error"] = "Changing table types is not supported yet!";
-                return response;
-            }
-
-            // Delete fields ...
-            if (const auto delFields = entity.value("deletedFields", std::vector<std::string>{}); !delFields.empty())
-            {
-                std::vector<std::string> sys_fields{};
+                if (!sql->got_data())
+                {
+                    response["error"] = "Table with that ID was not found!";
+                    return false;
+                }
 
-                // Drop all columns in this segment ...
-                for (const auto& field_name : delFields)
+                // Old data ...
+                t_id = rw.get<std::string>(0);
+                t_name = rw.get<std::string>(1);
+                t_type = rw.get<std::string>(2);
+                auto t_schema = rw.get<json>(3);
+                auto t_has_api = rw.get<bool>(4);
+                std::vector<json> t_fields = t_schema.value("fields", json::array());
+
+                // Indexes as declared before this update, diffed against the updated schema below
+                const auto old_indexes = Table::schemaIndexes(t_schema);
+                auto t_indexes = entity.contains("indexes")
+                                     ? entity["indexes"]
+                                     : t_schema.value("indexes", json::array());
+
+                const auto indexes_column = [](const json& index, const std::string& column)
                 {
-                    // Skip empty fields ..
-                    if (trim(field_name).empty())
+                    const auto columns = index.value("columns", json::array());
+                    return std::ranges::any_of(columns, [&](const json& c)
                     {
-                        response["error"] = "Field name can't be empty!";
-                        response["status"] = 400;
-                        return response;
-                    };
+                        return c.is_string() && (c == column || c == "-" + column);
+                    });
+                };
 
-                    // We can't drop system fields here, so, lets check for that ...
-                    if (t_type == "base") sys_fields = baseFields;
-                    else if (t_type == "auth") sys_fields = authFields;
-                    // For views, ignore ...
+                // Just hold this name for later
+                old_name = t_name;
+                old_type = t_type;
 
-                    // If the field exists in system types, ignore it
-                    if (std::find(sys_fields.begin(), sys_fields.end(), field_name) != sys_fields.end())
-                        continue;
+                // For now, we don't support changing types
+                if (entity.contains("type") && t_type != entity["type"].get<std::string>())
+                {
+                    response["error"] = "Changing table types is not supported yet!";
+                    return false;
+                }
 
-                    // If the field is valid, generate drop colum statement and execute!
-                    *sql << sql->get_backend()->drop_column(t_name, trim(field_name));
+                // Delete fields ...
+                if (const auto delFields = entity.value("deletedFields", std::vector<std::string>{}); !delFields.empty())
+                {
+                    std::vector<std::string> sys_fields{};
 
-                    // Log::trace("Fields array size before removing {} = {}", field_name, t_fields.size());
-                    // Remove the field from the array as well.
-                    t_fields.erase(std::remove_if(t_fields.begin(), t_fields.end(), [&](const auto& field)
+                    // Drop all columns in this segment ...
+                    for (const auto& field_name : delFields)
                     {
-                        return field.value("name", "") == trim(field_name);
-                    }));
-                    // Log::trace("Fields array size after removing {} = {}", field_name, t_fields.size());
-                }
-            }
+                        // Skip empty fields ..
+                        if (trim(field_name).empty())
+                        {
+                            response["error"] = "Field name can't be empty!";
+                            response["status"] = 400;
+                            return false;
+                        };
+
+                        // We can't drop system fields here, so, lets check for that ...
+                        if (t_type == "base") sys_fields = baseFields;
+                        else if (t_type == "auth") sys_fields = authFields;
+                        // For views, ignore ...
+
+                        // If the field exists in system types, ignore it
+                        if (std::find(sys_fields.begin(), sys_fields.end(), field_name) != sys_fields.end())
+                            continue;
+
+                        // SQLite won't drop indexed columns, drop the indexes on it first, along with their
+                        // definitions; partial indexes comparing it in their condition as well
+                        std::vector<std::string> dropped;
+                        for (const auto& index : old_indexes)
+                        {
+                            if (!index.references(trim(field_name))) continue;
+                            *sql << "DROP INDEX IF EXISTS " + index.name;
+                            dropped.push_back(index.name);
+                        }
+                        t_indexes.erase(std::remove_if(t_indexes.begin(), t_indexes.end(), [&](const json& index)
+                        {
+                            return indexes_column(index, trim(field_name))
+                                || std::ranges::find(dropped, Index::from_json(index, t_name).name) != dropped.end();
+                        }), t_indexes.end());
 
-            for (const auto& field : entity.value("fields", std::vector<json>{}))
-            {
-                // Log::trace("Field: {}", field.value("name", ""), field.dump());
+                        // If the field is valid, generate drop colum statement and execute!
+                        *sql << sql->get_backend()->drop_column(t_name, trim(field_name));
 
-                // Ensure field name is provided, if not so, throw an error!
-                const auto field_name = field.value("name", "");
-                if (field_name.empty())
-                {
-                    response["error"] = "Field name can't be empty!";
-                    return response;
+                        // Log::trace("Fields array size before removing {} = {}", field_name, t_fields.size());
+                        // Remove the field from the array as well.
+                        t_fields.erase(std::remove_if(t_fields.begin(), t_fields.end(), [&](const auto& field)
+                        {
+                            return field.value("name", "") == trim(field_name);
+                        }));
+                        // Log::trace("Fields array size after removing {} = {}", field_name, t_fields.size());
+                    }
                 }
 
-                auto isSystemGeneratedField = [&]() -> bool
+                for (const auto& field : entity.value("fields", std::vector<json>{}))
                 {
-                    // For views, skip all fields ...
-                    if (t_type == "view") return true;
+                    // Log::trace("Field: {}", field.value("name", ""), field.dump());
 
-                    // Let's skip all system generated fields
-                    if (field_name == "id" || field_name == "created" || field_name == "updated")
-                        return true;
+                    // Ensure field name is provided, if not so, throw an error!
+                    const auto field_name = field.value("name", "");
+                    if (field_name.empty())
+                    {
+                        response["error"] = "Field name can't be empty!";
+                        return false;
+                    }
 
-                    if (t_type == "auth")
+                    auto isSystemGeneratedField = [&]() -> bool
                     {
-                        if (field_name == "email" || field_name == "password" || field_name == "name")
+                        // For views, skip all fields ...
+                        if (t_type == "view") return true;
+
+                        // Let's skip all system generated fields
+                        if (field_name == "id" || field_name == "created" || field_name == "updated")
                             return true;
-                    }
 
-                    return false;
-                };
+                        if (t_type == "auth")
+                        {
+                            if (field_name == "email" || field_name == "password" || field_name == "name")
+                                return true;
+                        }
 
-                if (isSystemGeneratedField()) continue;
+                        return false;
+                    };
 
-                std::string search_field_name = field_name;
+                    if (isSystemGeneratedField()) continue;
 
-                Log::trace("Field: {}", field.dump());
+                    std::string search_field_name = field_name;
 
-                // If old_name is set, let's use it to search
-                if (field.contains("old_name") && !field["old_name"].is_null() && !field["old_name"].empty())
-                {
-                    search_field_name = field["old_name"].get<std::string>();
-                    Log::trace("Old Field Name: {}\t New Field: {}", field_name, search_field_name);
-                }
+                    Log::trace("Field: {}", field.dump());
 
-                int found_index = -1, i = 0;
-                for (const auto& t_field_i : t_fields)
-                {
-                    // Log::trace("Field: {}", _field.dump());
-                    if (t_field_i.value("name", "") == search_field_name)
+                    // If old_name is set, let's use it to search
+                    if (field.contains("old_name") && !field["old_name"].is_null() && !field["old_name"].empty())
                     {
-                        found_index = i;
-                        break;
+                        search_field_name = field["old_name"].get<std::string>();
+                        Log::trace("Old Field Name: {}\t New Field: {}", field_name, search_field_name);
                     }
-                    i++;
-                }
-
-                // If we didn't find any matching field, then, lets treat it like a new
-                // field. We shall create a new Field object and alter the table structure.
-                if (found_index == -1)
-                {
-                    json field_opts;
-                    if (field.contains("autoGeneratePattern") && !field["autoGeneratePattern"].is_null())
-                        field_opts["autoGeneratePattern"] = field.value("autoGeneratePattern", "");
 
-                    if (field.contains("defaultValue"))
-                        field_opts["defaultValue"] = field["defaultValue"].is_null() ? nullptr : field["defaultValue"];
+                    int found_index = -1, i = 0;
+                    for (const auto& t_field_i : t_fields)
+                    {
+                        // Log::trace("Field: {}", _field.dump());
+                        if (t_field_i.value("name", "") == search_field_name)
+                        {
+                            found_index = i;
+                            break;
+                        }
+                        i++;
+                    }
 
-                    if (field.contains("maxValue"))
-                        field_opts["maxValue"] = field["defaultValue"].is_null() ? nullptr : field["maxValue"];
+                    // If we didn't find any matching field, then, lets treat it like a new
+                    // field. We shall create a new Field object and alter the table structure.
+                    if (found_index == -1)
+                    {
+                        json field_opts;
+                        if (field.contains("autoGeneratePattern") && !field["autoGeneratePattern"].is_null())
+                            field_opts["autoGeneratePattern"] = field.value("autoGeneratePattern", "");
 
-                    if (field.contains("minValue"))
-                        field_opts["minValue"] = field["minValue"].is_null() ? nullptr : field["minValue"];
+                        if (field.contains("defaultValue"))
+                            field_opts["defaultValue"] = field["defaultValue"].is_null() ? nullptr : field["defaultValue"];
 
-                    if (field.contains("validator"))
-                        field_opts["validator"] = field["validator"].is_null() ? nullptr : field["validator"];
+                        if (field.contains("maxValue"))
+                            field_opts["maxValue"] = field["defaultValue"].is_null() ? nullptr : field["maxValue"];
 
+                        if (field.contains("minValue"))
+                            field_opts["minValue"] = field["minValue"].is_null() ? nullptr : field["minValue"];
 
-                    if (field.contains("unique") && !field["unique"].is_null())
-                        field_opts["unique"] = field.value("unique", false);
+                        if (field.contains("validator"))
+                            field_opts["validator"] = field["validator"].is_null() ? nullptr : field["validator"];
 
-                    // Extract field data
-                    auto field_primaryKey = field.value("primaryKey", false);
-                    auto field_required = field.value("required", false);
-                    auto field_system = false;
-                    auto field_typeStr = field.value("type", "");
-                    auto field_unique = field.value("unique", false);
-                    const auto field_type = getFieldType(field_typeStr);
 
-                    // Ensure field type is provided
-                    if (!field_type.has_value())
-                    {
-                        response["error"] = "Field type for " + field_name + " is required!";
-                        return response;
-                    }
+                        if (field.contains("unique") && !field["unique"].is_null())
+                            field_opts["unique"] = field.value("unique", false);
 
-                    // Create field item ...
-                    Field f{field_name, field_type.value(), field_required, field_primaryKey, field_system, field_opts};
-                    t_fields.push_back(f.to_json());
+                        if (field.contains("indexed") && !field["indexed"].is_null())
+                            field_opts["indexed"] = field.value("indexed", false);
 
-                    // Execute SQL to create the column (field)
-                    std::string query = sql->get_backend()->add_column(t_name, field_name, f.toSociType(), 0, 0);
-                    query += field_required ? " NOT NULL" : ""; // Add Not Null constraint
-                    *sql << query;
+                        // Extract field data
+                        auto field_primaryKey = field.value("primaryKey", false);
+                        auto field_required = field.value("required", false);
+                        auto field_system = false;
+                        auto field_typeStr = field.value("type", "");
+                        auto field_unique = field.value("unique", false);
+                        const auto field_type = getFieldType(field_typeStr);
 
-                    // Add unique constraint to the created column
-                    if (field_unique)
-                        *sql << "ALTER TABLE " + t_name + " ADD " + sql->get_backend()->constraint_unique(
-                            "unique_" + field_name, field_name);
-                }
-                else
-                {
-                    // Get the found json object, we'll use it to update data before dumping it back.
-                    auto old_field = t_fields.at(found_index);
+                        // Ensure field type is provided
+                        if (!field_type.has_value())
+                        {
+                            response["error"] = "Field type for " + field_name + " is required!";
+                            return false;
+                        }
 
-                    if (field.contains("autoGeneratePattern"))
-                        old_field["autoGeneratePattern"] = field["autoGeneratePattern"];
+                        // Create field item ...
+                        Field f{field_name, field_type.value(), field_required, field_primaryKey, field_system, field_opts};
+                        t_fields.push_back(f.to_json());
 
-                    if (field.contains("defaultValue"))
-                        old_field["defaultValue"] = field["defaultValue"];
+                        // Execute SQL to create the column (field)
+                        std::string query = sql->get_backend()->add_column(t_name, field_name, f.toSociType(), 0, 0);
+                        query += field_required ? " NOT NULL" : ""; // Add Not Null constraint
+                        *sql << query;
 
-                    if (field.contains("maxValue"))
-                        old_field["maxValue"] = field["maxValue"];
+                        // Add unique constraint to the created column
+                        if (field_unique)
+                            *sql << "ALTER TABLE " + t_name + " ADD " + sql->get_backend()->constraint_unique(
+                                "unique_" + field_name, field_name);
+                    }
+                    else
+                    {
+                        // Get the found json object, we'll use it to update data before dumping it back.
+                        auto old_field = t_fields.at(found_index);
 
-                    if (field.contains("minValue"))
-                        old_field["minValue"] = field["minValue"];
+                        if (field.contains("autoGeneratePattern"))
+                            old_field["autoGeneratePattern"] = field["autoGeneratePattern"];
 
-                    if (field.contains("validator"))
-                        old_field["validator"] = field["validator"];
+                        if (field.contains("defaultValue"))
+                            old_field["defaultValue"] = field["defaultValue"];
 
-                    if (field.contains("unique"))
-                    {
-                        const auto is_unique = field.value("unique", false);
-                        old_field["unique"] = is_unique;
+                        if (field.contains("maxValue"))
+                            old_field["maxValue"] = field["maxValue"];
 
-                        if (is_unique)
-                        {
-                            *sql << ("ALTER TABLE " + t_name + " ADD " + sql->get_backend()->constraint_unique(
-                                "unique_" + field_name, field_name));
-                        }
+                        if (field.contains("minValue"))
+                            old_field["minValue"] = field["minValue"];
 
-                        // Removing unique constraint is database specific
-                        // TODO look into removing unique constraint later
-                    }
+                        if (field.contains("validator"))
+                            old_field["validator"] = field["validator"];
 
-                    if (field.contains("new_name"))
-                    {
-                        const auto new_name = field.value("new_name", "");
-                        old_field["name"] = new_name;
+                        if (field.contains("indexed"))
+                            old_field["indexed"] = field["indexed"];
 
-                        if (new_name.empty())
+                        if (field.contains("unique"))
                         {
-                            tr.rollback();
-                            response["error"] = "Field new_name can't be empty!";
-                            return response;
-                        }
+                            const auto is_unique = field.value("unique", false);
+                            old_field["unique"] = is_unique;
 
-                        // TODO maybe check that the table name doesn't exist yet, but, the db will throw an error
-
-                        std::string backend_name = sql->get_backend()->get_backend_name();
-                        std::string rename_sql = "ALTER TABLE ";
-                        rename_sql.append(t_name).append(" RENAME COLUMN ").append(field_name).append(" TO ").append(
-                            new_name);
+                            if (is_unique)
+                            {
+                                *sql << ("ALTER TABLE " + t_name + " ADD " + sql->get_backend()->constraint_unique(
+                                    "unique_" + field_name, field_name));
+                            }
 
-                        // Execute rename SQL query
-                        *sql << rename_sql;
-                    }
+                            // Removing unique constraint is database specific
+                            // TODO look into removing unique constraint later
+                        }
 
-                    if (field.contains("type"))
-                    {
-                        const auto t = old_field.value("type", "");
-                        // Only if the field type is changed, avoid throwing errors for unchanged types
-                        if (t != field.value("type", ""))
+                        if (field.contains("new_name"))
                         {
-                            // SQLite does not support this type changes, for now, maybe look at it later
-                            // TODO ..
-                            if (sql->get_backend_name() == "sqlite3")
+                            const auto new_name = field.value("new_name", "");
+                            old_field["name"] = new_name;
+
+                            if (new_name.empty())
                             {
-                                response["error"] = "Changing column type not supported in SQLite databases yet!";
-                                response["status"] = 500;
-                                return response;
+                                response["error"] = "Field new_name can't be empty!";
+                                return false;
                             }
 
-                            if (t.empty())
+                            // TODO maybe check that the table name doesn't exist yet, but, the db will throw an error
+
+                            std::string backend_name = sql->get_backend()->get_backend_name();
+                            std::string rename_sql = "ALTER TABLE ";
+                            rename_sql.append(t_name).append(" RENAME COLUMN ").append(field_name).append(" TO ").append(
+                                new_name);
+
+                            // Execute rename SQL query
+                            *sql << rename_sql;
+
+                            // The database renames indexed columns, keep the index definitions in line
+                            for (auto& index : t_indexes)
                             {
-                                tr.rollback();
-                                response["error"] = "Field type for " + field_name + " can't be empty!";
-                                return response;
+                                if (!index.contains("columns") || !index["columns"].is_array()) continue;
+                                for (auto& column : index["columns"])
+                                {
+                                    if (column == field_name) column = new_name;
+                                    else if (column == "-" + field_name) column = "-" + new_name;
+                                }
                             }
+                        }
 
-                            auto f_type = getFieldType(old_field.at("type").get<std::string>());
-                            if (!f_type.has_value())
+                        if (field.contains("type"))
+                        {
+                            const auto t = old_field.value("type", "");
+                            // Only if the field type is changed, avoid throwing errors for unchanged types
+                            if (t != field.value("type", ""))
                             {
-                                tr.rollback();
-                                response["error"] = "Unsupported field type for column " + field_name + "!";
-                                return response;
+                                // SQLite does not support this type changes, for now, maybe look at it later
+                                // TODO ..
+                                if (sql->get_backend_name() == "sqlite3")
+                                {
+                                    response["error"] = "Changing column type not supported in SQLite databases yet!";
+                                    response["status"] = 500;
+                                    return false;
+                                }
+
+                                if (t.empty())
+                                {
+                                        response["error"] = "Field type for " + field_name + " can't be empty!";
+                                    return false;
+                                }
+
+                                auto f_type = getFieldType(old_field.at("type").get<std::string>());
+                                if (!f_type.has_value())
+                                {
+                                        response["error"] = "Unsupported field type for column " + field_name + "!";
+                                    return false;
+                                }
+
+                                // TODO test on all database types
+                                // Fails on SQLite?
+                                Log::trace("Attempt to change column type ...");
+
+                                // Update field data type in our json object ...
+                                old_field["type"] = t;
+                                sql->alter_column(
+                                    t_name,
+                                    old_field.at("name").get<std::string>(),
+                                    Field::toSociType(f_type.value()));
                             }
+                        }
 
-                            // TODO test on all database types
-                            // Fails on SQLite?
-                            Log::trace("Attempt to change column type ...");
+                        auto _type = getFieldType(old_field.value("type", ""));
+                        if (!_type.has_value())
+                        {
+                            Log::critical("Error parsing field type of {} in {}", old_field.value("type", ""), field_name);
 
-                            // Update field data type in our json object ...
-                            old_field["type"] = t;
-                            sql->alter_column(
-                                t_name,
-                                old_field.at("name").get<std::string>(),
-                                Field::toSociType(f_type.value()));
+                            response["error"] = "Error parsing field type!";
+                            return false;
                         }
+
+                        // Create new field object with the updated data then dump it back to the `t_fields` array.
+                        Field f{
+                            old_field.at("name").get<std::string>(),
+                            _type.value(),
+                            old_field.value("required", false),
+                            old_field.value("primaryKey", false),
+                            false,
+                            old_field
+                        };
+
+                        // Replace field in place in the array
+                        t_fields[found_index] = f.to_json();
                     }
+                }
 
-                    auto _type = getFieldType(old_field.value("type", ""));
-                    if (!_type.has_value())
-                    {
-                        tr.rollback();
-                        Log::critical("Error parsing field type of {} in {}", old_field.value("type", ""), field_name);
+                // Update has_api field ...
+                if (entity.contains("has_api"))
+                {
+                    t_has_api = entity.at("has_api").get<bool>();
+                    t_schema["has_api"] = t_has_api;
+                }
 
-                        response["error"] = "Error parsing field type!";
-                        return response;
+                // Only affects records created from now on
+                if (entity.contains("idStrategy") && t_type != "view")
+                {
+                    const auto strategy = entity.value("idStrategy", "");
+                    if (!isValidIdStrategy(strategy))
+                    {
+                        response["error"] = "Unknown id strategy '" + strategy + "'";
+                        response["status"] = 400;
+                        return false;
                     }
 
-                    // Create new field object with the updated data then dump it back to the `t_fields` array.
-                    Field f{
-                        old_field.at("name").get<std::string>(),
-                        _type.value(),
-                        old_field.value("required", false),
-                        old_field.value("primaryKey", false),
-                        false,
-                        old_field
-                    };
+                    t_schema["idStrategy"] = strategy;
+                }
 
-                    // Replace field in place in the array
-                    t_fields[found_index] = f.to_json();
+                // Install or drop the sync log triggers as sync is switched on or off
+                if (entity.contains("sync") && t_type != "view")
+                {
+                    if (!entity["sync"].is_boolean())
+                    {
+                        response["error"] = "Expected `sync` to be a boolean";
+                        response["status"] = 400;
+                        return false;
+                    }
+
+                    if (const auto sync = entity["sync"].get<bool>(); sync != t_schema.value("sync", false))
+                    {
+                        if (sync) SyncLog::track(*sql, t_name);
+                        else SyncLog::untrack(*sql, t_name);
+                        t_schema["sync"] = sync;
+                    }
                 }
-            }
 
-            // Update has_api field ...
-            if (entity.contains("has_api"))
-            {
-                t_has_api = entity.at("has_api").get<bool>();
-                t_schema["has_api"] = t_has_api;
-            }
+                // Update access rules if passed in
+                if (entity.contains("addRule")) t_schema["addRule"] = entity.value("addRule", "");
+                if (entity.contains("getRule")) t_schema["getRule"] = entity.value("getRule", "");
+                if (entity.contains("listRule")) t_schema["listRule"] = entity.value("listRule", "");
+                if (entity.contains("updateRule")) t_schema["updateRule"] = entity.value("updateRule", "");
+                if (entity.contains("deleteRule")) t_schema["deleteRule"] = entity.value("deleteRule", "");
+
+                // If we are changing table names, then ensure it's not empty nor system name kind of ...
+                if (const auto& name = trim(entity.value("name", ""));
+                    !name.empty() && name != t_name)
+                {
+                    // Hold system table names ...
+                    const std::vector<std::string> sys_tables{"__admin", "__tables"};
 
-            // Update access rules if passed in
-            if (entity.contains("addRule")) t_schema["addRule"] = entity.value("addRule", "");
-            if (entity.contains("getRule")) t_schema["getRule"] = entity.value("getRule", "");
-            if (entity.contains("listRule")) t_schema["listRule"] = entity.value("listRule", "");
-            if (entity.contains("updateRule")) t_schema["updateRule"] = entity.value("updateRule", "");
-            if (entity.contains("deleteRule")) t_schema["deleteRule"] = entity.value("deleteRule", "");
+                    // Check that the new name is not matching any system table names
+                    if (std::find(sys_tables.begin(), sys_tables.end(), name) != sys_tables.end())
+                    {
+                        response["error"] = "The selected table name '" + name + "' is system reserved!";
+                        return false;
+                    }
 
-            // If we are changing table names, then ensure it's not empty nor system name kind of ...
-            if (const auto& name = trim(entity.value("name", ""));
-                !name.empty() && name != t_name)
-            {
-                // Hold system table names ...
-                const std::vector<std::string> sys_tables{"__admin", "__tables"};
+                    // Update table name
+                    // TODO check if this syntax works for all db types
+                    // Works on SQLite
+                    *sql << "ALTER TABLE " + t_name + " RENAME TO " + name;
 
-                // Check that the new name is not matching any system table names
-                if (std::find(sys_tables.begin(), sys_tables.end(), name) != sys_tables.end())
+                    // Indexes keep their names across renames, recreate the keyset index under the new name
+                    if (t_type != "view")
+                    {
+                        *sql << "DROP INDEX IF EXISTS " + Table::keysetIndexName(t_name);
+                        *sql << Table::keysetIndexSql(name);
+
+                        // Synced clients keep their tokens under the new name
+                        if (t_schema.value("sync", false)) SyncLog::rename(*sql, t_name, name);
+                    }
+
+                    // Create new table ID and update the json object
+                    const auto nId = generateTableId(name);
+                    t_schema["id"] = nId;
+                    t_schema["name"] = name;
+                    t_id = nId;
+                    t_name = name;
+                }
+
+                // Update fields ...
+                t_schema["fields"] = t_fields; // Create default time values
+
+                // Update index definitions, named & validated against the updated fields
+                if (t_type != "view")
                 {
-                    response["error"] = "The selected table name '" + name + "' is system reserved!";
-                    return response;
+                    json indexes = json::array();
+                    for (const auto& index : t_indexes)
+                        indexes.push_back(Index::from_json(index, t_name).to_json());
+                    t_schema["indexes"] = indexes;
+
+                    // Drop indexes that were removed or redefined, then create the new ones
+                    const auto new_indexes = Table::schemaIndexes(t_schema);
+                    for (const auto& index : old_indexes)
+                    {
+                        if (std::ranges::find(new_indexes, index) == new_indexes.end())
+                            *sql << "DROP INDEX IF EXISTS " + index.name;
+                    }
+
+                    for (const auto& index : new_indexes)
+                    {
+                        if (std::ranges::find(old_indexes, index) == old_indexes.end())
+                            *sql << index.to_sql(t_name);
+                    }
                 }
 
-                // Update table name
-                // TODO check if this syntax works for all db types
-                // Works on SQLite
-                *sql << "ALTER TABLE " + t_name + " RENAME TO " + name;
-
-                // Create new table ID and update the json object
-                const auto nId = generateTableId(name);
-                t_schema["id"] = nId;
-                t_schema["name"] = name;
-                t_id = nId;
-                t_name = name;
-            }
+                // Get updated timestamp
+                std::time_t t = time(nullptr);
+                std::tm* updated_tm = std::localtime(&t);
 
-            // Update fields ...
-            t_schema["fields"] = t_fields; // Create default time values
+                // Update table record, if all went well.
+                std::string query = "UPDATE __tables SET id = :id, name = :name, type = :type, schema = :schema,";
+                query += " has_api = :has_api, updated = :updated WHERE id = :old_id";
 
-            // Get updated timestamp
-            std::time_t t = time(nullptr);
-            std::tm* updated_tm = std::localtime(&t);
+                *sql << query, soci::use(t_id), soci::use(t_name), soci::use(t_type), soci::use(t_schema),
+                    soci::use(t_has_api), soci::use(*updated_tm), soci::use(id);
 
-            // Update table record, if all went well.
-            std::string query = "UPDATE __tables SET id = :id, name = :name, type = :type, schema = :schema,";
-            query += " has_api = :has_api, updated = :updated WHERE id = :old_id";
+                // Write out any pending changes ...
+                return true;
+            });
 
-            *sql << query, soci::use(t_id), soci::use(t_name), soci::use(t_type), soci::use(t_schema),
-                soci::use(t_has_api), soci::use(*updated_tm), soci::use(id);
+            // Validation failed, changes were rolled back & the error set
+            if (!committed) return response;
 
-            // Write out any pending changes ...
-            tr.commit();
+            // Schema changed, cached statements for this table have to be prepared afresh
+            MantisApp::instance().db().statements().invalidate(old_name);
+            if (t_name != old_name) MantisApp::instance().db().statements().invalidate(t_name);
+            MantisApp::instance().db().counters().invalidate(old_name);
+            MantisApp::instance().db().recordCache().invalidate(old_name);
+            if (t_name != old_name) MantisApp::instance().db().recordCache().invalidate(t_name);
+            MantisApp::instance().db().authCache().invalidate(old_name);
+            if (t_name != old_name) MantisApp::instance().db().authCache().invalidate(t_name);
+            MantisApp::instance().db().versions().bump(old_name);
+            if (t_name != old_name) MantisApp::instance().db().versions().bump(t_name);
+
+            const auto sql = MantisApp::instance().db().session();
 
             // Fetch the new record and return it to the user ...
             soci::row r;
@@ -685,6 +865,12 @@ namespace mantis
                 }
             }
         }
+        catch (const std::invalid_argument& e)
+        {
+            // Malformed index definitions, the changes were rolled back
+            response["error"] = e.what();
+            response["status"] = 400;
+        }
         catch (std::exception& e)
         {
             response["error"] = e.what();
@@ -698,26 +884,34 @@ namespace mantis
 
     bool SysTablesUnit::remove(const std::string& id, const json& opts)
     {
-        const auto sql = MantisApp::instance().db().session();
-        soci::transaction tr(*sql);
-
         json response;
-
-        // Check if item exists of given id
         std::string name, type;
-        *sql << "SELECT name, type FROM __tables WHERE id = :id",
-            soci::use(id), soci::into(name), soci::into(type);
 
-        if (!sql->got_data())
+        MantisApp::instance().db().write([&](soci::session& sql)
         {
-            throw std::runtime_error("Item with id = '" + id + "' was not found!");
-        }
+            // Check if item exists of given id
+            sql << "SELECT name, type FROM __tables WHERE id = :id",
+                soci::use(id), soci::into(name), soci::into(type);
+
+            if (!sql.got_data())
+            {
+                throw std::runtime_error("Item with id = '" + id + "' was not found!");
+            }
+
+            // Remove from DB, the sync log first, its triggers are dropped off the table
+            sql << "DELETE FROM __tables WHERE id = :id", soci::use(id);
+            if (type != "view") SyncLog::untrack(sql, name);
+            sql << "DROP TABLE IF EXISTS " + name;
 
-        // Remove from DB
-        *sql << "DELETE FROM __tables WHERE id = :id", soci::use(id);
-        *sql << "DROP TABLE IF EXISTS " + name;
+            return true;
+        });
 
-        tr.commit();
+        // Drop any cached statements referencing this table
+        MantisApp::instance().db().statements().invalidate(name);
+        MantisApp::instance().db().counters().invalidate(name);
+        MantisApp::instance().db().recordCache().invalidate(name);
+        MantisApp::instance().db().authCache().invalidate(name);
+        MantisApp::instance().db().versions().bump(name);
 
         // Delete files directory
         MantisApp::instance().files().deleteDir(name);
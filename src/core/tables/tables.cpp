@@ -33,21 +33,32 @@ namespace mantis
         if (j.value("name", "").empty())
             throw std::invalid_argument("empty table name");
 
-        // Set table name from JSON
-        m_tableName = j.value("name", "");
-        m_tableId = generateTableId(m_tableName);
+        // Set table name from JSON; a schema update keeps the name, leave it untouched then as
+        // the realtime broadcaster reads it concurrently, renames replace the whole unit
+        if (const auto name = j.value("name", ""); name != m_tableName)
+        {
+            m_tableName = name;
+            m_tableId = generateTableId(m_tableName);
+        }
 
         m_fields.clear();
         m_fields = j.value("fields", json::array());
 
-        m_listRule = j.value("listRule", "");
-        m_getRule = j.value("getRule", "");
-        m_addRule = j.value("addRule", "");
-        m_updateRule = j.value("updateRule", "");
-        m_deleteRule = j.value("deleteRule", "");
+        {
+            // Rules are read by the realtime broadcaster too, besides request handlers
+            std::unique_lock lock(m_rulesMutex);
+            m_listRule = j.value("listRule", "");
+            m_getRule = j.value("getRule", "");
+            m_addRule = j.value("addRule", "");
+            m_updateRule = j.value("updateRule", "");
+            m_deleteRule = j.value("deleteRule", "");
+        }
+        compileRules();
 
         m_isSystem = j.value("system", false);
         m_tableType = j.value("type", "base");
+        m_idStrategy = j.value("idStrategy", "random");
+        m_sync = j.value("sync", false);
     }
 
     void TableUnit::setRouteDisplayName(const std::string& routeName)
@@ -99,6 +110,16 @@ namespace mantis
         return m_isSystem;
     }
 
+    std::string TableUnit::idStrategy() const
+    {
+        return m_idStrategy;
+    }
+
+    bool TableUnit::syncEnabled() const
+    {
+        return m_sync;
+    }
+
     void TableUnit::setIsSystemTable(const bool isSystemTable)
     {
         m_isSystem = isSystemTable;
@@ -106,51 +127,116 @@ namespace mantis
 
     Rule TableUnit::listRule()
     {
+        std::shared_lock lock(m_rulesMutex);
         return m_listRule;
     }
 
     void TableUnit::setListRule(const Rule& rule)
     {
-        m_listRule = rule;
+        {
+            std::unique_lock lock(m_rulesMutex);
+            m_listRule = rule;
+        }
+        compileRules();
     }
 
     Rule TableUnit::getRule()
     {
+        std::shared_lock lock(m_rulesMutex);
         return m_getRule;
     }
 
     void TableUnit::setGetRule(const Rule& rule)
     {
-        m_getRule = rule;
+        {
+            std::unique_lock lock(m_rulesMutex);
+            m_getRule = rule;
+        }
+        compileRules();
     }
 
     Rule TableUnit::addRule()
     {
+        std::shared_lock lock(m_rulesMutex);
         return m_addRule;
     }
 
     void TableUnit::setAddRule(const Rule& rule)
     {
-        m_addRule = rule;
+        {
+            std::unique_lock lock(m_rulesMutex);
+            m_addRule = rule;
+        }
+        compileRules();
     }
 
     Rule TableUnit::updateRule()
     {
+        std::shared_lock lock(m_rulesMutex);
         return m_updateRule;
     }
 
     void TableUnit::setUpdateRule(const Rule& rule)
     {
-        m_updateRule = rule;
+        {
+            std::unique_lock lock(m_rulesMutex);
+            m_updateRule = rule;
+        }
+        compileRules();
     }
 
     Rule TableUnit::deleteRule()
     {
+        std::shared_lock lock(m_rulesMutex);
         return m_deleteRule;
     }
 
     void TableUnit::setDeleteRule(const Rule& rule)
     {
-        m_deleteRule = rule;
+        {
+            std::unique_lock lock(m_rulesMutex);
+            m_deleteRule = rule;
+        }
+        compileRules();
+    }
+
+    void TableUnit::compileRules()
+    {
+        std::unique_lock lock(m_rulesMutex);
+
+        std::unordered_map<std::string, CompiledRule> compiled;
+        for (const auto& rule : {m_listRule, m_getRule, m_addRule, m_updateRule, m_deleteRule})
+        {
+            const auto expr = trim(rule);
+            if (expr.empty() || compiled.contains(expr)) continue;
+
+            // Unchanged rules keep their program
+            if (const auto it = m_compiledRules.find(expr); it != m_compiledRules.end())
+            {
+                compiled.emplace(expr, it->second);
+                continue;
+            }
+
+            auto program = ExprEvaluator::compile(expr);
+            if (!program.error.empty())
+                Log::critical("Access rule `{}` of `{}` is invalid, it denies all access: {}",
+                              expr, m_tableName, program.error);
+
+            compiled.emplace(expr, std::move(program));
+        }
+
+        m_compiledRules = std::move(compiled);
+    }
+
+    CompiledRule TableUnit::compiledRule(const Rule& rule) const
+    {
+        const auto expr = trim(rule);
+        {
+            std::shared_lock lock(m_rulesMutex);
+            if (const auto it = m_compiledRules.find(expr); it != m_compiledRules.end())
+                return it->second;
+        }
+
+        return ExprEvaluator::compile(expr);
     }
 }
@@ -174,11 +174,6 @@ namespace mantis
     {
         TRACE_CLASS_METHOD();
 
-        // Get the auth var from the context, resort to empty object if it's not set.
-        auto auth = req.getOr<json>("auth", json::object());
-
-        Log::trace("Auth Obj: `{}`", auth.dump());
-
         auto method = req.getMethod();
         if (!(method == "GET"
             || method == "POST"
@@ -196,89 +191,31 @@ namespace mantis
 
         // Store rule, depending on the request type
         std::string rule = method == "GET"
-                               ? (req.hasPathParams() ? m_listRule : m_getRule)
+                               ? (req.hasPathParams() ? getRule() : listRule())
                                : method == "POST"
-                               ? m_addRule
+                               ? addRule()
                                : method == "PATCH"
-                               ? m_updateRule
-                               : m_deleteRule;
+                               ? updateRule()
+                               : deleteRule();
 
         Log::trace("Rule: `{}`", rule);
 
-        // Remove whitespaces
-        rule = trim(rule);
-
-        // Token map variables for evaluation
-        TokenMap vars;
+        // Only what the rule reads is built into its variables, e.g. the request body
+        const auto compiled = compiledRule(rule);
 
-        // Expand logged user if token is present and query user information if it exists
-        if (auth.contains("token") && !auth["token"].is_null() && !auth["token"].empty())
-        {
-            const auto token = auth.at("token").get<std::string>();
-
-            // If token validation worked, lets get data from database
-            if (const auto resp = JwtUnit::verifyJwtToken(token); resp.at("verified").get<bool>())
-            {
-                Log::trace("Token Verified: `{}`", token);
-                const auto user_id = resp.at("id").get<std::string>();
-                const auto user_table = resp.at("table").get<std::string>();
-
-                // Query for user with given ID, this info will be populated to the
-                // expression evaluator args as well as available through
-                // the session context, queried by:
-                //  ` req.get<json>("auth").value("id", ""); // returns the user ID
-                //  ` req.get<json>("auth").value("name", ""); // returns the user's name
-                auto sql = MantisApp::instance().db().session();
-                std::string query = "SELECT * FROM " + user_table + " WHERE id = :id LIMIT 1";
-
-                soci::row user_row;
-                *sql << query, soci::use(user_id), soci::into(user_row);
-
-                // Let's only populate TokenVars for now, no returning
-                if (sql->got_data())
-                {
-                    // Populate the auth object with additional data from the database
-                    // remove `password` field if available
-                    auto user = user_table == "__admins"
-                                    ? parseDbRowToJson(user_row, MantisApp::instance().router().adminTableFields)
-                                    : parseDbRowToJson(user_row);
-
-                    // Populate the `auth` object
-                    auth["type"] = "user";
-                    auth["id"] = user_id;
-                    auth["table"] = user_table;
-
-                    // Populate auth obj with user details ...
-                    for (const auto& [key, value] : user.items())
-                    {
-                        auth[key] = value;
-                    }
-
-                    // Remove password field
-                    auth.erase("password");
-
-                    // Update context data
-                    req.set("auth", auth);
-
-                    // Add `auth` data to the TokenMap
-                    vars["auth"] = MantisApp::instance().evaluator().jsonToTokenMap(auth);
-                }
-            }
-        }
+        // Expand logged user if token is present, whether or not the rule reads `auth`; the
+        // token is verified & the user resolved for every request
+        const auto auth = resolveAuth(req);
 
         // Request Token Map
-        TokenMap reqMap;
-        reqMap["remoteAddr"] = req.getRemoteAddr();
-        reqMap["remotePort"] = req.getRemotePort();
-        reqMap["localAddr"] = req.getLocalAddr();
-        reqMap["localPort"] = req.getLocalPort();
+        TokenMap reqMap = requestVars(req);
 
         try
         {
-            if (req.getMethod() == "POST" && !req.getBody().empty()) // TODO handle formdata
+            if (compiled.req.reads("body") && req.getMethod() == "POST" && !req.getBody().empty()) // TODO handle formdata
             {
                 // Parse request body and add it to the request TokenMap
-                auto request = json::parse(req.getMethod());
+                auto request = json::parse(req.getBody());
                 reqMap["body"] = MantisApp::instance().evaluator().jsonToTokenMap(request);
             }
         }
@@ -286,11 +223,122 @@ namespace mantis
         {
         }
 
-        // Add the request map to the vars
-        vars["req"] = reqMap;
+        // Evaluation yielded false, return the access denied error
+        if (const auto denied = checkAccess(rule, auth, reqMap); denied.has_value())
+        {
+            json response = denied.value();
+            response["data"] = json::object();
+
+            res.sendJson(response.at("status").get<int>(), response);
+            return REQUEST_HANDLED;
+        }
+
+        return REQUEST_PENDING; // Proceed to next middleware
+    }
+
+    json TableUnit::resolveAuth(MantisRequest& req) const
+    {
+        // Get the auth var from the context, resort to empty object if it's not set.
+        auto auth = req.getOr<json>("auth", json::object());
+
+        Log::trace("Auth Obj: `{}`", auth.dump());
+
+        if (!auth.contains("token") || auth["token"].is_null() || auth["token"].empty())
+            return auth;
+
+        const auto token = auth.at("token").get<std::string>();
+
+        // If token validation worked, lets get data from database
+        const auto resp = JwtUnit::verifyJwtToken(token);
+        if (!resp.at("verified").get<bool>())
+            return auth;
+
+        Log::trace("Token Verified: `{}`", token);
+        const auto user_id = resp.at("id").get<std::string>();
+        const auto user_table = resp.at("table").get<std::string>();
+
+        // Load the user with given ID, this info will be populated to the
+        // expression evaluator args as well as available through
+        // the session context, queried by:
+        //  ` req.get<json>("auth").value("id", ""); // returns the user ID
+        //  ` req.get<json>("auth").value("name", ""); // returns the user's name
+        const auto user = principal(user_table, user_id);
+        if (!user.has_value())
+            return auth;
+
+        // Populate the `auth` object
+        auth["type"] = "user";
+        auth["id"] = user_id;
+        auth["table"] = user_table;
+
+        // Populate auth obj with user details ...
+        for (const auto& [key, value] : user->items())
+        {
+            auth[key] = value;
+        }
+
+        // Update context data
+        req.set("auth", auth);
+
+        return auth;
+    }
+
+    std::optional<json> TableUnit::principal(const std::string& table, const std::string& id)
+    {
+        auto& cache = MantisApp::instance().db().authCache();
+        if (auto user = cache.get(table, id); user.has_value())
+            return user;
+
+        // Taken before reading, a concurrent update keeps the user read here out of the cache
+        const auto generation = cache.generation(table, id);
+
+        const auto sql = MantisApp::instance().db().readSession();
+        soci::row user_row;
+        *sql << "SELECT * FROM " + table + " WHERE id = :id LIMIT 1", soci::use(id), soci::into(user_row);
+
+        if (!sql->got_data())
+            return std::nullopt;
+
+        // Parsed as per the user table's own schema
+        auto& router = MantisApp::instance().router();
+        json user;
+        if (table == "__admins")
+        {
+            user = router.adminTable()->parseDbRowToJson(user_row, router.adminTableFields);
+        }
+        else if (const auto user_table = router.findTable(table))
+        {
+            user = user_table->parseDbRowToJson(user_row);
+        }
+        else
+        {
+            return std::nullopt;
+        }
+
+        // Remove password field
+        user.erase("password");
+
+        cache.put(table, id, user, generation);
+        return user;
+    }
+
+    TokenMap TableUnit::requestVars(MantisRequest& req)
+    {
+        TokenMap reqMap;
+        reqMap["remoteAddr"] = req.getRemoteAddr();
+        reqMap["remotePort"] = req.getRemotePort();
+        reqMap["localAddr"] = req.getLocalAddr();
+        reqMap["localPort"] = req.getLocalPort();
+        return reqMap;
+    }
+
+    std::optional<json> TableUnit::checkAccess(const Rule& rule, const json& auth, const TokenMap& reqMap) const
+    {
+        // Remove whitespaces
+        const auto expr = trim(rule);
 
         // If the rule is empty, enforce admin authorization
-        if (rule.empty())
+        if (expr.empty())
         {
             // Check if user is logged in as Admin
             if (auth.contains("table")  // Has `table` key
@@ -300,35 +348,50 @@ namespace mantis
             {
                 // If logged in as admin, grant access
                 // Admins get unconditional data access
-                return REQUEST_PENDING;
+                return std::nullopt;
             }
 
-            Log::trace("Table: `{}`", auth.at("table").get<std::string>());
+            Log::trace("Table: `{}`", auth.value("table", json()).dump());
 
             // User was not an admin, lets return access denied error
-            json response;
-            response["status"] = 403;
-            response["data"] = json::object();
-            response["error"] = "Admin auth required to access this resource.";
+            return json{{"status", 403}, {"error", "Admin auth required to access this resource."}};
+        }
 
-            res.sendJson(403, response);
-            return REQUEST_HANDLED;
+        Log::trace("Expression Rule = {}", expr);
+
+        const auto compiled = compiledRule(expr);
+
+        // Token map variables for evaluation, `auth` is only set for logged-in users
+        // and holds just the fields the rule reads.
+        TokenMap vars;
+        if (compiled.auth.used && auth.contains("id") && !auth["id"].is_null())
+        {
+            if (compiled.auth.all)
+            {
+                vars["auth"] = MantisApp::instance().evaluator().jsonToTokenMap(auth);
+            }
+            else
+            {
+                json fields = json::object();
+                for (const auto& field : compiled.auth.fields)
+                {
+                    if (auth.contains(field)) fields[field] = auth[field];
+                }
+
+                vars["auth"] = MantisApp::instance().evaluator().jsonToTokenMap(fields);
+            }
         }
 
-        Log::trace("Expression Rule = {}", rule);
+        // Add the request map to the vars
+        vars["req"] = reqMap;
 
         // If expression evaluation returns true, lets return allowing execution
-        // continuation. Else, we'll craft an error response.
-        if (MantisApp::instance().evaluator().evaluate(rule, vars))
-            return REQUEST_PENDING; // Proceed to next middleware
+        // continuation. Else, we'll craft an error response. The rule was compiled
+        // when it was set, only evaluation is left.
+        if (MantisApp::instance().evaluator().evaluate(compiled, vars))
+            return std::nullopt;
 
         // Evaluation yielded false, return generic access denied error
-        json response;
-        response["status"] = 403;
-        response["data"] = json::object();
-        response["error"] = "Access denied!";
-
-        res.sendJson(403, response);
-        return REQUEST_HANDLED;
+        return json{{"status", 403}, {"error", "Access denied!"}};
     }
 }
@@ -18,93 +18,31 @@ namespace mantis
         result["status"] = 201;
         result["error"] = "";
 
-        // Database session & transaction instance
-        auto sql = MantisApp::instance().db().session();
-        soci::transaction tr(*sql);
-
         try
         {
-            // Create a random ID, then check if it exists already in the DB
-            std::string id = generateShortId();
-            int trials = 0;
-            while (recordExists(id))
-            {
-                trials++;
-
-                //  As trials go over 5, expand the id size by a character every time
-                if (trials > 5) id = generateShortId(12 + trials % 5);
-                else id = generateShortId();
-
-                // Try getting a new ID ten times before giving up. Avoid infinite loops
-                if (trials >= 10)
-                    break;
-            }
-
-            // Create default time values
-            std::time_t current_t = time(nullptr);
-            std::tm created_tm = *std::localtime(&current_t);
-            std::string columns, placeholders;
-
-            auto entity_copy = entity;
-
-            // Force default values here ...
-            entity_copy["id"] = "";
-            entity_copy["created"] = nullptr;
-            entity_copy["updated"] = nullptr;
-
-            // Create the field cols and value cols as concatenated strings
-            for (const auto& [key, _] : entity_copy.items())
-            {
-                // First, ensure the key exists in our schema fields
-                auto schema = findFieldByKey(key);
-                if (!schema.has_value())
-                {
-                    entity_copy.erase(key);
-                    continue;
-                }
-
-                columns += columns.empty() ? key : ", " + key;
-                placeholders += placeholders.empty() ? (":" + key) : (", :" + key);
-            }
-
-            // Create the SQL Query
-            std::string sql_query = "INSERT INTO " + m_tableName + "(" + columns + ") VALUES (" + placeholders + ")";
-
-            // Store all bound values to ensure lifetime
-            soci::values vals;
-            vals.set("id", id, soci::i_ok);
-            vals.set("created", created_tm, soci::i_ok);
-            vals.set("updated", created_tm, soci::i_ok);
-
-            // Bind soci::values to entity values
-            const auto status = bindEntityToSociValue(vals, entity_copy);
-            if (status.has_value())
+            RecordWrite op;
+            if (const auto status = prepareCreate(entity, opts, op); status.has_value())
             {
                 return status.value();
             }
 
-            // Execute sql query
-            *sql << sql_query, soci::use(vals);
-            tr.commit();
-
-            // Query back the created record and send it back to the client
-            soci::row r;
-            *sql << "SELECT * FROM " + m_tableName + " WHERE id = :id", soci::use(id), soci::into(r);
-            auto added_row = parseDbRowToJson(r);
+            // Insert the record and read it back within the same write job
+            MantisApp::instance().db().write([&](soci::session& sql)
+            {
+                executeCreate(sql, op);
+                return true;
+            });
 
-            // Remove user password from the response
-            if (tableType() == "auth") added_row.erase("password");
+            finishCreate(op);
 
             result["error"] = "";
-            result["data"] = added_row;
+            result["data"] = op.record;
             result["status"] = 201;
 
             return result;
         }
         catch (const soci::soci_error& e)
         {
-            tr.rollback();
-
             result["error"] = e.what();
             result["status"] = 500;
 
@@ -112,8 +50,6 @@ namespace mantis
         }
         catch (const std::exception& e)
         {
-            tr.rollback();
-
             json err;
             result["error"] = e.what();
             result["status"] = 500;
@@ -122,8 +58,6 @@ namespace mantis
         }
         catch (...)
         {
-            tr.rollback();
-
             json err;
             result["error"] = "Unknown Error!";
             result["status"] = 500;
@@ -134,207 +68,229 @@ namespace mantis
         return result;
     }
 
-    std::optional<json> TableUnit::read(const std::string& id, const json& opts)
+    std::optional<json> TableUnit::prepareCreate(const json& entity, const json& opts, RecordWrite& op) const
     {
-        TRACE_CLASS_METHOD()
+        // Not checked for existence here, a taken id is retried on insert, see executeCreate()
+        op.keepId = opts.is_object() && opts.contains("id");
+        std::string id = op.keepId ? opts["id"].get<std::string>() : newRecordId();
+
+        // Create default time values, synced records keep the client's
+        std::time_t current_t = time(nullptr);
+        std::tm created_tm = *std::localtime(&current_t);
+        if (opts.is_object() && opts.contains("updated"))
+            created_tm = strToTM(opts["updated"].get<std::string>());
+        std::string columns, placeholders;
+
+        auto entity_copy = entity;
+
+        // Force default values here ...
+        entity_copy["id"] = "";
+        entity_copy["created"] = nullptr;
+        entity_copy["updated"] = nullptr;
+
+        // Create the field cols and value cols as concatenated strings
+        for (const auto& [key, _] : entity_copy.items())
+        {
+            // First, ensure the key exists in our schema fields
+            auto schema = findFieldByKey(key);
+            if (!schema.has_value())
+            {
+                entity_copy.erase(key);
+                continue;
+            }
 
-        // Get a soci::session from the pool
-        const auto sql = MantisApp::instance().db().session();
+            columns += columns.empty() ? key : ", " + key;
+            placeholders += placeholders.empty() ? (":" + key) : (", :" + key);
+        }
 
-        soci::row r; // To hold read data
-        *sql << "SELECT * FROM " + m_tableName + " WHERE id = :id", soci::use(id), soci::into(r);
+        // Create the SQL Query
+        op.id = id;
+        op.columns = columns;
+        op.query = "INSERT INTO " + m_tableName + "(" + columns + ") VALUES (" + placeholders + ")";
 
-        // If no data was found, return a nullopt
-        if (!sql->got_data()) return std::nullopt;
+        // Store all bound values to ensure lifetime
+        op.values.set("id", id, soci::i_ok);
+        op.values.set("created", created_tm, soci::i_ok);
+        op.values.set("updated", created_tm, soci::i_ok);
 
-        // Parse returned record to JSON
-        auto record = parseDbRowToJson(r);
+        // Bind soci::values to entity values
+        if (const auto status = bindEntityToSociValue(op.values, entity_copy); status.has_value())
+        {
+            return status.value();
+        }
 
-        // Remove user password from the response
-        if (tableType() == "auth") record.erase("password");
+        // Sparse fieldset of the record sent back
+        if (const auto err = selectColumns(opts.is_object() ? opts.value("fields", "") : "", op.selectColumns);
+            !err.empty())
+        {
+            return json{{"data", json::object()}, {"error", err}, {"status", 400}};
+        }
 
-        // Return the record
-        return record;
+        return std::nullopt;
     }
 
-    json TableUnit::update(const std::string& id, const json& entity, const json& opts)
+    void TableUnit::executeCreate(soci::session& sql, RecordWrite& op) const
     {
-        TRACE_CLASS_METHOD()
-
-        json result;
-        result["data"] = json::object();
-        result["status"] = 200;
-        result["error"] = "";
+        const auto returning = MantisApp::instance().db().supportsReturning();
 
-        // Database session & transaction instance
-        auto sql = MantisApp::instance().db().session();
-        soci::transaction tr(*sql);
-
-        try
+        // On id conflicts, retry with a new id
+        for (int attempt = 1;; ++attempt)
         {
-            // Create default time values
-            std::time_t current_t = time(nullptr);
-            std::tm created_tm = *std::localtime(&current_t);
-            std::string columns, placeholders;
-
-            // Store files to delete by filename
-            std::vector<std::string> files_to_delete{};
-            std::vector<json> file_fields{};
-
-            // Create a temporary container to track fields we intend to update.
-            // Why? We'll limit to the fields we have in our schema, that way, we
-            // don't have any surprises.
-            // TODO Maybe open it up? But how do we handle other types?
-            std::vector<std::string> updateFields;
-            updateFields.reserve(entity.size());
-
-            // Create the field cols and value cols as concatenated strings
-            for (const auto& [key, val] : entity.items())
+            if (returning)
             {
-                // For system fields, let's ignore them for now.
-                if (key == "id" || key == "created" || key == "updated") continue;
-
-                // First, ensure the key exists in our schema fields
-                auto schema = findFieldByKey(key);
-                if (!schema.has_value()) continue;
+                // Insert & read back the record in one statement, where supported. A taken id
+                // inserts nothing rather than failing, PostgreSQL would abort the transaction.
+                const auto record = writeReturning(
+                    sql, "insert:" + op.columns + "|" + op.selectColumns,
+                    op.query + " ON CONFLICT (id) DO NOTHING RETURNING " + op.selectColumns, op.values);
 
-                columns += columns.empty() ? (key + " = :" + key) : (", " + key + " = :" + key);
-                updateFields.push_back(key);
-
-                // Track file fields for use later on
-                if (schema.value()["type"] == "file" || schema.value()["type"] == "files")
+                if (record.has_value())
                 {
-                    file_fields.push_back(
-                        json{
-                            {"name", key},
-                            {"value", val},
-                            {
-                                "type", schema.value()["type"]
-                            }
-                        });
+                    op.record = record.value();
+                    return;
                 }
             }
-
-            // Check that we have fields to update, if not so, just return
-            if (updateFields.empty())
-            {
-                result["error"] = "Nothing to update";
-                result["data"] = json::object();
-                result["status"] = 200;
-                return result;
-            }
-
-            // Add Updated field as an extra field for updates ...
-            columns += columns.empty() ? ("updated = :updated") : (", updated = :updated");
-            updateFields.emplace_back("updated");
-
-            // Check for file(s) being saved from the request, determine if there is
-            // need to delete/overwrite existing files
-            if (!file_fields.empty())
+            else
             {
-                std::string fields_to_query{};
+                try
+                {
+                    // Execute sql query, reusing the prepared statement for this column set
+                    {
+                        const auto st = MantisApp::instance().db().statements().prepare(
+                            sql, m_tableName, "insert:" + op.columns, [&] { return op.query; });
+                        st->exchange(soci::use(op.values));
+                        st->define_and_bind();
+                        st->execute(true);
+                    }
 
-                for (const auto& file : file_fields)
+                    // Query back the created record and send it back to the client
+                    op.record = readRecord(sql, op.id, op.selectColumns).value_or(json::object());
+                    return;
+                }
+                catch (const soci::soci_error& e)
                 {
-                    if (fields_to_query.empty()) fields_to_query = file["name"];
-                    else fields_to_query += ", " + file["name"].get<std::string>();
+                    if (!isIdConflict(e)) throw;
                 }
+            }
 
-                const std::string sql_str = std::format("SELECT {} FROM {} WHERE id = :id LIMIT 1",
-                                                        fields_to_query, m_tableName);
+            if (op.keepId)
+                throw std::runtime_error(std::format("Record id `{}` is taken", op.id));
 
-                soci::row r;
-                *sql << sql_str, soci::use(id), soci::into(r);
+            if (attempt >= MAX_ID_ATTEMPTS)
+                throw std::runtime_error("Could not generate a unique record id");
 
-                if (!sql->got_data())
-                {
-                    result["error"] = std::format("Could not find record with id = {}", id);
-                    result["status"] = 500;
-                    return result;
-                }
+            Log::debug("Record id `{}` is taken in `{}`, retrying", op.id, m_tableName);
+            op.id = newRecordId();
+            op.values.set("id", op.id);
+        }
+    }
 
-                // Parse soci::row to JSON object
-                auto record = parseDbRowToJson(r);
+    void TableUnit::finishCreate(RecordWrite& op) const
+    {
+        MantisApp::instance().db().counters().add(m_tableName, 1);
+        MantisApp::instance().db().versions().bump(m_tableName);
 
-                // From the record, check for changes in files
-                // Assuming record order is maintained on query ...
-                for (const auto& file_field : file_fields)
-                {
-                    const auto field_name = file_field["name"].get<std::string>();
+        // Remove user password from the response
+        if (m_tableType == "auth") op.record.erase("password");
+    }
 
-                    // For null values in db, continue
-                    if (record[field_name].is_null()) continue;
+    std::optional<json> TableUnit::read(const std::string& id, const json& opts)
+    {
+        TRACE_CLASS_METHOD()
 
-                    const auto files_in_db = file_field["type"] == "files"
-                                                 ? record[field_name]
-                                                 : json::array({record[field_name]});
+        // Only read the requested fields, if any
+        std::string select_columns;
+        if (const auto err = selectColumns(opts.is_object() ? opts.value("fields", "") : "", select_columns);
+            !err.empty())
+            throw std::invalid_argument(err);
 
-                    if (file_field["value"] == nullptr ||
-                        (file_field["value"].is_array() && file_field["value"].size() == 0) ||
-                        (file_field["value"].is_string() && file_field["value"].empty()))
-                    {
-                        // If value set is null, add all file(s) to delete array
-                        files_to_delete.insert(files_to_delete.end(), files_in_db.begin(), files_in_db.end());
-                        continue;
-                    }
+        // Only keep the requested fields of a full record
+        const auto project = [&](json& record)
+        {
+            if (select_columns == "*") return;
 
-                    const auto new_files = file_field["type"] == "files"
-                                               ? file_field["value"]
-                                               : json::array({file_field["value"]});
+            const auto selected = splitString(select_columns, ", ");
+            for (auto it = record.begin(); it != record.end();)
+            {
+                if (std::ranges::find(selected, it.key()) == selected.end()) it = record.erase(it);
+                else ++it;
+            }
+        };
 
-                    for (const auto& file : files_in_db)
-                    {
-                        if (std::ranges::find(new_files, file) == new_files.end())
-                        {
-                            // The new list/file is missing the file named in the db, so delete it
-                            files_to_delete.push_back(file);
-                        }
-                    }
-                }
+        // Hot records are served from memory, whole, whatever fields are asked for
+        auto& cache = MantisApp::instance().db().recordCache();
+        const auto cached = cache.enabled(m_tableName);
+        uint64_t generation = 0;
+        if (cached)
+        {
+            if (const auto hit = cache.get(m_tableName, id); hit.has_value())
+            {
+                auto record = json::parse(hit.value());
+                project(record);
+                return record;
             }
 
-            // Create the SQL Query
-            std::string sql_query = "UPDATE " + m_tableName + " SET " + columns + " WHERE id = :id";
+            // Taken before reading, a concurrent write keeps the record read here out of the cache
+            generation = cache.generation(m_tableName, id);
+        }
+
+        // Get a soci::session from the pool, cached records are read from the primary as a lagging
+        // replica could hand back a record older than the write that last invalidated it
+        const auto sql = cached ? MantisApp::instance().db().session() : MantisApp::instance().db().readSession();
+
+        // If no data was found, return a nullopt
+        auto record = readRecord(*sql, id, cached ? "*" : select_columns);
+        if (!record.has_value()) return std::nullopt;
+
+        // Remove user password from the response
+        if (tableType() == "auth") record->erase("password");
+
+        if (cached)
+        {
+            cache.put(m_tableName, id, record->dump(), generation);
+            project(record.value());
+        }
+
+        // Return the record
+        return record;
+    }
 
-            // Store values for binding
-            soci::values vals;
+    json TableUnit::update(const std::string& id, const json& entity, const json& opts)
+    {
+        TRACE_CLASS_METHOD()
 
-            vals.set("id", id);
-            vals.set("updated", created_tm);
+        json result;
+        result["data"] = json::object();
+        result["status"] = 200;
+        result["error"] = "";
 
-            // Bind soci::values to entity values
-            // Check if the return has a value, if yes, return the value
-            if (const auto status = bindEntityToSociValue(vals, entity);
-                status.has_value())
+        try
+        {
+            RecordWrite op;
+            if (const auto status = prepareUpdate(id, entity, opts, op); status.has_value())
             {
-                // An error occurred while binding data to soci::values
                 return status.value();
             }
 
-            // Bind values, then execute
-            *sql << sql_query, soci::use(vals);
-            // Log::trace(">> $ sql << {}\n\t└── Values ({})", sql->get_query(), sql->get_last_query_context());
-            tr.commit();
-
-            // Delete files, if any were removed ...
-            for (const auto& file : files_to_delete)
+            const auto committed = MantisApp::instance().db().write([&](soci::session& sql)
             {
-                if (!MantisApp::instance().files().removeFile(m_tableName, file))
+                if (const auto err = executeUpdate(sql, op); !err.empty())
                 {
-                    Log::warn("Could not delete file, is it missing?\n\t- `{}`", file);
+                    result["error"] = err;
+                    result["status"] = 500;
+                    return false;
                 }
-            }
 
-            // Query back the created record and send it back to the client
-            soci::row r;
-            *sql << "SELECT * FROM " + m_tableName + " WHERE id = :id", soci::use(id), soci::into(r);
-            auto record = parseDbRowToJson(r);
+                return true;
+            });
+
+            // Record was not found, error is already set
+            if (!committed) return result;
 
-            // Redact passwords
-            if (tableType() == "auth") record.erase("password");
+            finishUpdate(op);
 
             result["error"] = "";
-            result["data"] = record;
+            result["data"] = op.record;
             result["status"] = 200;
 
             return result;
@@ -364,31 +320,275 @@ namespace mantis
         return result;
     }
 
+    std::optional<json> TableUnit::prepareUpdate(const std::string& id, const json& entity, const json& opts,
+                                                 RecordWrite& op) const
+    {
+        // Create default time values, synced records keep the client's
+        std::time_t current_t = time(nullptr);
+        std::tm created_tm = *std::localtime(&current_t);
+        if (opts.is_object() && opts.contains("updated"))
+            created_tm = strToTM(opts["updated"].get<std::string>());
+        std::string columns;
+
+        // Create a temporary container to track fields we intend to update.
+        // Why? We'll limit to the fields we have in our schema, that way, we
+        // don't have any surprises.
+        // TODO Maybe open it up? But how do we handle other types?
+        std::vector<std::string> updateFields;
+        updateFields.reserve(entity.size());
+
+        // Create the field cols and value cols as concatenated strings
+        for (const auto& [key, val] : entity.items())
+        {
+            // For system fields, let's ignore them for now.
+            if (key == "id" || key == "created" || key == "updated") continue;
+
+            // First, ensure the key exists in our schema fields
+            auto schema = findFieldByKey(key);
+            if (!schema.has_value()) continue;
+
+            columns += columns.empty() ? (key + " = :" + key) : (", " + key + " = :" + key);
+            updateFields.push_back(key);
+
+            // Track file fields for use later on
+            if (schema.value()["type"] == "file" || schema.value()["type"] == "files")
+            {
+                op.fileFields.push_back(
+                    json{
+                        {"name", key},
+                        {"value", val},
+                        {
+                            "type", schema.value()["type"]
+                        }
+                    });
+            }
+        }
+
+        // Check that we have fields to update, if not so, just return
+        if (updateFields.empty())
+        {
+            return json{{"data", json::object()}, {"error", "Nothing to update"}, {"status", 200}};
+        }
+
+        // Add Updated field as an extra field for updates ...
+        columns += columns.empty() ? ("updated = :updated") : (", updated = :updated");
+        updateFields.emplace_back("updated");
+
+        // Create the SQL Query
+        op.id = id;
+        op.columns = columns;
+        op.query = "UPDATE " + m_tableName + " SET " + columns + " WHERE id = :id";
+
+        // Store values for binding
+        op.values.set("id", id);
+        op.values.set("updated", created_tm);
+
+        // Bind soci::values to entity values
+        // Check if the return has a value, if yes, return the value
+        if (const auto status = bindEntityToSociValue(op.values, entity);
+            status.has_value())
+        {
+            // An error occurred while binding data to soci::values
+            return status.value();
+        }
+
+        // Sparse fieldset of the record sent back
+        if (const auto err = selectColumns(opts.is_object() ? opts.value("fields", "") : "", op.selectColumns);
+            !err.empty())
+        {
+            return json{{"data", json::object()}, {"error", err}, {"status", 400}};
+        }
+
+        return std::nullopt;
+    }
+
+    std::string TableUnit::executeUpdate(soci::session& sql, RecordWrite& op) const
+    {
+        const auto& id = op.id;
+
+        // Check for file(s) being saved from the request, determine if there is
+        // need to delete/overwrite existing files
+        if (!op.fileFields.empty())
+        {
+            std::string fields_to_query{};
+
+            for (const auto& file : op.fileFields)
+            {
+                if (fields_to_query.empty()) fields_to_query = file["name"];
+                else fields_to_query += ", " + file["name"].get<std::string>();
+            }
+
+            const std::string sql_str = std::format("SELECT {} FROM {} WHERE id = :id LIMIT 1",
+                                                    fields_to_query, m_tableName);
+
+            soci::row r;
+            const auto st = MantisApp::instance().db().statements().prepare(
+                sql, m_tableName, "files:" + fields_to_query, [&] { return sql_str; });
+            st->exchange(soci::use(id));
+            st->exchange(soci::into(r));
+            st->define_and_bind();
+            st->execute(true);
+
+            if (!st->got_data())
+            {
+                return std::format("Could not find record with id = {}", id);
+            }
+
+            // Parse soci::row to JSON object
+            auto db_record = parseDbRowToJson(r);
+
+            // From the record, check for changes in files
+            // Assuming record order is maintained on query ...
+            for (const auto& file_field : op.fileFields)
+            {
+                const auto field_name = file_field["name"].get<std::string>();
+
+                // For null values in db, continue
+                if (db_record[field_name].is_null()) continue;
+
+                const auto files_in_db = file_field["type"] == "files"
+                                             ? db_record[field_name]
+                                             : json::array({db_record[field_name]});
+
+                if (file_field["value"] == nullptr ||
+                    (file_field["value"].is_array() && file_field["value"].size() == 0) ||
+                    (file_field["value"].is_string() && file_field["value"].empty()))
+                {
+                    // If value set is null, add all file(s) to delete array
+                    op.filesToDelete.insert(op.filesToDelete.end(), files_in_db.begin(), files_in_db.end());
+                    continue;
+                }
+
+                const auto new_files = file_field["type"] == "files"
+                                           ? file_field["value"]
+                                           : json::array({file_field["value"]});
+
+                for (const auto& file : files_in_db)
+                {
+                    if (std::ranges::find(new_files, file) == new_files.end())
+                    {
+                        // The new list/file is missing the file named in the db, so delete it
+                        op.filesToDelete.push_back(file);
+                    }
+                }
+            }
+        }
+
+        // Update & read back the record in one statement, where supported
+        if (MantisApp::instance().db().supportsReturning())
+        {
+            const auto record = writeReturning(sql, "update:" + op.columns + "|" + op.selectColumns,
+                                               op.query + " RETURNING " + op.selectColumns, op.values);
+            if (!record.has_value())
+            {
+                return std::format("Could not find record with id = {}", op.id);
+            }
+
+            op.record = record.value();
+            return "";
+        }
+
+        // Bind values, then execute
+        {
+            const auto st = MantisApp::instance().db().statements().prepare(
+                sql, m_tableName, "update:" + op.columns, [&] { return op.query; });
+            st->exchange(soci::use(op.values));
+            st->define_and_bind();
+            st->execute(true);
+        }
+
+        // Query back the updated record and send it back to the client
+        const auto record = readRecord(sql, id, op.selectColumns);
+        if (!record.has_value())
+        {
+            return std::format("Could not find record with id = {}", op.id);
+        }
+
+        op.record = record.value();
+        return "";
+    }
+
+    void TableUnit::finishUpdate(RecordWrite& op) const
+    {
+        MantisApp::instance().db().recordCache().invalidate(m_tableName, op.id);
+        MantisApp::instance().db().authCache().invalidate(m_tableName, op.id);
+        MantisApp::instance().db().versions().bump(m_tableName);
+
+        // Delete files, if any were removed ...
+        for (const auto& file : op.filesToDelete)
+        {
+            if (!MantisApp::instance().files().removeFile(m_tableName, file))
+            {
+                Log::warn("Could not delete file, is it missing?\n\t- `{}`", file);
+            }
+        }
+
+        // Redact passwords
+        if (m_tableType == "auth") op.record.erase("password");
+    }
+
     bool TableUnit::remove(const std::string& id, const json& opts)
     {
         TRACE_CLASS_METHOD()
         // Views should not reach here
         if (tableType() == "view") return false;
 
-        const auto sql = MantisApp::instance().db().session();
-        soci::transaction tr(*sql);
+        RecordWrite op;
+        op.id = id;
+        MantisApp::instance().db().write([&](soci::session& sql)
+        {
+            executeRemove(sql, op);
+            return true;
+        });
 
-        // Check if item exists of given id
-        soci::row row;
-        const std::string sqlStr = ("SELECT * FROM " + m_tableName + " WHERE id = :id LIMIT 1");
-        *sql << sqlStr, soci::use(id), soci::into(row);
+        finishRemove(op);
+        return true;
+    }
 
-        if (!sql->got_data())
+    void TableUnit::executeRemove(soci::session& sql, RecordWrite& op) const
+    {
+        // Delete & get the removed record in one statement, where supported
+        if (MantisApp::instance().db().supportsReturning())
         {
-            throw std::runtime_error(std::format("Could not find record with id = {}", id));
+            op.values.set("id", op.id);
+            const auto record = writeReturning(sql, "delete|returning",
+                                               "DELETE FROM " + m_tableName + " WHERE id = :id RETURNING *",
+                                               op.values);
+            if (!record.has_value())
+            {
+                throw std::runtime_error(std::format("Could not find record with id = {}", op.id));
+            }
+
+            op.record = record.value();
+            return;
         }
 
+        // Check if item exists of given id
+        const auto row = readRecord(sql, op.id, "*");
+        if (!row.has_value())
+        {
+            throw std::runtime_error(std::format("Could not find record with id = {}", op.id));
+        }
+
+        op.record = row.value();
+
         // Remove from DB
-        *sql << "DELETE FROM " + m_tableName + " WHERE id = :id", soci::use(id);
-        tr.commit();
+        const auto st = MantisApp::instance().db().statements().prepare(sql, m_tableName, "delete", [&]
+        {
+            return "DELETE FROM " + m_tableName + " WHERE id = :id";
+        });
+        st->exchange(soci::use(op.id));
+        st->define_and_bind();
+        st->execute(true);
+    }
 
-        // Parse row to JSON
-        const auto record = parseDbRowToJson(row);
+    void TableUnit::finishRemove(RecordWrite& op) const
+    {
+        auto& record = op.record;
+        MantisApp::instance().db().counters().add(m_tableName, -1);
+        MantisApp::instance().db().recordCache().invalidate(m_tableName, op.id);
+        MantisApp::instance().db().authCache().invalidate(m_tableName, op.id);
+        MantisApp::instance().db().versions().bump(m_tableName);
 
         // Extract all fields that have file/files as the underlying data
         std::vector<json> files_in_fields;
@@ -420,67 +620,368 @@ namespace mantis
             [[maybe_unused]]
                 auto _ = MantisApp::instance().files().removeFile(m_tableName, file_name);
         }
-        return true;
     }
 
     json TableUnit::list_records(const json& opts)
     {
         TRACE_CLASS_METHOD()
         json response = {{"error", ""}, {"pagination", json::object()}, {"data", json::array()}};
-        const auto sql = MantisApp::instance().db().session();
+        const auto sql = MantisApp::instance().db().readSession();
 
         auto pagination = opts.value("pagination", json::object());
-        int count = -1;
+        ListQuery query;
+        if (const auto err = paginate(*sql, opts, pagination, query); !err.empty())
+        {
+            response["error"] = err;
+            return response;
+        }
+
+        soci::row row;
+        const auto st = prepareListStatement(*sql, query);
+        bindListStatement(*st, query, row);
+        st->execute(false);
+
+        nlohmann::json list = nlohmann::json::array();
+        std::string next_cursor;
+        while (st->fetch())
+        {
+            auto row_json = parseDbRowToJson(row);
+            if (m_tableType == "auth")
+            {
+                // Remove password fields from the response data
+                row_json.erase("password");
+            }
+            for (const auto& column : query.hidden) row_json.erase(column);
+            list.push_back(row_json);
+
+            // A full page may have more records after it
+            if (query.keyset && static_cast<int>(list.size()) == query.limit)
+                next_cursor = encodeCursor(row);
+        }
+
+        if (query.keyset)
+            pagination["nextCursor"] = next_cursor.empty() ? json(nullptr) : json(next_cursor);
+
+        // Set response data
+        response["data"] = list;
+        response["pagination"] = pagination;
+
+        return response;
+    }
+
+    std::string TableUnit::list_records_json(const json& opts, std::string& body)
+    {
+        TRACE_CLASS_METHOD()
+        const auto sql = MantisApp::instance().db().readSession();
+
+        auto pagination = opts.value("pagination", json::object());
+        ListQuery query;
+        if (const auto err = paginate(*sql, opts, pagination, query); !err.empty())
+            return err;
+
+        soci::row row;
+        const auto st = prepareListStatement(*sql, query);
+        bindListStatement(*st, query, row);
+        st->execute(false);
+
+        // Keys are written in sorted order, same as the json response objects
+        JsonWriter w(body);
+        w.beginObject();
+        w.key("data");
+        w.beginArray();
+
+        // Column types & order are the same for all rows, resolve them once
+        std::vector<RowColumn> columns;
+        std::string next_cursor;
+        int count = 0;
+        while (st->fetch())
+        {
+            if (columns.empty())
+            {
+                // Remove password fields from the response data
+                auto hidden = query.hidden;
+                if (m_tableType == "auth") hidden.emplace_back("password");
+                columns = rowColumns(row, m_fields, hidden);
+            }
+
+            writeDbRowJson(w, row, columns);
+
+            // A full page may have more records after it
+            if (query.keyset && ++count == query.limit)
+                next_cursor = encodeCursor(row);
+        }
+
+        if (query.keyset)
+            pagination["nextCursor"] = next_cursor.empty() ? json(nullptr) : json(next_cursor);
+
+        w.endArray();
+        w.key("error");
+        w.value("");
+        w.key("pagination");
+        w.value(pagination);
+        w.key("status");
+        w.value(200);
+        w.endObject();
+
+        return "";
+    }
+
+    int64_t TableUnit::countRecords(soci::session& sql, const bool exact) const
+    {
+        const auto count_records = [&]() -> int64_t
+        {
+            long long records = 0;
+            const auto st = MantisApp::instance().db().statements().prepare(sql, m_tableName, "count|", [&]
+            {
+                return "SELECT COUNT(id) FROM " + m_tableName;
+            });
+            st->exchange(soci::into(records));
+            st->define_and_bind();
+            st->execute(true);
+            return records;
+        };
+
+        auto& counters = MantisApp::instance().db().counters();
+        return exact ? counters.refresh(m_tableName, count_records) : counters.get(m_tableName, count_records);
+    }
+
+    std::string TableUnit::paginate(soci::session& sql, const json& opts, json& pagination, ListQuery& query) const
+    {
+        // Compile filter & sort first, the count has to apply the same filter
+        try
+        {
+            query.compiled = QueryFilter(m_fields).compile(opts.value("filter", ""), opts.value("sort", ""));
+        }
+        catch (const std::invalid_argument& e)
+        {
+            return e.what();
+        }
+
+        if (const auto err = selectColumns(opts.value("fields", ""), query.columns); !err.empty())
+            return err;
+
+        int64_t count = -1;
         if (pagination.at("countPages").get<bool>())
         {
             // Let's count total records, unless switched off
             // TODO this assumes all tables have `id`, which should for now
-            *sql << "SELECT COUNT(id) FROM " + tableName(), soci::into(count);
+            const auto count_records = [&]() -> int64_t
+            {
+                long long records = 0;
+                soci::values vals;
+                QueryFilter::bind(vals, query.compiled.params);
+
+                const auto where = query.compiled.where;
+                const auto st = MantisApp::instance().db().statements().prepare(sql, m_tableName, "count|" + where, [&]
+                {
+                    return "SELECT COUNT(id) FROM " + m_tableName + " WHERE " + where;
+                });
+                st->exchange(soci::use(vals));
+                st->exchange(soci::into(records));
+                st->define_and_bind();
+                st->execute(true);
+                return records;
+            };
+
+            // Served from memory, unless filtered or an exact count is requested
+            if (!query.compiled.where.empty())
+                count = count_records();
+            else if (pagination.contains("counted"))
+                count = pagination.at("counted").get<int64_t>();
+            else
+                count = countRecords(sql, pagination.value("exactCount", false));
         }
+        pagination.erase("exactCount");
+        pagination.erase("counted");
 
         // Extract the page number and page size
         const auto page = pagination.at("pageIndex").get<int>();
         const auto perPage = pagination.at("perPage").get<int>();
 
         if (perPage <= 0)
-        {
-            response["error"] = "Page size must be greater than 0";
-            return response;
-        }
-        if (page <= 0)
-        {
-            response["error"] = "Page index must be greater than 0";
-            return response;
-        }
-        const auto offset = (page - 1) * perPage;
+            return "Page size must be greater than 0";
 
-        const auto query = "SELECT * FROM " + tableName() + " ORDER BY created DESC LIMIT :limit OFFSET :offset";
-        const soci::rowset<soci::row> rs = (sql->prepare << query, soci::use(perPage), soci::use(offset));
-        nlohmann::json list = nlohmann::json::array();
+        query.limit = perPage;
 
-        for (const auto& row : rs)
+        // Keyset pagination, an empty cursor requests the first page
+        if (pagination.contains("cursor"))
         {
-            auto row_json = parseDbRowToJson(row);
-            if (m_tableType == "auth")
+            if (!query.compiled.orderBy.empty())
+                return "Cursor pagination only supports the default sort";
+
+            query.keyset = true;
+            const auto cursor = pagination.at("cursor").get<std::string>();
+
+            // The next cursor is read from `created`, select it even if not asked for
+            if (const auto selected = splitString(query.columns, ", ");
+                query.columns != "*" && std::ranges::find(selected, "created") == selected.end())
             {
-                // Remove password fields from the response data
-                row_json.erase("password");
+                query.columns += ", created";
+                query.hidden.emplace_back("created");
             }
-            list.push_back(row_json);
+            if (!cursor.empty() && !decodeCursor(cursor, query))
+                return "Invalid pagination cursor";
+
+            pagination.erase("cursor");
+            pagination.erase("pageIndex");
         }
+        else
+        {
+            if (page <= 0)
+                return "Page index must be greater than 0";
 
+            query.offset = (page - 1) * perPage;
+        }
 
         // Update pagination data
         pagination.erase("countPages");
         pagination["pageCount"] = count == -1
                                       ? count
-                                      : static_cast<int>(std::ceil(static_cast<double>(count) / perPage));
+                                      : static_cast<int64_t>(std::ceil(static_cast<double>(count) / perPage));
         pagination["recordCount"] = count;
 
-        // Set response data
-        response["data"] = list;
-        response["pagination"] = pagination;
+        return "";
+    }
 
-        return response;
+    std::optional<json> TableUnit::readRecord(soci::session& sql, const std::string& id,
+                                              const std::string& columns) const
+    {
+        soci::row r; // To hold read data
+        const auto key = columns == "*" ? std::string("read") : "read|" + columns;
+        const auto st = MantisApp::instance().db().statements().prepare(sql, m_tableName, key, [&]
+        {
+            return "SELECT " + columns + " FROM " + m_tableName + " WHERE id = :id";
+        });
+        st->exchange(soci::use(id));
+        st->exchange(soci::into(r));
+        st->define_and_bind();
+        st->execute(true);
+
+        if (!st->got_data()) return std::nullopt;
+
+        // Parse returned record to JSON
+        return parseDbRowToJson(r);
+    }
+
+    std::optional<std::string> TableUnit::updatedAt(soci::session& sql, const std::string& id) const
+    {
+        const auto record = readRecord(sql, id, "id, updated");
+        if (!record.has_value()) return std::nullopt;
+
+        return record->value("updated", "");
+    }
+
+    std::optional<json> TableUnit::writeReturning(soci::session& sql, const std::string& key,
+                                                  const std::string& query, soci::values& values) const
+    {
+        soci::row r;
+        const auto st = MantisApp::instance().db().statements().prepare(sql, m_tableName, key, [&]
+        {
+            return query;
+        });
+        st->exchange(soci::use(values));
+        st->exchange(soci::into(r));
+        st->define_and_bind();
+        st->execute(true);
+
+        std::optional<json> record;
+        if (st->got_data()) record = parseDbRowToJson(r);
+
+        // Run the statement to completion, SQLite can't commit while a write statement is in progress
+        while (st->fetch())
+        {
+        }
+
+        return record;
+    }
+
+    CachedStatement TableUnit::prepareListStatement(soci::session& sql, const ListQuery& query) const
+    {
+        std::vector<std::string> conditions;
+        if (!query.compiled.where.empty())
+            conditions.push_back("(" + query.compiled.where + ")");
+
+        // Seek on `(created, id)`, served by the keyset index, see Table::to_index_sql()
+        if (query.seek)
+            conditions.emplace_back(
+                "(created < :cursor_created OR (created = :cursor_eq_created AND id < :cursor_id))");
+
+        std::string sql_query = "SELECT " + query.columns + " FROM " + m_tableName;
+        for (size_t i = 0; i < conditions.size(); ++i)
+            sql_query += (i == 0 ? " WHERE " : " AND ") + conditions[i];
+
+        if (!query.compiled.orderBy.empty())
+            sql_query += " ORDER BY " + query.compiled.orderBy;
+        else if (query.keyset)
+            sql_query += " ORDER BY created DESC, id DESC";
+        else
+            sql_query += " ORDER BY created DESC";
+
+        sql_query += query.keyset ? " LIMIT :limit" : " LIMIT :limit OFFSET :offset";
+
+        // Same SQL, same statement, filter values are bound on each execution
+        return MantisApp::instance().db().statements().prepare(sql, m_tableName, "list|" + sql_query, [&]
+        {
+            return sql_query;
+        });
+    }
+
+    void TableUnit::bindListStatement(soci::statement& st, ListQuery& query, soci::row& row)
+    {
+        // All values are bound by name
+        QueryFilter::bind(query.values, query.compiled.params);
+
+        if (query.seek)
+        {
+            query.values.set("cursor_created", query.created);
+            query.values.set("cursor_eq_created", query.created);
+            query.values.set("cursor_id", query.id);
+        }
+
+        query.values.set("limit", query.limit);
+        if (!query.keyset) query.values.set("offset", query.offset);
+
+        st.exchange(soci::use(query.values));
+        st.exchange(soci::into(row));
+        st.define_and_bind();
+    }
+
+    std::string TableUnit::encodeCursor(const soci::row& row)
+    {
+        std::string created;
+        for (size_t i = 0; i < row.size(); ++i)
+        {
+            if (row.get_properties(i).get_name() == "created")
+            {
+                created = dbDateToString(MantisApp::instance().dbTypeByName(), row, static_cast<int>(i));
+                break;
+            }
+        }
+
+        return base64UrlEncode(json::array({created, row.get<std::string>("id")}).dump());
+    }
+
+    bool TableUnit::decodeCursor(const std::string& cursor, ListQuery& query)
+    {
+        const auto decoded = base64UrlDecode(cursor);
+        if (!decoded.has_value()) return false;
+
+        const auto key = tryParseJsonStr(decoded.value());
+        if (!key.has_value() || !key->is_array() || key->size() != 2 ||
+            !key->at(0).is_string() || !key->at(1).is_string())
+            return false;
+
+        try
+        {
+            query.created = strToTM(key->at(0).get<std::string>());
+        }
+        catch (const std::exception&)
+        {
+            return false;
+        }
+
+        query.id = key->at(1).get<std::string>();
+        query.seek = true;
+        return true;
     }
 }
@@ -3,6 +3,7 @@
 #include "../../include/mantis/core/database.h"
 #include "../../include/mantis/utils/utils.h"
 #include "../../include/mantis/core/fileunit.h"
+#include "../../include/mantis/core/exporter.h"
 
 #include <iostream>
 #include <fstream>
@@ -40,6 +41,37 @@ namespace mantis
                 }
             );
 
+            // Export All Records, ahead of `/:id` which would match it too
+            Log::debug("Creating route: [{:>6}] {}{}", "GET", basePath, "/export");
+            MantisApp::instance().http().Get(
+                basePath + "/export",
+                [this](MantisRequest& req, MantisResponse& res)-> void
+                {
+                    exportRecords(req, res);
+                },
+                {
+                    [](MantisRequest& req, MantisResponse& res)-> bool
+                    {
+                        return getAuthToken(req, res);
+                    },
+                    [this](MantisRequest& req, MantisResponse& res)-> bool
+                    {
+                        // Exports list records, they're granted by the list rule
+                        if (const auto denied = checkAccess(listRule(), resolveAuth(req), requestVars(req));
+                            denied.has_value())
+                        {
+                            json response = denied.value();
+                            response["data"] = json::object();
+
+                            res.sendJson(response.at("status").get<int>(), response);
+                            return REQUEST_HANDLED;
+                        }
+
+                        return REQUEST_PENDING;
+                    }
+                }
+            );
+
             // Fetch Single Record
             Log::debug("Creating route: [{:>6}] {}{}", "GET/1", basePath, "/:id");
             MantisApp::instance().http().Get(
@@ -178,8 +210,23 @@ namespace mantis
             // For every read, check that the optional<T> has a value.
             // If it's not null, get the data and respond back to the client
             // else, handle the 404 NOT FOUND response to the client
-            if (const auto resp = read(id, json::object()); resp.has_value())
+            json opts = json::object();
+            if (req.hasQueryParam("fields")) opts["fields"] = req.getQueryParamValue("fields");
+
+            if (const auto resp = read(id, opts); resp.has_value())
             {
+                // Weak ETag of the record's content, as returned for the requested fields. `updated`
+                // alone has a 1s resolution, writes within the same second would share a tag.
+                const auto etag = std::format("W/\"{}-{:x}\"", id, std::hash<std::string>{}(resp->dump()));
+                res.setHeader("ETag", etag);
+
+                // Client has it already, skip sending it
+                if (etagMatches(req.getHeaderValue("If-None-Match", "", 0), etag))
+                {
+                    res.sendEmpty(304);
+                    return;
+                }
+
                 response["status"] = 200;
                 response["error"] = "";
                 response["data"] = resp.value();
@@ -195,6 +242,16 @@ namespace mantis
             res.sendJson(404, response);
         }
 
+        // Fields that can't be selected
+        catch (const std::invalid_argument& e)
+        {
+            response["status"] = 400;
+            response["error"] = e.what();
+            response["data"] = json::object();
+
+            res.sendJson(400, response);
+        }
+
         // For any server errors, send it back to the client
         // Capture std::exception, and a catch-all block as well
         catch (const std::exception& e)
@@ -234,6 +291,16 @@ namespace mantis
         if (req.hasQueryParam("pageIndex") && !req.getQueryParamValue("pageIndex").empty())
             pagination["pageIndex"] = std::stoi(req.getQueryParamValue("pageIndex"));
 
+        // Page counts are served from memory by default, ask for a fresh `COUNT` with `exactCount=true`
+        if (req.hasQueryParam("exactCount") && !req.getQueryParamValue("exactCount").empty())
+            pagination["exactCount"] = strToBool(req.getQueryParamValue("exactCount"));
+
+        // Keyset pagination, pass the `nextCursor` of the previous page, or an empty value for the first page
+        if (req.hasQueryParam("cursor"))
+            pagination["cursor"] = req.getQueryParamValue("cursor");
+        else if (req.hasQueryParam("after"))
+            pagination["cursor"] = req.getQueryParamValue("after");
+
         if (req.hasQueryParam("countPages") && !req.getQueryParamValue("countPages").empty())
         {
             const std::string value = req.getQueryParamValue("countPages");
@@ -245,22 +312,54 @@ namespace mantis
         {
             json opts;
             opts["pagination"] = pagination;
-            const auto resp = list_records(opts);
-            if (const auto err = resp.value("error", ""); !err.empty())
+
+            // Filter & sort expressions, see QueryFilter for the syntax
+            if (req.hasQueryParam("filter")) opts["filter"] = req.getQueryParamValue("filter");
+            if (req.hasQueryParam("sort")) opts["sort"] = req.getQueryParamValue("sort");
+
+            // Sparse fieldset, e.g. `fields=name,email`, `id` is always included
+            if (req.hasQueryParam("fields")) opts["fields"] = req.getQueryParamValue("fields");
+
+            // Weak ETag of the page, from the table's change version taken ahead of the read; a
+            // write racing the read changes the version, a stale tag can't match after it
+            auto etag = std::format("W/\"{}-{:x}",
+                                    MantisApp::instance().db().versions().tag(m_tableName),
+                                    std::hash<std::string>{}(opts.dump()));
+
+            // An unfiltered `total` comes from the record counter, which may resync it without
+            // a write, e.g. on counter drift; tag the count as served, loading it if stale
+            if (pagination.at("countPages").get<bool>() && opts.value("filter", "").empty())
+            {
+                const auto total = countRecords(*MantisApp::instance().db().readSession(),
+                                                pagination.value("exactCount", false));
+                etag += std::format("-{}", total);
+
+                // The page serves this same count, rather than counting again
+                opts["pagination"]["counted"] = total;
+            }
+            etag += "\"";
+
+            if (etagMatches(req.getHeaderValue("If-None-Match", "", 0), etag))
+            {
+                res.setHeader("ETag", etag);
+                res.sendEmpty(304);
+                return;
+            }
+
+            // Rows are serialized straight into the response body
+            std::string body;
+            if (const auto err = list_records_json(opts, body); !err.empty())
             {
                 response["data"] = json::array();
                 response["status"] = 400;
                 response["error"] = err;
 
                 res.sendJson(400, response);
+                return;
             }
 
-            response["data"] = resp["data"];
-            response["pagination"] = resp["pagination"];
-            response["status"] = 200;
-            response["error"] = "";
-
-            res.sendJson(200, response);
+            res.setHeader("ETag", etag);
+            res.sendRawJson(200, std::move(body));
         }
 
         catch (const std::exception& e)
@@ -282,6 +381,88 @@ namespace mantis
         }
     }
 
+    void TableUnit::exportRecords(MantisRequest& req, MantisResponse& res)
+    {
+        TRACE_CLASS_METHOD()
+
+        json response;
+        const auto sendError = [&](const int status, const std::string& error)
+        {
+            response["data"] = json::array();
+            response["status"] = status;
+            response["error"] = error;
+
+            res.sendJson(status, response);
+        };
+
+        try
+        {
+            const auto format = req.hasQueryParam("format") ? req.getQueryParamValue("format") : "ndjson";
+            auto exporter = std::make_shared<RecordExporter>(format);
+            if (!exporter->acquire(RecordExporter::slots()))
+            {
+                sendError(503, "Too many exports running, try again later");
+                return;
+            }
+
+            json opts = json::object();
+            if (req.hasQueryParam("filter")) opts["filter"] = req.getQueryParamValue("filter");
+            if (req.hasQueryParam("sort")) opts["sort"] = req.getQueryParamValue("sort");
+            if (req.hasQueryParam("fields")) opts["fields"] = req.getQueryParamValue("fields");
+
+            if (const auto err = exporter->open(*this, opts); !err.empty())
+            {
+                sendError(400, err);
+                return;
+            }
+
+            // Rows are read & sent a chunk at a time, once the handler has returned
+            const auto table_name = m_tableName;
+            res.setStatus(200);
+            res.setHeader("Content-Disposition", std::format("attachment; filename=\"{}.{}\"", table_name, format));
+            res.setChunkedContentProvider(
+                exporter->contentType(),
+                [exporter, table_name](size_t, httplib::DataSink& sink) -> bool
+                {
+                    try
+                    {
+                        if (std::string chunk; exporter->next(chunk))
+                            return sink.write(chunk.data(), chunk.size());
+
+                        sink.done();
+                        return true;
+                    }
+                    catch (const std::exception& e)
+                    {
+                        // Headers are out already, cut the response short
+                        Log::critical("Export of `{}` failed after {} records: {}", table_name, exporter->rows(),
+                                      e.what());
+                        return false;
+                    }
+                },
+                [exporter, table_name](const bool success)
+                {
+                    Log::debug("Exported {} records of `{}`{}", exporter->rows(), table_name,
+                               success ? "" : ", response incomplete");
+                });
+        }
+
+        catch (const std::invalid_argument& e)
+        {
+            sendError(400, e.what());
+        }
+
+        catch (const std::exception& e)
+        {
+            sendError(500, e.what());
+        }
+
+        catch (...)
+        {
+            sendError(500, "Internal Server Error");
+        }
+    }
+
     void TableUnit::createRecord(MantisRequest& req, MantisResponse& res, const MantisContentReader& reader)
     {
         TRACE_CLASS_METHOD()
@@ -562,8 +743,12 @@ namespace mantis
             }
         }
 
+        // Sparse fieldset of the record sent back
+        json opts = json::object();
+        if (req.hasQueryParam("fields")) opts["fields"] = req.getQueryParamValue("fields");
+
         // Try creating the record, if it checkMinValueFuncs, return the error
-        auto respObj = create(body, json{});
+        auto respObj = create(body, opts);
         if (!respObj.value("error", "").empty())
         {
             int status = respObj.value("status", 500);
@@ -905,8 +1090,12 @@ namespace mantis
             }
         }
 
+        // Sparse fieldset of the record sent back
+        json opts = json::object();
+        if (req.hasQueryParam("fields")) opts["fields"] = req.getQueryParamValue("fields");
+
         // Try creating the record, if it checkMinValueFuncs, return the error
-        auto respObj = update(id, body, json{});
+        auto respObj = update(id, body, opts);
         if (!respObj.value("error", "").empty())
         {
             int status = respObj.value("status", 500);
@@ -21,6 +21,30 @@ namespace mantis
         return std::nullopt;
     }
 
+    std::string TableUnit::selectColumns(const std::string& fields, std::string& columns) const
+    {
+        columns = "*";
+        if (trim(fields).empty()) return "";
+
+        // Records stay addressable, `id` is always selected
+        columns = "id";
+        std::vector<std::string> selected{"id"};
+        for (const auto& part : splitString(fields, ","))
+        {
+            const auto name = trim(part);
+            if (name.empty() || std::ranges::find(selected, name) != selected.end()) continue;
+
+            // Password hashes are never returned, don't read them either
+            if (!findFieldByKey(name).has_value() || (m_tableType == "auth" && name == "password"))
+                return std::format("Field `{}` can't be selected", name);
+
+            selected.push_back(name);
+            columns += ", " + name;
+        }
+
+        return "";
+    }
+
     json TableUnit::checkValueInColumns(const std::string& value, const std::vector<std::string>& columns) const
     {
         // default response object
@@ -164,6 +188,131 @@ namespace mantis
         return j;
     }
 
+    std::vector<TableUnit::RowColumn> TableUnit::rowColumns(const soci::row& row,
+                                                            const std::vector<json>& ref_fields,
+                                                            const std::vector<std::string>& hidden) const
+    {
+        // Guard against empty reference schema fields
+        if (ref_fields.empty())
+            throw std::runtime_error(std::format("Parse db row error, empty reference schema fields passed!"));
+
+        std::vector<RowColumn> columns;
+        columns.reserve(row.size());
+        for (size_t i = 0; i < row.size(); i++)
+        {
+            const auto colName = row.get_properties(i).get_name();
+            if (std::find(hidden.begin(), hidden.end(), colName) != hidden.end())
+                continue;
+
+            const auto colType = getColTypeFromName(colName, ref_fields);
+
+            // Check column type is valid type
+            if (colType.empty() || !isValidFieldType(colType)) // Or not in expected types
+            {
+                // Throw an error for unknown types
+                throw std::runtime_error(std::format("Unknown column type `{}` for column `{}`", colType, colName));
+            }
+
+            // TODO ? How do we handle BLOB? Left out, same as parseDbRowToJson
+            if (colType == "blob") continue;
+
+            columns.push_back({i, colName, colType});
+        }
+
+        // json objects order their keys, keep the same order
+        std::sort(columns.begin(), columns.end(), [](const RowColumn& a, const RowColumn& b)
+        {
+            return a.name < b.name;
+        });
+
+        return columns;
+    }
+
+    void TableUnit::writeDbRowJson(JsonWriter& w, const soci::row& row, const std::vector<RowColumn>& columns)
+    {
+        w.beginObject();
+        for (const auto& column : columns)
+        {
+            w.key(column.name);
+            writeDbValueJson(w, row, column);
+        }
+        w.endObject();
+    }
+
+    void TableUnit::writeDbValueJson(JsonWriter& w, const soci::row& row, const RowColumn& column)
+    {
+        const auto& [i, colName, colType] = column;
+
+        // Handle null values immediately
+        if (row.get_indicator(i) == soci::i_null)
+        {
+            w.null();
+            return;
+        }
+
+        // Handle type conversions
+        if (colType == "xml" || colType == "string" || colType == "file")
+        {
+            w.value(row.get<std::string>(i, ""));
+        }
+        else if (colType == "double")
+        {
+            w.value(row.get<double>(i));
+        }
+        else if (colType == "date")
+        {
+            w.value(mantis::dbDateToString(MantisApp::instance().dbTypeByName(), row, static_cast<int>(i)));
+        }
+        else if (colType == "int8")
+        {
+            w.value(static_cast<int64_t>(row.get<int8_t>(i)));
+        }
+        else if (colType == "uint8")
+        {
+            w.value(static_cast<uint64_t>(row.get<uint8_t>(i)));
+        }
+        else if (colType == "int16")
+        {
+            w.value(static_cast<int64_t>(row.get<int16_t>(i)));
+        }
+        else if (colType == "uint16")
+        {
+            w.value(static_cast<uint64_t>(row.get<uint16_t>(i)));
+        }
+        else if (colType == "int32")
+        {
+            w.value(static_cast<int64_t>(row.get<int32_t>(i)));
+        }
+        else if (colType == "uint32")
+        {
+            w.value(static_cast<uint64_t>(row.get<uint32_t>(i)));
+        }
+        else if (colType == "int64")
+        {
+            w.value(row.get<int64_t>(i));
+        }
+        else if (colType == "uint64")
+        {
+            w.value(row.get<uint64_t>(i));
+        }
+        else if (colType == "json" || colType == "list" || colType == "files")
+        {
+            // Stored as serialized JSON, written the way `json::dump()` writes it for json responses
+            try
+            {
+                w.jsonText(row.get<std::string>(i, ""));
+            }
+            catch (const std::invalid_argument&)
+            {
+                throw std::runtime_error(std::format("Invalid JSON value for column `{}`", colName));
+            }
+        }
+        else if (colType == "bool")
+        {
+            w.value(row.get<bool>(i));
+        }
+    }
+
     json TableUnit::getValueFromType(const std::string& type, const std::string& value)
     {
         json obj;
@@ -194,7 +343,8 @@ namespace mantis
         return obj;
     }
 
-    std::optional<json> TableUnit::bindEntityToSociValue(soci::values& vals, const json& entity) const
+    std::optional<json> TableUnit::bindEntityToSociValue(soci::values& vals, const json& entity,
+                                                     const std::string& suffix) const
     {
         // Bind parameters dynamically
         for (const auto& field : m_fields)
@@ -212,7 +362,7 @@ namespace mantis
                 // Extract password value and hash it
                 auto hashed_pswd = hashPassword(entity.at(field_name).get<std::string>());
                 // Add the hashed password to the soci::vals
-                vals.set(field_name, hashed_pswd);
+                vals.set(field_name + suffix, hashed_pswd);
             }
 
             else
@@ -224,7 +374,7 @@ namespace mantis
                 if (entity[field_name].is_null())
                 {
                     std::optional<int> val; // Set to optional, no value is set in db
-                    vals.set(field_name, val, soci::i_null);
+                    vals.set(field_name + suffix, val, soci::i_null);
                     continue;
                 }
 
@@ -232,12 +382,12 @@ namespace mantis
                 const auto field_type = field.at("type").get<std::string>();
                 if (field_type == "xml" || field_type == "string" || field_type == "file")
                 {
-                    vals.set(field_name, entity.value(field_name, ""));
+                    vals.set(field_name + suffix, entity.value(field_name, ""));
                 }
 
                 else if (field_type == "double")
                 {
-                    vals.set(field_name, entity.value(field_name, 0.0));
+                    vals.set(field_name + suffix, entity.value(field_name, 0.0));
                 }
 
                 else if (field_type == "date")
@@ -245,7 +395,7 @@ namespace mantis
                     auto dt_str = entity.value(field_name, "");
                     if (dt_str.empty())
                     {
-                        vals.set(field_name, 0, soci::i_null);
+                        vals.set(field_name + suffix, 0, soci::i_null);
                     }
                     else
                     {
@@ -253,69 +403,69 @@ namespace mantis
                         std::istringstream ss{dt_str};
                         ss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
 
-                        vals.set(field_name, tm);
+                        vals.set(field_name + suffix, tm);
                     }
                 }
 
                 else if (field_type == "int8")
                 {
-                    vals.set(field_name, static_cast<int8_t>(entity.value(field_name, 0)));
+                    vals.set(field_name + suffix, static_cast<int8_t>(entity.value(field_name, 0)));
                 }
 
                 else if (field_type == "uint8")
                 {
-                    vals.set(field_name, static_cast<uint8_t>(entity.value(field_name, 0)));
+                    vals.set(field_name + suffix, static_cast<uint8_t>(entity.value(field_name, 0)));
                 }
 
                 else if (field_type == "int16")
                 {
-                    vals.set(field_name, static_cast<int16_t>(entity.value(field_name, 0)));
+                    vals.set(field_name + suffix, static_cast<int16_t>(entity.value(field_name, 0)));
                 }
 
                 else if (field_type == "uint16")
                 {
-                    vals.set(field_name, static_cast<uint16_t>(entity.value(field_name, 0)));
+                    vals.set(field_name + suffix, static_cast<uint16_t>(entity.value(field_name, 0)));
                 }
 
                 else if (field_type == "int32")
                 {
-                    vals.set(field_name, static_cast<int32_t>(entity.value(field_name, 0)));
+                    vals.set(field_name + suffix, static_cast<int32_t>(entity.value(field_name, 0)));
                 }
 
                 else if (field_type == "uint32")
                 {
-                    vals.set(field_name, static_cast<uint32_t>(entity.value(field_name, 0)));
+                    vals.set(field_name + suffix, static_cast<uint32_t>(entity.value(field_name, 0)));
                 }
 
                 else if (field_type == "int64")
                 {
-                    vals.set(field_name, static_cast<int64_t>(entity.value(field_name, 0)));
+                    vals.set(field_name + suffix, static_cast<int64_t>(entity.value(field_name, 0)));
                 }
 
                 else if (field_type == "uint64")
                 {
-                    vals.set(field_name, static_cast<uint64_t>(entity.value(field_name, 0)));
+                    vals.set(field_name + suffix, static_cast<uint64_t>(entity.value(field_name, 0)));
                 }
 
                 else if (field_type == "blob")
                 {
                     // TODO implement BLOB type
-                    // vals.set(field_name, entity.value(field_name, sql->empty_blob()));
+                    // vals.set(field_name + suffix, entity.value(field_name, sql->empty_blob()));
                 }
 
                 else if (field_type == "json")
                 {
-                    vals.set(field_name, entity.value(field_name, json::object()));
+                    vals.set(field_name + suffix, entity.value(field_name, json::object()));
                 }
 
                 else if (field_type == "bool")
                 {
-                    vals.set(field_name, entity.value(field_name, false));
+                    vals.set(field_name + suffix, entity.value(field_name, false));
                 }
 
                 else if (field_type == "files")
                 {
-                    vals.set(field_name, entity.value(field_name, json::array()));
+                    vals.set(field_name + suffix, entity.value(field_name, json::array()));
                 }
             }
         }
@@ -339,14 +489,33 @@ namespace mantis
         return "";
     }
 
+    std::string TableUnit::newRecordId() const
+    {
+        // Time-ordered ids append to the end of the primary key index
+        return m_idStrategy == "sortable" ? generateSortableId() : generateShortId();
+    }
+
+    bool TableUnit::isIdConflict(const soci::soci_error& e) const
+    {
+        const std::string msg = e.what();
+        return msg.find("UNIQUE constraint failed: " + m_tableName + ".id") != std::string::npos // SQLite
+            || msg.find(m_tableName + "_pkey") != std::string::npos; // PostgreSQL
+    }
+
     bool TableUnit::recordExists(const std::string& id) const
     {
         try
         {
-            int count;
+            int count = 0;
             const auto sql = MantisApp::instance().db().session();
-            *sql << "SELECT COUNT(*) FROM " + m_tableName + " WHERE id = :id LIMIT 1",
-                soci::use(id), soci::into(count);
+            const auto st = MantisApp::instance().db().statements().prepare(*sql, m_tableName, "exists", [&]
+            {
+                return "SELECT COUNT(*) FROM " + m_tableName + " WHERE id = :id LIMIT 1";
+            });
+            st->exchange(soci::use(id));
+            st->exchange(soci::into(count));
+            st->define_and_bind();
+            st->execute(true);
             return count > 0;
         }
         catch (soci::soci_error& e)
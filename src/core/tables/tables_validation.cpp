@@ -305,6 +305,29 @@ namespace mantis
             }
         }
 
+        return validateRules(entity);
+    }
+
+    std::optional<json> TableUnit::validateRules(const json& entity)
+    {
+        for (const auto& key : {"listRule", "getRule", "addRule", "updateRule", "deleteRule"})
+        {
+            if (!entity.contains(key) || !entity[key].is_string())
+                continue;
+
+            // Empty rules restrict access to admins, nothing to compile
+            const auto rule = ExprEvaluator::compile(entity[key].get<std::string>());
+            if (rule.error.empty())
+                continue;
+
+            json response;
+            response["status"] = 400;
+            response["error"] = std::format("`{}` is invalid: {}", key, rule.error);
+            response["data"] = json::object();
+
+            return response;
+        }
+
         return std::nullopt;
     }
 }
@@ -0,0 +1,89 @@
+#include "../../include/mantis/core/token_cache.h"
+
+#include <chrono>
+#include <openssl/evp.h>
+
+#define __file__ "core/token_cache.cpp"
+
+namespace mantis
+{
+    namespace
+    {
+        int64_t nowSeconds()
+        {
+            return std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    std::optional<json> TokenCache::get(const std::string& token, const std::string& context)
+    {
+        useContext(context);
+
+        const auto d = digest(token);
+        std::shared_lock context_lock(m_contextMutex);
+
+        // Switched again meanwhile, the entries are of another context
+        if (m_context != context) return std::nullopt;
+
+        return m_tokens.get(d);
+    }
+
+    void TokenCache::put(const std::string& token, const std::string& context, const json& claims)
+    {
+        if (!claims.contains("exp") || !claims["exp"].is_number()) return;
+
+        const auto expires_in = claims["exp"].get<int64_t>() - nowSeconds();
+        if (expires_in <= 0) return;
+
+        useContext(context);
+
+        const auto d = digest(token);
+        std::shared_lock context_lock(m_contextMutex);
+
+        // Switched again meanwhile, the token was verified under a stale context
+        if (m_context != context) return;
+
+        m_tokens.put(d, claims, std::chrono::steady_clock::now() + std::chrono::seconds(expires_in));
+    }
+
+    void TokenCache::clear()
+    {
+        ++m_clears;
+        m_tokens.clear();
+    }
+
+    json TokenCache::stats() const
+    {
+        auto stats = m_tokens.stats();
+        stats.erase("invalidations");
+        stats["clears"] = m_clears.load();
+        return stats;
+    }
+
+    std::string TokenCache::digest(const std::string& token)
+    {
+        unsigned char md[EVP_MAX_MD_SIZE];
+        unsigned int length = 0;
+        if (EVP_Digest(token.data(), token.size(), md, &length, EVP_sha256(), nullptr) != 1)
+            throw std::runtime_error("Could not digest token");
+
+        return {reinterpret_cast<const char*>(md), length};
+    }
+
+    void TokenCache::useContext(const std::string& context)
+    {
+        {
+            std::shared_lock lock(m_contextMutex);
+            if (m_context == context) return;
+        }
+
+        std::unique_lock lock(m_contextMutex);
+        if (m_context == context) return;
+
+        // Entries verified under the previous secret, issuer or audience
+        const bool first = m_context.empty();
+        m_context = context;
+        if (!first) clear();
+    }
+}
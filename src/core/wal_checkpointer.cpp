@@ -0,0 +1,217 @@
+#include "../../include/mantis/core/wal_checkpointer.h"
+#include "../../include/mantis/core/logging.h"
+
+#include <format>
+
+#define __file__ "core/wal_checkpointer.cpp"
+
+namespace mantis
+{
+    WalCheckpointer::WalCheckpointer(std::unique_ptr<soci::session> sql, std::filesystem::path walPath)
+        : m_sql(std::move(sql)),
+          m_walPath(std::move(walPath))
+    {
+    }
+
+    WalCheckpointer::~WalCheckpointer()
+    {
+        stop();
+    }
+
+    void WalCheckpointer::start()
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_thread.joinable()) return;
+
+        {
+            std::lock_guard sql_lock(m_sqlMutex);
+
+            // Don't hold up writers for long while waiting on readers
+            *m_sql << std::format("PRAGMA busy_timeout={}", BUSY_TIMEOUT);
+
+            // Each WAL frame is a page plus its 24 bytes header
+            long long page_size = 0;
+            *m_sql << "PRAGMA page_size", soci::into(page_size);
+            m_frameSize = static_cast<std::uintmax_t>(page_size) + 24;
+        }
+
+        m_stop = false;
+        m_thread = std::thread(&WalCheckpointer::run, this);
+    }
+
+    void WalCheckpointer::stop()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            if (!m_thread.joinable()) return;
+            m_stop = true;
+        }
+
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    bool WalCheckpointer::checkpoint(const std::string& mode)
+    {
+        std::lock_guard lock(m_sqlMutex);
+
+        int busy = 0;
+        long long frames = 0, backfilled = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        try
+        {
+            *m_sql << std::format("PRAGMA wal_checkpoint({})", mode),
+                soci::into(busy), soci::into(frames), soci::into(backfilled);
+        }
+        catch (const std::exception& e)
+        {
+            ++m_failed;
+            Log::warn("WAL checkpoint ({}) failed: {}", mode, e.what());
+            return false;
+        }
+
+        const auto micros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count());
+
+        m_totalMicros += micros;
+        m_lastMicros = micros;
+        if (micros > m_maxMicros.load()) m_maxMicros = micros;
+
+        if (mode == "PASSIVE") ++m_passive;
+        else if (mode == "RESTART") ++m_restarts;
+        else if (mode == "TRUNCATE") ++m_truncates;
+
+        // Not in WAL mode
+        if (frames < 0) return busy == 0;
+
+        // Backfilled frames count up until the WAL is reset, add whatever is new since last time
+        m_framesCheckpointed += backfilled >= m_backfilled ? backfilled - m_backfilled : backfilled;
+        m_backfilled = backfilled;
+        m_walFrames = frames;
+
+        if (busy != 0)
+        {
+            ++m_busy;
+            return false;
+        }
+
+        // The next writer starts over from the beginning of the WAL
+        if (mode == "RESTART" || mode == "TRUNCATE")
+        {
+            m_backfilled = 0;
+            m_walFrames = 0;
+        }
+
+        return true;
+    }
+
+    soci::session& WalCheckpointer::session() const
+    {
+        return *m_sql;
+    }
+
+    std::uintmax_t WalCheckpointer::walSize() const
+    {
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(m_walPath, ec);
+        return ec ? 0 : size;
+    }
+
+    json WalCheckpointer::stats() const
+    {
+        const auto checkpoints = m_passive.load() + m_restarts.load() + m_truncates.load();
+
+        return {
+            {"walSize", walSize()},
+            {"walFrames", m_walFrames.load()},
+            {"framesCheckpointed", m_framesCheckpointed.load()},
+            {"passive", m_passive.load()},
+            {"restart", m_restarts.load()},
+            {"truncate", m_truncates.load()},
+            {"busy", m_busy.load()},
+            {"failed", m_failed.load()},
+            {"lastDurationMs", static_cast<double>(m_lastMicros.load()) / 1000.0},
+            {"maxDurationMs", static_cast<double>(m_maxMicros.load()) / 1000.0},
+            {
+                "avgDurationMs", checkpoints == 0
+                                     ? 0.0
+                                     : static_cast<double>(m_totalMicros.load()) / 1000.0 / static_cast<double>(checkpoints)
+            }
+        };
+    }
+
+    void WalCheckpointer::run()
+    {
+        using clock = std::chrono::steady_clock;
+
+        auto last_write = clock::now();
+        auto last_passive = clock::now();
+        auto last_blocking = clock::time_point{};
+        bool dirty = false, truncated = false;
+
+        while (true)
+        {
+            {
+                std::unique_lock lock(m_mutex);
+                if (m_cv.wait_for(lock, TICK_INTERVAL, [this] { return m_stop; })) break;
+            }
+
+            try
+            {
+                const auto now = clock::now();
+                if (hasNewWrites())
+                {
+                    last_write = now;
+                    dirty = true;
+                    truncated = false;
+                }
+
+                // Copy new frames into the database, never waits on anyone
+                if (dirty && (now - last_passive >= PASSIVE_INTERVAL || walSize() >= WAL_SIZE_THRESHOLD))
+                {
+                    checkpoint("PASSIVE");
+                    last_passive = now;
+                    dirty = false;
+                }
+
+                // Blocking checkpoints are retried at the passive interval at most
+                if (now - last_blocking < PASSIVE_INTERVAL) continue;
+
+                if (walContentSize() >= WAL_SIZE_LIMIT)
+                {
+                    // Have the next writer start over from the beginning of the WAL
+                    last_blocking = now;
+                    checkpoint("RESTART");
+                }
+                else if (!truncated && now - last_write >= IDLE_TIMEOUT && walSize() > 0)
+                {
+                    // Nothing is being written, give the disk space back
+                    last_blocking = now;
+                    truncated = checkpoint("TRUNCATE");
+                }
+            }
+            catch (const std::exception& e)
+            {
+                Log::warn("WAL checkpointer error: {}", e.what());
+            }
+        }
+    }
+
+    bool WalCheckpointer::hasNewWrites()
+    {
+        std::lock_guard lock(m_sqlMutex);
+
+        long long version = 0;
+        *m_sql << "PRAGMA data_version", soci::into(version);
+
+        const bool changed = version != m_dataVersion;
+        m_dataVersion = version;
+        return changed;
+    }
+
+    std::uintmax_t WalCheckpointer::walContentSize() const
+    {
+        return m_walFrames.load() * m_frameSize;
+    }
+}
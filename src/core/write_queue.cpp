@@ -0,0 +1,184 @@
+#include "../../include/mantis/core/write_queue.h"
+#include "../../include/mantis/core/logging.h"
+#include "../../include/mantis/core/change_feed.h"
+
+#define __file__ "core/write_queue.cpp"
+
+namespace mantis
+{
+    WriteQueue::WriteQueue(std::unique_ptr<soci::session> sql)
+        : m_sql(std::move(sql))
+    {
+    }
+
+    WriteQueue::~WriteQueue()
+    {
+        stop();
+    }
+
+    void WriteQueue::start()
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_thread.joinable()) return;
+
+        m_stop = false;
+        m_thread = std::thread(&WriteQueue::run, this);
+    }
+
+    void WriteQueue::stop()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            if (!m_thread.joinable()) return;
+            m_stop = true;
+        }
+
+        m_cv.notify_all();
+        m_thread.join();
+    }
+
+    bool WriteQueue::submit(const WriteJob& job)
+    {
+        // Nested submission from a running job, we already are within the writer transaction
+        if (std::this_thread::get_id() == m_writerId.load())
+            return job(*m_sql);
+
+        Task task;
+        task.job = &job;
+        auto done = task.done.get_future();
+
+        {
+            std::lock_guard lock(m_mutex);
+            if (!m_thread.joinable() || m_stop)
+                throw std::runtime_error("Database write queue is not running!");
+
+            m_queue.push_back(&task);
+        }
+
+        m_cv.notify_one();
+
+        // Rethrows the job's exception, if any
+        return done.get();
+    }
+
+    void WriteQueue::setChangeFeed(ChangeFeed* feed)
+    {
+        m_changes = feed;
+    }
+
+    soci::session& WriteQueue::session() const
+    {
+        return *m_sql;
+    }
+
+    json WriteQueue::stats() const
+    {
+        const auto batches = m_batches.load();
+        const auto jobs = m_jobs.load();
+
+        return {
+            {"batches", batches},
+            {"jobs", jobs},
+            {"maxBatchSize", m_maxBatch.load()},
+            {"avgBatchSize", batches == 0 ? 0.0 : static_cast<double>(jobs) / static_cast<double>(batches)}
+        };
+    }
+
+    void WriteQueue::run()
+    {
+        // Read by submitting threads, m_thread itself is only safe to touch under m_mutex
+        m_writerId = std::this_thread::get_id();
+
+        while (true)
+        {
+            std::vector<Task*> batch;
+
+            {
+                std::unique_lock lock(m_mutex);
+                m_cv.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+
+                // Drain the queue before exiting
+                if (m_queue.empty() && m_stop) break;
+
+                // Take everything queued up while the previous batch was committing
+                while (!m_queue.empty() && batch.size() < MAX_BATCH_SIZE)
+                {
+                    batch.push_back(m_queue.front());
+                    m_queue.pop_front();
+                }
+            }
+
+            commitBatch(batch);
+        }
+
+        m_writerId = std::thread::id();
+    }
+
+    void WriteQueue::commitBatch(const std::vector<Task*>& batch)
+    {
+        std::vector<std::exception_ptr> errors(batch.size());
+        std::vector<bool> results(batch.size(), false);
+
+        try
+        {
+            if (m_changes) m_changes->prepare(*m_sql);
+            m_sql->begin();
+
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                // Isolate each job, so that a failing job does not take down the whole batch
+                *m_sql << "SAVEPOINT mantis_write";
+                const auto mark = m_changes ? m_changes->mark(*m_sql) : 0;
+
+                try
+                {
+                    results[i] = (*batch[i]->job)(*m_sql);
+                }
+                catch (...)
+                {
+                    errors[i] = std::current_exception();
+                }
+
+                if (!results[i])
+                {
+                    *m_sql << "ROLLBACK TO SAVEPOINT mantis_write";
+                    // No rollback hook for savepoints, drop the job's changes here
+                    if (m_changes) m_changes->discard(*m_sql, mark);
+                }
+                *m_sql << "RELEASE SAVEPOINT mantis_write";
+            }
+
+            m_sql->commit();
+        }
+        catch (...)
+        {
+            // Commit (or savepoint handling) failed, nothing in this batch was written
+            const auto err = std::current_exception();
+
+            try { m_sql->rollback(); }
+            catch (const std::exception& e)
+            {
+                Log::critical("Write queue rollback failed: {}", e.what());
+            }
+
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                if (!errors[i]) errors[i] = err;
+            }
+        }
+
+        // Publish before waking the callers, their writes are in the feed once they return
+        if (m_changes) m_changes->flush(*m_sql);
+
+        ++m_batches;
+        m_jobs += batch.size();
+        if (batch.size() > m_maxBatch.load()) m_maxBatch = batch.size();
+
+        // Wake up the callers
+        for (size_t i = 0; i < batch.size(); ++i)
+        {
+            if (errors[i]) batch[i]->done.set_exception(errors[i]);
+            else batch[i]->done.set_value(results[i]);
+        }
+    }
+}
@@ -9,6 +9,7 @@ namespace mantis {
         dukglue_register_function(ctx, &generateTimeBasedId, "generateTimeBasedId");
         dukglue_register_function(ctx, &generateReadableTimeId, "generateReadableTimeId");
         dukglue_register_function(ctx, &generateShortId, "generateShortId");
+        dukglue_register_function(ctx, &generateSortableId, "generateSortableId");
         dukglue_register_function(ctx, &getEnvOrDefault, "getEnvOrDefault");
         dukglue_register_function(ctx, &sanitizeFilename_JSWrapper, "sanitizeFilename");
         dukglue_register_function(ctx, &hashPassword, "hashPassword");
@@ -1,6 +1,7 @@
 #include "../../include/mantis/utils/utils.h"
 
 #include <algorithm>
+#include <mutex>
 #include <httplib.h>
 
 namespace mantis
@@ -100,6 +101,51 @@ namespace mantis
         return id;
     }
 
+    std::string generateSortableId()
+    {
+        static constexpr char charset[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+        static constexpr uint64_t max_sequence = (1ULL << 20) - 1;
+
+        static std::mutex mutex;
+        static uint64_t last_ms = 0, sequence = 0;
+        static const uint64_t node = std::random_device{}() & 0x3FF;
+        thread_local std::mt19937_64 rng{std::random_device{}()};
+
+        uint64_t ms;
+        {
+            std::lock_guard lock(mutex);
+            ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+
+            if (ms > last_ms)
+            {
+                // Random start, leaving half of the range to count up within the millisecond
+                last_ms = ms;
+                sequence = rng() & (max_sequence >> 1);
+            }
+            else if (++sequence > max_sequence)
+            {
+                // Sequence exhausted (or the clock went back), borrow the next millisecond
+                ++last_ms;
+                sequence = 0;
+            }
+
+            ms = last_ms;
+        }
+
+        // 80 bits in 16 characters of 5 bits each, most significant first
+        const uint64_t high = ms & ((1ULL << 50) - 1); // 10 chars
+        const uint64_t low = (sequence << 10) | node; // 6 chars
+
+        std::string id(16, '0');
+        for (int i = 0; i < 10; ++i)
+            id[9 - i] = charset[(high >> (i * 5)) & 0x1F];
+        for (int i = 0; i < 6; ++i)
+            id[15 - i] = charset[(low >> (i * 5)) & 0x1F];
+
+        return id;
+    }
+
     std::vector<std::string> splitString(const std::string& input, const std::string& delimiter)
     {
         std::vector<std::string> tokens;
@@ -116,6 +162,94 @@ namespace mantis
         return tokens;
     }
 
+    static constexpr char base64UrlChars[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+    std::string base64UrlEncode(const std::string_view data)
+    {
+        std::string out;
+        out.reserve((data.size() + 2) / 3 * 4);
+
+        uint32_t buf = 0;
+        int bits = 0;
+        for (const auto c : data)
+        {
+            buf = (buf << 8) | static_cast<unsigned char>(c);
+            bits += 8;
+            while (bits >= 6)
+            {
+                bits -= 6;
+                out.push_back(base64UrlChars[(buf >> bits) & 0x3F]);
+            }
+        }
+
+        if (bits > 0)
+            out.push_back(base64UrlChars[(buf << (6 - bits)) & 0x3F]);
+
+        return out;
+    }
+
+    std::optional<std::string> base64UrlDecode(std::string_view encoded)
+    {
+        // Padding is optional
+        while (!encoded.empty() && encoded.back() == '=')
+            encoded.remove_suffix(1);
+
+        // A single trailing character can't hold a byte
+        if (encoded.size() % 4 == 1) return std::nullopt;
+
+        std::string out;
+        out.reserve(encoded.size() * 3 / 4);
+
+        uint32_t buf = 0;
+        int bits = 0;
+        for (const auto c : encoded)
+        {
+            const auto pos = std::string_view(base64UrlChars).find(c);
+            if (pos == std::string_view::npos) return std::nullopt;
+
+            buf = (buf << 6) | static_cast<uint32_t>(pos);
+            bits += 6;
+            if (bits >= 8)
+            {
+                bits -= 8;
+                out.push_back(static_cast<char>((buf >> bits) & 0xFF));
+            }
+        }
+
+        // Left over bits are zero as encoded, anything else was altered
+        if ((buf & ((1u << bits) - 1)) != 0) return std::nullopt;
+
+        return out;
+    }
+
+    bool etagMatches(std::string_view ifNoneMatch, std::string_view etag)
+    {
+        // Weak comparison, `W/"x"` matches `"x"`
+        const auto opaque = [](std::string_view tag)
+        {
+            while (!tag.empty() && std::isspace(static_cast<unsigned char>(tag.front()))) tag.remove_prefix(1);
+            while (!tag.empty() && std::isspace(static_cast<unsigned char>(tag.back()))) tag.remove_suffix(1);
+            if (tag.starts_with("W/")) tag.remove_prefix(2);
+            return tag;
+        };
+
+        const auto current = opaque(etag);
+        if (current.empty()) return false;
+
+        while (!ifNoneMatch.empty())
+        {
+            const auto comma = ifNoneMatch.find(',');
+            const auto tag = opaque(ifNoneMatch.substr(0, comma));
+            if (tag == "*" || tag == current) return true;
+
+            if (comma == std::string_view::npos) break;
+            ifNoneMatch.remove_prefix(comma + 1);
+        }
+
+        return false;
+    }
+
     std::string getEnvOrDefault(const std::string& key, const std::string& defaultValue)
     {
         const char* value = std::getenv(key.c_str());
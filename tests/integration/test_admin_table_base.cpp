@@ -0,0 +1,35 @@
+#include "test_admin_table_base.h"
+#include "mantis/core/jwt.h"
+#include "mantis/core/router.h"
+
+void AdminTableTest::SetUp()
+{
+    client = std::make_unique<httplib::Client>("http://localhost:7075");
+
+    // Admin created in-process, its token authorizes the table & record requests
+    const auto admin = mantis::MantisApp::instance().router().adminTable()->create(
+        {{"email", mantis::generateShortId() + "@admin.test"}, {"password", "adminpass123"}},
+        nlohmann::json::object());
+    ASSERT_EQ(admin.value("error", ""), "");
+
+    const auto token = mantis::JwtUnit::createJWTToken(
+        {{"id", admin["data"]["id"].get<std::string>()}, {"table", "__admins"}});
+    headers = {{"Authorization", "Bearer " + token}};
+
+    table = createTable("test");
+    ASSERT_FALSE(table.empty());
+}
+
+std::string AdminTableTest::createTable(const std::string& prefix, const nlohmann::json& extra) const
+{
+    nlohmann::json schema = {
+        {"name", prefix + "_" + mantis::generateShortId()},
+        {"type", "base"},
+        {"fields", nlohmann::json::array({{{"name", "title"}, {"type", "string"}}})}
+    };
+    schema.update(extra);
+
+    const auto created = client->Post("/api/v1/tables", headers, schema.dump(), "application/json");
+    if (!created || created->status != 201) return "";
+    return schema["name"].get<std::string>();
+}
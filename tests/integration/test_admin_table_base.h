@@ -0,0 +1,31 @@
+#ifndef TEST_ADMIN_TABLE_BASE_H
+#define TEST_ADMIN_TABLE_BASE_H
+
+#include <gtest/gtest.h>
+#include <httplib.h>
+#include "mantis/app/app.h"
+#include "mantis/core/tables/tables.h"
+
+/**
+ * Requests against a fresh `base` table with a single `title` field, authorized by an
+ * admin created in-process for each test.
+ */
+class AdminTableTest : public ::testing::Test {
+protected:
+    void SetUp() override;
+
+    /**
+     * Create a `base` table with a `title` field through the API, named `<prefix>_<id>`.
+     * @param prefix Table name prefix
+     * @param extra Schema keys to add, e.g. access rules
+     * @return Name of the created table, empty on failure
+     */
+    [[nodiscard]]
+    std::string createTable(const std::string& prefix, const nlohmann::json& extra = nlohmann::json::object()) const;
+
+    std::unique_ptr<httplib::Client> client;
+    httplib::Headers headers; ///> Admin authorization
+    std::string table; ///> Created for each test
+};
+
+#endif //TEST_ADMIN_TABLE_BASE_H
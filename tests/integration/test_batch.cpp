@@ -0,0 +1,24 @@
+#include "test_admin_table_base.h"
+
+class BatchTest : public AdminTableTest {};
+
+TEST_F(BatchTest, UpdateOfMissingRecordRollsBackTheBatch) {
+    const nlohmann::json batch = nlohmann::json::array({
+        {{"action", "create"}, {"table", table}, {"data", {{"title", "kept only on success"}}}},
+        {{"action", "update"}, {"table", table}, {"id", "missing"}, {"data", {{"title", "nothing"}}}}
+    });
+
+    const auto result = client->Post("/api/v1/batch", headers, batch.dump(), "application/json");
+    ASSERT_TRUE(result);
+    EXPECT_EQ(result->status, 400);
+
+    const auto response = nlohmann::json::parse(result->body);
+    const auto error = response["error"].get<std::string>();
+    EXPECT_NE(error.find("Could not find record with id = missing"), std::string::npos);
+
+    // The create ahead of the failed update was rolled back too
+    const auto list = client->Get("/api/v1/" + table, headers);
+    ASSERT_TRUE(list);
+    ASSERT_EQ(list->status, 200);
+    EXPECT_TRUE(nlohmann::json::parse(list->body)["data"].empty());
+}
@@ -43,3 +43,28 @@ TEST_F(AccessPermissionTest, GetRule_DeniesNonOwnerAccess) {
 
     // EXPECT_EQ(get_result->status, 403);
 }
+
+#include "test_admin_table_base.h"
+
+class GetRuleTest : public AdminTableTest {};
+
+// A record read is checked against `getRule`, not `listRule`
+TEST_F(GetRuleTest, GetOnlyRuleAppliesToRecordReads) {
+    const auto name = createTable("get_rule", {{"getRule", "1 == 1"}, {"listRule", ""}});
+    ASSERT_FALSE(name.empty());
+
+    const nlohmann::json record = {{"title", "readable"}};
+    const auto created = client->Post("/api/v1/" + name, headers, record.dump(), "application/json");
+    ASSERT_TRUE(created);
+    ASSERT_EQ(created->status, 201);
+    const auto id = nlohmann::json::parse(created->body)["data"]["id"].get<std::string>();
+
+    // Anonymous, only the open `getRule` lets it through
+    const auto get = client->Get("/api/v1/" + name + "/" + id);
+    ASSERT_TRUE(get);
+    EXPECT_EQ(get->status, 200);
+
+    const auto list = client->Get("/api/v1/" + name);
+    ASSERT_TRUE(list);
+    EXPECT_EQ(list->status, 403);
+}
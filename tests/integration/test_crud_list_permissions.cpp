@@ -34,4 +34,28 @@ TEST_F(AccessPermissionTest, ListRule_DeniesWrongUserType) {
 
     // Should be denied because rule requires auth.table == 'users', but admin has '__admin'
     // EXPECT_EQ(result->status, 403);
-}
\ No newline at end of file
+}
+#include "test_admin_table_base.h"
+
+class ListRuleTest : public AdminTableTest {};
+
+// A list is checked against `listRule`, not `getRule`
+TEST_F(ListRuleTest, ListOnlyRuleAppliesToLists) {
+    const auto name = createTable("list_rule", {{"listRule", "1 == 1"}, {"getRule", ""}});
+    ASSERT_FALSE(name.empty());
+
+    const nlohmann::json record = {{"title", "listed"}};
+    const auto created = client->Post("/api/v1/" + name, headers, record.dump(), "application/json");
+    ASSERT_TRUE(created);
+    ASSERT_EQ(created->status, 201);
+    const auto id = nlohmann::json::parse(created->body)["data"]["id"].get<std::string>();
+
+    // Anonymous, only the open `listRule` lets it through
+    const auto list = client->Get("/api/v1/" + name);
+    ASSERT_TRUE(list);
+    EXPECT_EQ(list->status, 200);
+
+    const auto get = client->Get("/api/v1/" + name + "/" + id);
+    ASSERT_TRUE(get);
+    EXPECT_EQ(get->status, 403);
+}
@@ -0,0 +1,67 @@
+#include "test_admin_table_base.h"
+#include <set>
+#include "mantis/utils/utils.h"
+
+class CursorTest : public AdminTableTest {
+protected:
+    [[nodiscard]] httplib::Result list(const std::string& cursor) const {
+        return client->Get("/api/v1/" + table + "?perPage=2&cursor=" + cursor, headers);
+    }
+};
+
+TEST_F(CursorTest, PagesThroughEveryRecordOnce) {
+    std::set<std::string> created;
+    for (int i = 0; i < 5; ++i) {
+        const nlohmann::json record = {{"title", "record " + std::to_string(i)}};
+        const auto result = client->Post("/api/v1/" + table, headers, record.dump(), "application/json");
+        ASSERT_TRUE(result);
+        ASSERT_EQ(result->status, 201);
+        created.insert(nlohmann::json::parse(result->body)["data"]["id"].get<std::string>());
+    }
+
+    std::set<std::string> seen;
+    std::string cursor;
+    for (int page = 0; page < 3; ++page) {
+        const auto result = list(cursor);
+        ASSERT_TRUE(result);
+        ASSERT_EQ(result->status, 200);
+
+        const auto body = nlohmann::json::parse(result->body);
+        for (const auto& record : body["data"])
+            EXPECT_TRUE(seen.insert(record["id"].get<std::string>()).second);
+
+        const auto next = body["pagination"]["nextCursor"];
+        if (page == 2) {
+            EXPECT_TRUE(next.is_null());
+            break;
+        }
+
+        // Opaque, but base64url of `[created, id]`
+        ASSERT_TRUE(next.is_string());
+        cursor = next.get<std::string>();
+        const auto key = nlohmann::json::parse(mantis::base64UrlDecode(cursor).value());
+        ASSERT_TRUE(key.is_array());
+        ASSERT_EQ(key.size(), 2);
+    }
+
+    EXPECT_EQ(seen, created);
+}
+
+TEST_F(CursorTest, RejectsTamperedCursors) {
+    const std::vector<std::string> cursors = {
+        "not*base64",
+        "YWJjZ",
+        mantis::base64UrlEncode("not json"),
+        mantis::base64UrlEncode(R"({"created":"2024-01-01 00:00:00","id":"x"})"),
+        mantis::base64UrlEncode(R"(["2024-01-01 00:00:00"])"),
+        mantis::base64UrlEncode(R"(["2024-01-01 00:00:00",42])"),
+        mantis::base64UrlEncode(R"(["yesterday","x"])"),
+    };
+
+    for (const auto& cursor : cursors) {
+        const auto result = list(cursor);
+        ASSERT_TRUE(result);
+        EXPECT_EQ(result->status, 400) << cursor;
+        EXPECT_EQ(nlohmann::json::parse(result->body)["error"], "Invalid pagination cursor") << cursor;
+    }
+}
@@ -0,0 +1,64 @@
+#include "test_admin_table_base.h"
+#include "mantis/core/database.h"
+
+class RecordETagTest : public AdminTableTest {};
+
+TEST_F(RecordETagTest, UpdatesWithinTheSameSecondChangeTheTag) {
+    const nlohmann::json record = {{"title", "first"}};
+    const auto created = client->Post("/api/v1/" + table, headers, record.dump(), "application/json");
+    ASSERT_TRUE(created);
+    ASSERT_EQ(created->status, 201);
+    const auto path = "/api/v1/" + table + "/" + nlohmann::json::parse(created->body)["data"]["id"].get<std::string>();
+
+    const auto first = client->Get(path, headers);
+    ASSERT_TRUE(first);
+    const auto etag = first->get_header_value("ETag");
+    ASSERT_FALSE(etag.empty());
+
+    // Well within the second `updated` is stored with
+    const nlohmann::json update = {{"title", "second"}};
+    const auto patched = client->Patch(path, headers, update.dump(), "application/json");
+    ASSERT_TRUE(patched);
+    ASSERT_EQ(patched->status, 200);
+
+    auto conditional = headers;
+    conditional.emplace("If-None-Match", etag);
+    const auto second = client->Get(path, conditional);
+    ASSERT_TRUE(second);
+    EXPECT_EQ(second->status, 200);
+    EXPECT_NE(second->get_header_value("ETag"), etag);
+    EXPECT_EQ(nlohmann::json::parse(second->body)["data"]["title"], "second");
+
+    // Unchanged since, the tag still matches
+    conditional = headers;
+    conditional.emplace("If-None-Match", second->get_header_value("ETag"));
+    const auto third = client->Get(path, conditional);
+    ASSERT_TRUE(third);
+    EXPECT_EQ(third->status, 304);
+}
+
+TEST_F(RecordETagTest, ResyncedCountChangesTheListTag) {
+    const auto first = client->Get("/api/v1/" + table, headers);
+    ASSERT_TRUE(first);
+    ASSERT_EQ(first->status, 200);
+    const auto etag = first->get_header_value("ETag");
+    ASSERT_FALSE(etag.empty());
+
+    // Written past the API, neither the version nor the maintained count see it
+    {
+        const auto sql = mantis::MantisApp::instance().db().session();
+        *sql << "INSERT INTO " + table + " (id, created, updated, title) "
+                "VALUES ('raw', CURRENT_TIMESTAMP, CURRENT_TIMESTAMP, 'raw')";
+    }
+
+    // Standing in for the count's TTL running out
+    mantis::MantisApp::instance().db().counters().invalidate(table);
+
+    auto conditional = headers;
+    conditional.emplace("If-None-Match", etag);
+    const auto second = client->Get("/api/v1/" + table, conditional);
+    ASSERT_TRUE(second);
+    EXPECT_EQ(second->status, 200);
+    EXPECT_NE(second->get_header_value("ETag"), etag);
+    EXPECT_EQ(nlohmann::json::parse(second->body)["pagination"]["recordCount"], 1);
+}
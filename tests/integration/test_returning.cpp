@@ -0,0 +1,52 @@
+#include "test_admin_table_base.h"
+#include "mantis/core/database.h"
+#include "mantis/core/router.h"
+
+class ReturningTest : public AdminTableTest {
+protected:
+    void SetUp() override {
+        AdminTableTest::SetUp();
+        if (!mantis::MantisApp::instance().db().supportsReturning())
+            GTEST_SKIP() << "Linked SQLite predates RETURNING";
+
+        unit = mantis::MantisApp::instance().router().findTable(table);
+        ASSERT_NE(unit, nullptr);
+    }
+
+    std::shared_ptr<mantis::TableUnit> unit;
+};
+
+TEST_F(ReturningTest, WritesReturnTheStoredRecord) {
+    const auto created = unit->create({{"title", "first"}}, nlohmann::json::object());
+    ASSERT_EQ(created["status"], 201) << created.dump();
+    const auto id = created["data"]["id"].get<std::string>();
+    EXPECT_EQ(created["data"]["title"], "first");
+    EXPECT_EQ(created["data"], unit->read(id, nlohmann::json::object()).value());
+
+    const auto updated = unit->update(id, {{"title", "second"}}, nlohmann::json::object());
+    ASSERT_EQ(updated["status"], 200) << updated.dump();
+    EXPECT_EQ(updated["data"]["title"], "second");
+    EXPECT_EQ(updated["data"], unit->read(id, nlohmann::json::object()).value());
+
+    EXPECT_TRUE(unit->remove(id, nlohmann::json::object()));
+    EXPECT_FALSE(unit->read(id, nlohmann::json::object()).has_value());
+}
+
+TEST_F(ReturningTest, ReturnsTheRequestedFields) {
+    const nlohmann::json opts = {{"fields", "title"}};
+    const auto created = unit->create({{"title", "first"}}, opts);
+    ASSERT_EQ(created["status"], 201) << created.dump();
+    EXPECT_EQ(created["data"], (nlohmann::json{{"id", created["data"]["id"]}, {"title", "first"}}));
+
+    const auto updated = unit->update(created["data"]["id"].get<std::string>(), {{"title", "second"}}, opts);
+    ASSERT_EQ(updated["status"], 200) << updated.dump();
+    EXPECT_EQ(updated["data"], (nlohmann::json{{"id", created["data"]["id"]}, {"title", "second"}}));
+}
+
+TEST_F(ReturningTest, MissingRecordsAreNotFound) {
+    const auto updated = unit->update("missing", {{"title", "nothing"}}, nlohmann::json::object());
+    EXPECT_NE(updated["status"], 200);
+    EXPECT_EQ(updated["error"], "Could not find record with id = missing");
+
+    EXPECT_THROW(unit->remove("missing", nlohmann::json::object()), std::runtime_error);
+}
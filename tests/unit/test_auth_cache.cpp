@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include "mantis/core/auth_cache.h"
+
+TEST(AuthCache, ServesUsersUntilInvalidated) {
+    mantis::AuthCache cache;
+    EXPECT_FALSE(cache.get("users", "1").has_value());
+
+    cache.put("users", "1", {{"id", "1"}, {"name", "Jane"}}, cache.generation("users", "1"));
+    cache.put("members", "1", {{"id", "1"}}, cache.generation("members", "1"));
+    ASSERT_TRUE(cache.get("users", "1").has_value());
+    EXPECT_EQ(cache.get("users", "1")->at("name"), "Jane");
+
+    cache.invalidate("users", "1");
+    EXPECT_FALSE(cache.get("users", "1").has_value());
+
+    cache.invalidate("members");
+    EXPECT_FALSE(cache.get("members", "1").has_value());
+}
+
+TEST(AuthCache, SkipsUsersReadBeforeAnUpdate) {
+    mantis::AuthCache cache;
+
+    // Read started, then the user was updated before it got cached
+    const auto generation = cache.generation("users", "1");
+    cache.invalidate("users", "1");
+    cache.put("users", "1", {{"id", "1"}, {"name", "Old"}}, generation);
+
+    EXPECT_FALSE(cache.get("users", "1").has_value());
+}
+
+TEST(AuthCache, TellsTheListenerOfInvalidations) {
+    mantis::AuthCache cache;
+    std::vector<std::pair<std::string, std::string>> told;
+    cache.setListener([&](const std::string& table, const std::string& id) { told.emplace_back(table, id); });
+
+    cache.invalidate("users", "1");
+    cache.invalidate("members");
+    cache.clear();
+
+    const std::vector<std::pair<std::string, std::string>> expected{{"users", "1"}, {"members", ""}, {"", ""}};
+    EXPECT_EQ(told, expected);
+}
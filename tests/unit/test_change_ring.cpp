@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "mantis/core/change_ring.h"
+
+#include <thread>
+
+using mantis::ChangeOp;
+using mantis::ChangeRing;
+using mantis::ChangeEvent;
+
+TEST(ChangeRing, DeliversEventsInOrder) {
+    ChangeRing ring(8);
+    uint64_t cursor = ring.head();
+
+    ring.publish(ChangeOp::Create, "posts", "a");
+    ring.publish(ChangeOp::Delete, "posts", "b");
+
+    std::vector<ChangeEvent> events;
+    EXPECT_EQ(ring.poll(cursor, events), 0);
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[0].toJson()["op"], "create");
+    EXPECT_EQ(events[1].id, "b");
+    EXPECT_EQ(cursor, 2);
+
+    // Nothing new since
+    EXPECT_EQ(ring.poll(cursor, events), 0);
+    EXPECT_TRUE(events.empty());
+    EXPECT_FALSE(ring.wait(cursor, std::chrono::milliseconds(1)));
+}
+
+TEST(ChangeRing, ReportsEventsLostToSlowSubscribers) {
+    ChangeRing ring(4);
+    uint64_t cursor = 0;
+
+    for (int i = 0; i < 10; ++i)
+        ring.publish(ChangeOp::Update, "posts", std::to_string(i));
+
+    // Only the last four are still held
+    std::vector<ChangeEvent> events;
+    EXPECT_EQ(ring.poll(cursor, events), 6);
+    ASSERT_EQ(events.size(), 4);
+    EXPECT_EQ(events.front().id, "6");
+    EXPECT_EQ(events.front().seq, 7);
+}
+
+TEST(ChangeRing, ConcurrentPublishersLoseNothing) {
+    ChangeRing ring(1 << 16);
+    constexpr int publishers = 4, per_publisher = 5000;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < publishers; ++p)
+    {
+        threads.emplace_back([&ring, p] {
+            for (int i = 0; i < per_publisher; ++i)
+                ring.publish(ChangeOp::Create, "t" + std::to_string(p), std::to_string(i));
+        });
+    }
+
+    uint64_t cursor = 0;
+    size_t received = 0;
+    std::vector<ChangeEvent> events;
+    while (received < publishers * per_publisher)
+    {
+        ring.wait(cursor, std::chrono::milliseconds(10));
+        EXPECT_EQ(ring.poll(cursor, events), 0);
+        received += events.size();
+    }
+
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(ring.head(), publishers * per_publisher);
+}
+
+TEST(ChangeRing, LappingPublishersNeverTearOrStallEvents) {
+    ChangeRing ring(2);
+    constexpr int publishers = 4, per_publisher = 20000;
+
+    std::atomic<bool> done{false};
+    size_t torn = 0;
+    std::thread reader([&] {
+        uint64_t cursor = 0;
+        std::vector<ChangeEvent> events;
+        while (!done)
+        {
+            ring.poll(cursor, events);
+            for (const auto& e : events)
+                if (e.id.substr(0, e.id.find('-')) != e.table) ++torn;
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < publishers; ++p)
+    {
+        threads.emplace_back([&ring, p] {
+            const auto table = std::to_string(p);
+            for (int i = 0; i < per_publisher; ++i)
+                ring.publish(ChangeOp::Create, table, table + "-" + std::to_string(i));
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    done = true;
+    reader.join();
+    EXPECT_EQ(torn, 0u);
+
+    // Every slot ends up at its latest event, so readers catch up to the head
+    uint64_t cursor = ring.head() - ring.capacity();
+    std::vector<ChangeEvent> events;
+    ring.poll(cursor, events);
+    EXPECT_EQ(cursor, ring.head());
+}
@@ -33,4 +33,77 @@ TEST_F(DatabaseTest, MigrationForSystemTablesSuccessful) {
     // }
 
     // EXPECT_TRUE(count > 0);
-}
\ No newline at end of file
+}
+TEST_F(DatabaseTest, AutoCheckpointsAreOffOnlyWhileTheCheckpointerRuns) {
+    auto& db = mantis::MantisApp::instance().db();
+    ASSERT_NE(db.checkpointer(), nullptr);
+
+    const auto autocheckpoint = [&] {
+        int pages = -1;
+        *db.session() << "PRAGMA wal_autocheckpoint", soci::into(pages);
+        return pages;
+    };
+
+    EXPECT_EQ(autocheckpoint(), 0);
+
+    // As once the checkpointer stops
+    db.setAutoCheckpoint(true);
+    EXPECT_EQ(autocheckpoint(), mantis::WalCheckpointer::AUTOCHECKPOINT_PAGES);
+
+    db.setAutoCheckpoint(false);
+    EXPECT_EQ(autocheckpoint(), 0);
+}
+
+TEST_F(DatabaseTest, OnlyReadOnlyQueriesAreSelects) {
+    using mantis::DatabaseUnit;
+    EXPECT_TRUE(DatabaseUnit::isSelectQuery("SELECT * FROM notes"));
+    EXPECT_TRUE(DatabaseUnit::isSelectQuery("  (select 1) UNION (select 2);  "));
+    EXPECT_TRUE(DatabaseUnit::isSelectQuery("-- latest first\nSELECT * FROM notes ORDER BY created DESC"));
+    EXPECT_TRUE(DatabaseUnit::isSelectQuery("/* count */ SELECT COUNT(*) FROM notes"));
+    EXPECT_TRUE(DatabaseUnit::isSelectQuery("WITH recent AS (SELECT * FROM notes) SELECT * FROM recent"));
+    EXPECT_TRUE(DatabaseUnit::isSelectQuery("SELECT * FROM notes WHERE title = 'delete; it''s gone'"));
+    EXPECT_TRUE(DatabaseUnit::isSelectQuery("SELECT \"update\" FROM notes -- insert"));
+    EXPECT_TRUE(DatabaseUnit::isSelectQuery("VALUES (1), (2)"));
+
+    EXPECT_FALSE(DatabaseUnit::isSelectQuery(""));
+    EXPECT_FALSE(DatabaseUnit::isSelectQuery("-- SELECT\nDELETE FROM notes"));
+    EXPECT_FALSE(DatabaseUnit::isSelectQuery("/* SELECT */ UPDATE notes SET title = ''"));
+    EXPECT_FALSE(DatabaseUnit::isSelectQuery("WITH old AS (SELECT id FROM notes) DELETE FROM notes WHERE id IN old"));
+    EXPECT_FALSE(DatabaseUnit::isSelectQuery("WITH gone AS (DELETE FROM notes RETURNING *) SELECT * FROM gone"));
+    EXPECT_FALSE(DatabaseUnit::isSelectQuery("SELECT * FROM notes FOR UPDATE"));
+    EXPECT_FALSE(DatabaseUnit::isSelectQuery("SELECT * INTO archive FROM notes"));
+    EXPECT_FALSE(DatabaseUnit::isSelectQuery("SELECT 1; DROP TABLE notes"));
+    EXPECT_FALSE(DatabaseUnit::isSelectQuery("SELECT 'unterminated"));
+    EXPECT_FALSE(DatabaseUnit::isSelectQuery("selection"));
+}
+
+TEST_F(DatabaseTest, SqliteProfileOverridesValidatedValues) {
+    using mantis::SqliteProfile;
+    const auto profile = SqliteProfile::fromJson({{"mmapSize", 0}, {"tempStore", "FILE"}, {"pageSize", 8192}});
+    EXPECT_EQ(profile.mmapSize, 0);
+    EXPECT_EQ(profile.tempStore, "file");
+    EXPECT_EQ(profile.pageSize, 8192);
+    EXPECT_EQ(profile.cacheSize, SqliteProfile{}.cacheSize);
+
+    // Values not present are kept from the base profile
+    EXPECT_EQ(SqliteProfile::fromJson({{"busyTimeout", 5}}, profile).pageSize, 8192);
+    EXPECT_EQ(SqliteProfile::fromJson(profile.toJson()).toJson(), profile.toJson());
+
+    for (const auto& invalid : {
+             nlohmann::json::array(),
+             nlohmann::json{{"mmap", 0}},
+             nlohmann::json{{"mmapSize", -1}},
+             nlohmann::json{{"mmapSize", "1GB"}},
+             nlohmann::json{{"mmapSize", 1.5}},
+             nlohmann::json{{"cacheSize", 0}},
+             nlohmann::json{{"tempStore", "disk"}},
+             nlohmann::json{{"tempStore", 2}},
+             nlohmann::json{{"pageSize", 1000}},
+             nlohmann::json{{"pageSize", 131072}},
+             nlohmann::json{{"busyTimeout", 4294967296}},
+             nlohmann::json{{"busyTimeout", -1}},
+             nlohmann::json{{"sharedCache", "yes"}},
+         }) {
+        EXPECT_THROW(SqliteProfile::fromJson(invalid), std::invalid_argument) << invalid.dump();
+    }
+}
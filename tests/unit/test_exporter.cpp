@@ -0,0 +1,31 @@
+#include <gtest/gtest.h>
+#include "mantis/core/exporter.h"
+
+TEST(RecordExporter, QuotesCsvFieldsOnlyWhenNeeded) {
+    std::string out;
+    mantis::RecordExporter::appendCsvField(out, "plain");
+    out.push_back(',');
+    mantis::RecordExporter::appendCsvField(out, "Doe, John");
+    out.push_back(',');
+    mantis::RecordExporter::appendCsvField(out, "Says \"hi\"\ntwice");
+    EXPECT_EQ(out, "plain,\"Doe, John\",\"Says \"\"hi\"\"\ntwice\"");
+}
+
+TEST(RecordExporter, RejectsUnsupportedFormats) {
+    EXPECT_THROW(mantis::RecordExporter("xml"), std::invalid_argument);
+    EXPECT_EQ(mantis::RecordExporter("csv").contentType(), "text/csv; charset=utf-8");
+    EXPECT_EQ(mantis::RecordExporter("ndjson").contentType(), "application/x-ndjson");
+}
+
+TEST(RecordExporter, CapsConcurrentExports) {
+    auto first = std::make_unique<mantis::RecordExporter>("csv");
+    mantis::RecordExporter second("ndjson");
+
+    EXPECT_TRUE(first->acquire(1));
+    EXPECT_TRUE(first->acquire(1)); // Already held
+    EXPECT_FALSE(second.acquire(1));
+
+    // Destroying an exporter frees its slot
+    first.reset();
+    EXPECT_TRUE(second.acquire(1));
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "mantis/core/expr_evaluator.h"
+
+TEST(ExprEvaluatorTest, CompiledRuleEvaluatesAgainstEachRequestVars) {
+    const auto rule = mantis::ExprEvaluator::compile(" auth.id == req.owner ");
+    ASSERT_TRUE(rule.error.empty());
+    EXPECT_EQ(rule.expr, "auth.id == req.owner");
+
+    mantis::ExprEvaluator evaluator;
+    cparse::TokenMap auth, req, vars;
+    auth["id"] = "u1";
+    vars["auth"] = auth;
+
+    req["owner"] = "u1";
+    vars["req"] = req;
+    EXPECT_TRUE(evaluator.evaluate(rule, vars));
+
+    req["owner"] = "u2";
+    vars["req"] = req;
+    EXPECT_FALSE(evaluator.evaluate(rule, vars));
+}
+
+TEST(ExprEvaluatorTest, IncompleteRulesFailToCompileAndDeny) {
+    for (const auto* expr : {"auth.id ==", "(auth.id == 'a'", "auth.verified &&"}) {
+        const auto rule = mantis::ExprEvaluator::compile(expr);
+        EXPECT_FALSE(rule.error.empty()) << expr;
+        EXPECT_FALSE(mantis::ExprEvaluator().evaluate(rule, cparse::TokenMap())) << expr;
+    }
+}
+
+TEST(ExprEvaluatorTest, CompiledRuleRecordsTheFieldsItReads) {
+    const auto rule = mantis::ExprEvaluator::compile(
+        "auth.id == req.body.owner && auth['verified'] && auth.roles[0] == 'admin'");
+    ASSERT_TRUE(rule.error.empty());
+    EXPECT_TRUE(rule.auth.used);
+    EXPECT_FALSE(rule.auth.all);
+    EXPECT_EQ(rule.auth.fields, (std::set<std::string>{"id", "verified", "roles"}));
+    EXPECT_TRUE(rule.req.reads("body"));
+    EXPECT_FALSE(rule.req.reads("remoteAddr"));
+
+    const auto open = mantis::ExprEvaluator::compile("True");
+    EXPECT_FALSE(open.auth.used);
+    EXPECT_FALSE(open.req.used);
+
+    const auto whole = mantis::ExprEvaluator::compile("auth != None");
+    EXPECT_TRUE(whole.auth.all);
+}
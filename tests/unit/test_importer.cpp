@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include "mantis/core/importer.h"
+
+TEST(RecordImporter, ReadsQuotedCsvRecords) {
+    std::istringstream in("name,bio\r\n\"Doe, John\",\"Says \"\"hi\"\"\ntwice\"\nJane,\n");
+    std::vector<std::string> fields;
+
+    ASSERT_TRUE(mantis::RecordImporter::readCsvRecord(in, fields));
+    EXPECT_EQ(fields, (std::vector<std::string>{"name", "bio"}));
+
+    ASSERT_TRUE(mantis::RecordImporter::readCsvRecord(in, fields));
+    EXPECT_EQ(fields, (std::vector<std::string>{"Doe, John", "Says \"hi\"\ntwice"}));
+
+    ASSERT_TRUE(mantis::RecordImporter::readCsvRecord(in, fields));
+    EXPECT_EQ(fields, (std::vector<std::string>{"Jane", ""}));
+
+    EXPECT_FALSE(mantis::RecordImporter::readCsvRecord(in, fields));
+}
+
+TEST(RecordImporter, RejectsUnterminatedCsvQuotes) {
+    std::istringstream in("\"open,value\n");
+    std::vector<std::string> fields;
+    EXPECT_THROW(mantis::RecordImporter::readCsvRecord(in, fields), std::invalid_argument);
+}
+
+TEST(RecordImporter, ReadsJsonArrayElements) {
+    std::istringstream in(R"( [ {"a": "}{", "b": [1, {"c": 2}]}, {"d": "\"}"} ] )");
+    std::string element;
+    bool started = false;
+
+    ASSERT_TRUE(mantis::RecordImporter::readJsonArrayElement(in, element, started));
+    EXPECT_EQ(nlohmann::json::parse(element)["b"][1]["c"], 2);
+
+    ASSERT_TRUE(mantis::RecordImporter::readJsonArrayElement(in, element, started));
+    EXPECT_EQ(nlohmann::json::parse(element)["d"], "\"}");
+
+    EXPECT_FALSE(mantis::RecordImporter::readJsonArrayElement(in, element, started));
+}
+
+TEST(RecordImporter, DetectsFormatFromPath) {
+    EXPECT_EQ(mantis::RecordImporter::formatFromPath("/data/posts.CSV"), "csv");
+    EXPECT_EQ(mantis::RecordImporter::formatFromPath("posts.jsonl"), "ndjson");
+    EXPECT_EQ(mantis::RecordImporter::formatFromPath("posts.json"), "json");
+    EXPECT_EQ(mantis::RecordImporter::formatFromPath("posts.xml"), "");
+}
+
+TEST(RecordImporter, ParsesBatchSizesStrictly) {
+    EXPECT_EQ(mantis::RecordImporter::parseBatchSize("1"), 1u);
+    EXPECT_EQ(mantis::RecordImporter::parseBatchSize("10000"), mantis::RecordImporter::MAX_BATCH_SIZE);
+
+    for (const auto* value : {"", "0", "-1", "10001", "18446744073709551616", "50abc", " 50", "1e3"})
+        EXPECT_THROW(mantis::RecordImporter::parseBatchSize(value), std::invalid_argument) << value;
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include "mantis/core/json_writer.h"
+#include <nlohmann/json.hpp>
+
+TEST(JsonWriter, MatchesJsonDump) {
+    const nlohmann::json expected = {
+        {"data", {{{"age", 12}, {"name", "John \"JD\" Doe\n"}, {"score", 2.5}, {"verified", true}}}},
+        {"error", ""},
+        {"pagination", {{"pageIndex", 1}, {"perPage", 100}}},
+        {"status", 200}
+    };
+
+    std::string body;
+    mantis::JsonWriter w(body);
+    w.beginObject();
+    w.key("data");
+    w.beginArray();
+    w.beginObject();
+    w.key("age"); w.value(12);
+    w.key("name"); w.value("John \"JD\" Doe\n");
+    w.key("score"); w.value(2.5);
+    w.key("verified"); w.value(true);
+    w.endObject();
+    w.endArray();
+    w.key("error"); w.value("");
+    w.key("pagination"); w.value(expected["pagination"]);
+    w.key("status"); w.value(200);
+    w.endObject();
+
+    EXPECT_EQ(body, expected.dump());
+}
+
+TEST(JsonWriter, EscapesControlCharacters) {
+    std::string out;
+    mantis::JsonWriter::escape(out, std::string("a\x01\t\\b", 5));
+    EXPECT_EQ(out, nlohmann::json(std::string("a\x01\t\\b", 5)).dump());
+}
+
+TEST(JsonWriter, WritesFloatingPointNumbers) {
+    std::string out;
+    mantis::JsonWriter w(out);
+    w.beginArray();
+    w.value(2.0);
+    w.value(0.1);
+    w.null();
+    w.raw("{\"a\":[]}");
+    w.endArray();
+
+    EXPECT_EQ(out, "[2.0,0.1,null,{\"a\":[]}]");
+}
+
+TEST(JsonWriter, WritesJsonTextAsDumped) {
+    // As stored by clients, keys unsorted at every level
+    const std::string stored = R"({"z": 1, "a": {"y": [{"d": 4, "c": 3}], "b": "café ü"}})";
+
+    std::string out;
+    mantis::JsonWriter w(out);
+    w.beginObject();
+    w.key("meta");
+    w.jsonText(stored);
+    w.endObject();
+
+    EXPECT_EQ(out, nlohmann::json({{"meta", nlohmann::json::parse(stored)}}).dump());
+    EXPECT_EQ(out, R"({"meta":{"a":{"b":"café ü","y":[{"c":3,"d":4}]},"z":1}})");
+
+    // Malformed JSON & invalid UTF-8
+    EXPECT_THROW(w.jsonText("{\"a\":"), std::invalid_argument);
+    EXPECT_THROW(w.jsonText("\"\xff\""), std::invalid_argument);
+}
@@ -19,4 +19,69 @@ TEST(TableTest, BaseFieldsExist) {
     EXPECT_TRUE(mantis::fieldExists(mantis::TableType::Base, "id"));
     EXPECT_TRUE(mantis::fieldExists(mantis::TableType::Base, "created"));
     EXPECT_TRUE(mantis::fieldExists(mantis::TableType::Base, "updated"));
-}
\ No newline at end of file
+}
+
+TEST(IndexTest, CompositePartialIndexSql) {
+    const nlohmann::json schema = {
+        {"name", "posts"},
+        {"type", "base"},
+        {"fields", {{{"name", "status"}, {"type", "string"}}, {{"name", "created"}, {"type", "date"}}}},
+        {"indexes", {{{"columns", {"status", "-created"}}, {"where", "status != 'archived'"}}}}
+    };
+
+    const auto indexes = mantis::Table::schemaIndexes(schema);
+    ASSERT_EQ(indexes.size(), 1);
+    EXPECT_EQ(indexes[0].name, "idx_posts_status_created");
+    EXPECT_EQ(indexes[0].to_sql("posts"),
+              "CREATE INDEX IF NOT EXISTS idx_posts_status_created ON posts (status, created DESC) "
+              "WHERE status <> 'archived'");
+    EXPECT_THROW(mantis::Index::from_json({{"columns", {"a; DROP TABLE x"}}}, "posts"), std::invalid_argument);
+}
+
+TEST(IndexTest, PartialIndexConditionIsCompiled) {
+    nlohmann::json schema = {
+        {"name", "posts"},
+        {"type", "base"},
+        {"fields", {{{"name", "status"}, {"type", "string"}}, {{"name", "views"}, {"type", "int32"}}}},
+        {"indexes", {{{"columns", {"status"}}, {"where", "views > 10 && status = 'it\\'s'"}}}}
+    };
+
+    const auto indexes = mantis::Table::schemaIndexes(schema);
+    ASSERT_EQ(indexes.size(), 1);
+    EXPECT_EQ(indexes[0].condition, "views > 10 AND status = 'it''s'");
+    EXPECT_TRUE(indexes[0].references("views"));
+
+    // Raw SQL & unknown columns are rejected
+    schema["indexes"][0]["where"] = "1 = 1) OR (1 = 1";
+    EXPECT_THROW(mantis::Table::schemaIndexes(schema), std::invalid_argument);
+    schema["indexes"][0]["where"] = "missing = 1";
+    EXPECT_THROW(mantis::Table::schemaIndexes(schema), std::invalid_argument);
+}
+
+TEST(IndexTest, SchemaIndexesChecksColumns) {
+    const nlohmann::json schema = {
+        {"name", "posts"},
+        {"type", "base"},
+        {"fields", {{{"name", "id"}}, {{"name", "slug"}, {"indexed", true}}}},
+        {"indexes", {{{"name", "uq_posts_slug"}, {"columns", {"slug"}}, {"unique", true}}}}
+    };
+
+    const auto indexes = mantis::Table::schemaIndexes(schema);
+    ASSERT_EQ(indexes.size(), 2);
+    EXPECT_EQ(indexes[0].name, "idx_posts_slug");
+    EXPECT_TRUE(indexes[1].unique);
+
+    auto invalid = schema;
+    invalid["indexes"][0]["columns"] = {"missing"};
+    EXPECT_THROW(mantis::Table::schemaIndexes(invalid), std::invalid_argument);
+}
+
+TEST(IndexTest, KeysetIndexNameIsReserved) {
+    // A user index on (created, id) no longer shadows the keyset index
+    const auto index = mantis::Index::from_json({{"columns", {"created", "id"}}}, "posts");
+    EXPECT_NE(index.name, mantis::Table::keysetIndexName("posts"));
+
+    EXPECT_THROW(mantis::Index::from_json({{"name", mantis::Table::keysetIndexName("posts")}, {"columns", {"id"}}}, "posts"),
+                 std::invalid_argument);
+    EXPECT_THROW(mantis::Index::from_json({{"name", "__mine"}, {"columns", {"id"}}}, "posts"), std::invalid_argument);
+}
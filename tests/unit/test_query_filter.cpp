@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "mantis/core/query_filter.h"
+
+namespace
+{
+    std::vector<nlohmann::json> fields()
+    {
+        return {
+            {{"name", "id"}, {"type", "string"}},
+            {{"name", "name"}, {"type", "string"}},
+            {{"name", "age"}, {"type", "int32"}},
+            {{"name", "score"}, {"type", "double"}},
+            {{"name", "verified"}, {"type", "bool"}},
+            {{"name", "created"}, {"type", "date"}},
+            {{"name", "tags"}, {"type", "json"}},
+            {{"name", "password"}, {"type", "string"}}
+        };
+    }
+}
+
+TEST(QueryFilter, CompilesParameterizedWhere) {
+    const mantis::QueryFilter filter(fields());
+    const auto q = filter.compile("(age >= 18 && verified = true) || name ~ 'jo\\'hn'", "");
+
+    EXPECT_EQ(q.where, "(age >= :f00 AND verified = :f01) OR name LIKE :f02 ESCAPE '\\'");
+    ASSERT_EQ(q.params.size(), 3);
+    EXPECT_EQ(std::get<long long>(q.params[0].value), 18);
+    EXPECT_EQ(std::get<long long>(q.params[1].value), 1);
+    EXPECT_EQ(std::get<std::string>(q.params[2].value), "%jo'hn%");
+    EXPECT_TRUE(q.orderBy.empty());
+}
+
+TEST(QueryFilter, CompilesNullChecksAndSort) {
+    const mantis::QueryFilter filter(fields());
+    const auto q = filter.compile("score != null", "-created,name");
+
+    EXPECT_EQ(q.where, "score IS NOT NULL");
+    EXPECT_TRUE(q.params.empty());
+    EXPECT_EQ(q.orderBy, "created DESC, name ASC, id DESC");
+}
+
+TEST(QueryFilter, RejectsUnsafeColumnsAndValues) {
+    const mantis::QueryFilter filter(fields());
+
+    EXPECT_THROW((void)filter.compile("password = 'x'", ""), std::invalid_argument);
+    EXPECT_THROW((void)filter.compile("tags = 'x'", ""), std::invalid_argument);
+    EXPECT_THROW((void)filter.compile("age = 'x'", ""), std::invalid_argument);
+    EXPECT_THROW((void)filter.compile("age = 1; DROP TABLE students", ""), std::invalid_argument);
+    EXPECT_THROW((void)filter.compile("(age = 1", ""), std::invalid_argument);
+    EXPECT_THROW((void)filter.compile("", "tags"), std::invalid_argument);
+}
+
+TEST(QueryFilter, RejectsMalformedNumbers) {
+    const mantis::QueryFilter filter(fields());
+
+    EXPECT_THROW((void)filter.compile("score > 1e999", ""), std::invalid_argument);
+    EXPECT_THROW((void)filter.compile("score > 1.2.3", ""), std::invalid_argument);
+    EXPECT_THROW((void)filter.compile("age > 99999999999999999999", ""), std::invalid_argument);
+
+    const auto q = filter.compile("score > -1.5e2", "");
+    ASSERT_EQ(q.params.size(), 1);
+    EXPECT_DOUBLE_EQ(std::get<double>(q.params[0].value), -150.0);
+}
+
+TEST(QueryFilter, ContainsMatchesWildcardsLiterally) {
+    const mantis::QueryFilter filter(fields());
+    const auto q = filter.compile("name !~ '50%_off\\\\'", "");
+
+    EXPECT_EQ(q.where, "name NOT LIKE :f00 ESCAPE '\\'");
+    ASSERT_EQ(q.params.size(), 1);
+    EXPECT_EQ(std::get<std::string>(q.params[0].value), "%50\\%\\_off\\\\%");
+}
+
+TEST(QueryFilter, CompilesLiteralConditions) {
+    const mantis::QueryFilter filter(fields());
+    const auto q = filter.compileLiteral("(age >= 18 && verified = true) || name ~ 'o\\'_'");
+
+    EXPECT_EQ(q.where, "(age >= 18 AND verified = TRUE) OR name LIKE '%o''\\_%' ESCAPE '\\'");
+    EXPECT_TRUE(q.params.empty());
+    EXPECT_EQ(q.columns, (std::vector<std::string>{"age", "verified", "name"}));
+}
@@ -0,0 +1,36 @@
+#include <gtest/gtest.h>
+#include "mantis/core/realtime.h"
+
+using mantis::RealtimeHub;
+
+TEST(RealtimeHub, ParsesTopics) {
+    std::string error;
+    const auto topics = RealtimeHub::parseTopics("posts, comments/abc123,", error);
+
+    EXPECT_TRUE(error.empty());
+    ASSERT_EQ(topics.size(), 2);
+    EXPECT_EQ(topics[0].table, "posts");
+    EXPECT_TRUE(topics[0].id.empty());
+    EXPECT_EQ(topics[1].table, "comments");
+    EXPECT_EQ(topics[1].id, "abc123");
+
+    EXPECT_TRUE(RealtimeHub::parseTopics("posts/", error).empty());
+    EXPECT_FALSE(error.empty());
+
+    error.clear();
+    EXPECT_TRUE(RealtimeHub::parseTopics(" , ", error).empty());
+    EXPECT_FALSE(error.empty());
+}
+
+TEST(RealtimeHub, FormatsEventsAsSseFrames) {
+    mantis::ChangeEvent event;
+    event.seq = 42;
+    event.op = mantis::ChangeOp::Update;
+    event.table = "posts";
+    event.id = "abc";
+
+    const auto frame = RealtimeHub::formatEvent(event);
+    EXPECT_TRUE(frame.starts_with("id: 42\nevent: update\ndata: {"));
+    EXPECT_TRUE(frame.ends_with("}\n\n"));
+    EXPECT_NE(frame.find(R"("table":"posts")"), std::string::npos);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "mantis/core/record_cache.h"
+
+using mantis::RecordCache;
+
+TEST(RecordCache, CachesEnabledTablesOnly) {
+    RecordCache cache;
+    cache.configure({{"tables", {{"profiles", {{"enabled", true}}}}}});
+
+    EXPECT_TRUE(cache.enabled("profiles"));
+    EXPECT_FALSE(cache.enabled("posts"));
+
+    cache.put("profiles", "a", R"({"id":"a"})", cache.generation("profiles", "a"));
+    EXPECT_EQ(cache.get("profiles", "a"), R"({"id":"a"})");
+    EXPECT_EQ(cache.stats()["hits"], 1);
+}
+
+TEST(RecordCache, DropsFillsRacingAnInvalidation) {
+    RecordCache cache;
+    cache.configure({{"enabled", true}});
+
+    // Read started before the write committed, its record may be stale
+    const auto generation = cache.generation("posts", "a");
+    cache.invalidate("posts", "a");
+    cache.put("posts", "a", "old", generation);
+    EXPECT_FALSE(cache.get("posts", "a").has_value());
+
+    cache.put("posts", "a", "new", cache.generation("posts", "a"));
+    EXPECT_EQ(cache.get("posts", "a"), "new");
+
+    cache.invalidate("posts");
+    EXPECT_FALSE(cache.get("posts", "a").has_value());
+}
+
+TEST(RecordCache, EvictsLeastRecentlyUsed) {
+    RecordCache cache;
+    cache.configure({{"enabled", true}, {"maxEntries", RecordCache::SHARDS}}); // One record per shard
+
+    for (int i = 0; i < 100; ++i)
+    {
+        const auto id = std::to_string(i);
+        cache.put("posts", id, id, cache.generation("posts", id));
+    }
+
+    const auto stats = cache.stats();
+    EXPECT_LE(stats["entries"].get<size_t>(), RecordCache::SHARDS);
+    EXPECT_EQ(stats["evictions"].get<size_t>() + stats["entries"].get<size_t>(), 100u);
+    EXPECT_EQ(cache.get("posts", "99"), "99");
+}
+
+TEST(RecordCache, ValidatesTheSetting) {
+    EXPECT_NO_THROW(RecordCache::validate({{"enabled", true}, {"maxEntries", 10}, {"ttl", 0},
+                                           {"tables", {{"posts", {{"enabled", false}, {"ttl", 5}}}}}}));
+
+    EXPECT_THROW(RecordCache::validate(nlohmann::json::array()), std::invalid_argument);
+    EXPECT_THROW(RecordCache::validate({{"enabled", "yes"}}), std::invalid_argument);
+    EXPECT_THROW(RecordCache::validate({{"ttl", "60"}}), std::invalid_argument);
+    EXPECT_THROW(RecordCache::validate({{"maxEntries", -1}}), std::invalid_argument);
+    EXPECT_THROW(RecordCache::validate({{"maxEntries", 1.5}}), std::invalid_argument);
+    EXPECT_THROW(RecordCache::validate({{"tables", {{"posts", true}}}}), std::invalid_argument);
+    EXPECT_THROW(RecordCache::validate({{"tables", {{"posts", {{"ttl", "5"}}}}}}), std::invalid_argument);
+    EXPECT_THROW(RecordCache::validate({{"tables", {{"posts", {{"size", 5}}}}}}), std::invalid_argument);
+    EXPECT_THROW(RecordCache::validate({{"max", 10}}), std::invalid_argument);
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include "mantis/core/sharded_ttl_cache.h"
+
+using Cache = mantis::ShardedTtlCache<std::string, int>;
+
+TEST(ShardedTtlCache, ServesEntriesUntilTheyExpire) {
+    Cache cache(100);
+    cache.put("fresh", 1, Cache::Clock::now() + std::chrono::hours(1));
+    cache.put("stale", 2, Cache::Clock::now() + std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+    EXPECT_EQ(cache.get("fresh"), 1);
+    EXPECT_FALSE(cache.get("stale").has_value());
+    EXPECT_EQ(cache.size(), 1u);
+
+    const auto stats = cache.stats();
+    EXPECT_EQ(stats["hits"], 1);
+    EXPECT_EQ(stats["misses"], 1);
+}
+
+TEST(ShardedTtlCache, EvictsLeastRecentlyUsedPerShard) {
+    Cache cache(Cache::SHARDS); // One entry per shard
+    const auto forever = Cache::Clock::time_point::max();
+
+    for (int i = 0; i < 100; ++i)
+        cache.put(std::to_string(i), i, forever);
+
+    EXPECT_LE(cache.size(), Cache::SHARDS);
+    EXPECT_EQ(cache.stats()["evictions"].get<size_t>() + cache.size(), 100u);
+    EXPECT_EQ(cache.get("99"), 99);
+
+    // No capacity, nothing is kept
+    cache.setCapacity(0);
+    cache.clear();
+    cache.put("a", 1, forever);
+    EXPECT_FALSE(cache.get("a").has_value());
+}
+
+TEST(ShardedTtlCache, SkipsValuesReadBeforeAnInvalidation) {
+    Cache cache(100);
+    const auto forever = Cache::Clock::time_point::max();
+
+    const auto generation = cache.generation("a");
+    cache.invalidate("a");
+    cache.put("a", 1, forever, generation);
+    EXPECT_FALSE(cache.get("a").has_value());
+
+    cache.put("a", 2, forever, cache.generation("a"));
+    cache.put("b", 3, forever);
+    cache.invalidateIf([](const std::string& key, const int value) { return key == "a" || value == 3; });
+    EXPECT_FALSE(cache.get("a").has_value());
+    EXPECT_FALSE(cache.get("b").has_value());
+    EXPECT_EQ(cache.stats()["invalidations"], 2);
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <soci/soci.h>
+#include <soci/sqlite3/soci-sqlite3.h>
+#include "mantis/core/statement_cache.h"
+
+class StatementCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sql << "CREATE TABLE notes (id TEXT PRIMARY KEY)";
+        cache.addSession(sql);
+    }
+
+    void TearDown() override {
+        cache.clear();
+    }
+
+    /// Prepare & run the statement of `key`, counting the notes
+    int run(const std::string& key) {
+        int n = -1;
+        const auto st = cache.prepare(sql, "notes", key, [] { return "SELECT COUNT(*) FROM notes"; });
+        st->exchange(soci::into(n));
+        st->define_and_bind();
+        st->execute(true);
+        return n;
+    }
+
+    [[nodiscard]] uint64_t hits() const { return cache.stats()["hits"].get<uint64_t>(); }
+    [[nodiscard]] uint64_t misses() const { return cache.stats()["misses"].get<uint64_t>(); }
+
+    soci::session sql{soci::sqlite3, "db=:memory:"};
+    mantis::StatementCache cache;
+};
+
+TEST_F(StatementCacheTest, ReusesStatementsUntilInvalidated) {
+    EXPECT_EQ(run("count"), 0);
+    EXPECT_EQ(misses(), 1);
+
+    EXPECT_EQ(run("count"), 0);
+    EXPECT_EQ(hits(), 1);
+
+    // Schema changed, the statement is prepared again
+    cache.invalidate("notes");
+    EXPECT_EQ(run("count"), 0);
+    EXPECT_EQ(misses(), 2);
+
+    EXPECT_EQ(run("count"), 0);
+    EXPECT_EQ(hits(), 2);
+}
+
+TEST_F(StatementCacheTest, PreparesStatementsOneOffPastTheCap) {
+    constexpr auto cap = mantis::StatementCache::MAX_STATEMENTS_PER_CONNECTION;
+    for (size_t i = 0; i <= cap; ++i)
+        ASSERT_EQ(run("count:" + std::to_string(i)), 0);
+    EXPECT_EQ(misses(), cap + 1);
+
+    // Statements within the cap are kept
+    for (size_t i = 0; i < cap; ++i)
+        ASSERT_EQ(run("count:" + std::to_string(i)), 0);
+    EXPECT_EQ(hits(), cap);
+
+    // The one past it was not, and still isn't
+    EXPECT_EQ(run("count:" + std::to_string(cap)), 0);
+    EXPECT_EQ(hits(), cap);
+    EXPECT_EQ(misses(), cap + 2);
+
+    // Invalidation drops the stale statements, freeing their slots
+    cache.invalidate("notes");
+    EXPECT_EQ(run("count:" + std::to_string(cap)), 0);
+    EXPECT_EQ(run("count:" + std::to_string(cap)), 0);
+    EXPECT_EQ(hits(), cap + 1);
+}
+
+TEST_F(StatementCacheTest, NestedUseOfABusyStatementIsPreparedOneOff) {
+    int n = -1;
+    const auto outer = cache.prepare(sql, "notes", "count", [] { return "SELECT COUNT(*) FROM notes"; });
+    outer->exchange(soci::into(n));
+    outer->define_and_bind();
+
+    EXPECT_EQ(run("count"), 0);
+    EXPECT_EQ(hits(), 0);
+    EXPECT_EQ(misses(), 2);
+
+    outer->execute(true);
+    EXPECT_EQ(n, 0);
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <soci/soci.h>
+#include <soci/sqlite3/soci-sqlite3.h>
+#include "mantis/core/sync.h"
+
+class SyncLogTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sql.open(soci::sqlite3, "db=:memory:");
+        mantis::SyncLog::migrate(sql);
+        sql << "CREATE TABLE notes (id TEXT PRIMARY KEY, title TEXT)";
+        sql << "INSERT INTO notes (id, title) VALUES ('a', 'before tracking')";
+        mantis::SyncLog::track(sql, "notes");
+    }
+
+    soci::session sql;
+};
+
+TEST_F(SyncLogTest, LogsEachRecordOnceInSequenceOrder) {
+    sql << "INSERT INTO notes (id, title) VALUES ('b', 'one')";
+    sql << "UPDATE notes SET title = 'two' WHERE id = 'b'";
+    sql << "UPDATE notes SET title = 'edited' WHERE id = 'a'";
+
+    const auto entries = mantis::SyncLog::changesSince(sql, "notes", 0, 10);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].id, "b");
+    EXPECT_EQ(entries[1].id, "a");
+    EXPECT_LT(entries[0].seq, entries[1].seq);
+
+    const auto later = mantis::SyncLog::changesSince(sql, "notes", entries[0].seq, 10);
+    ASSERT_EQ(later.size(), 1u);
+    EXPECT_EQ(later[0].id, "a");
+}
+
+TEST_F(SyncLogTest, KeepsTombstonesAcrossRenames) {
+    sql << "DELETE FROM notes WHERE id = 'a'";
+    EXPECT_FALSE(mantis::SyncLog::deletedAt(sql, "notes", "a").empty());
+
+    sql << "ALTER TABLE notes RENAME TO memos";
+    mantis::SyncLog::rename(sql, "notes", "memos");
+    sql << "INSERT INTO memos (id, title) VALUES ('c', 'renamed')";
+
+    const auto entries = mantis::SyncLog::changesSince(sql, "memos", 0, 10);
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_TRUE(entries[0].deleted);
+    EXPECT_EQ(entries[1].id, "c");
+    EXPECT_TRUE(mantis::SyncLog::changesSince(sql, "notes", 0, 10).empty());
+}
+
+TEST_F(SyncLogTest, UntrackedTablesAreNoLongerLogged) {
+    mantis::SyncLog::untrack(sql, "notes");
+    sql << "INSERT INTO notes (id, title) VALUES ('b', 'after untracking')";
+    sql << "DELETE FROM notes WHERE id = 'a'";
+
+    EXPECT_TRUE(mantis::SyncLog::changesSince(sql, "notes", 0, 10).empty());
+
+    // Tracked again, existing records are logged afresh
+    mantis::SyncLog::track(sql, "notes");
+    const auto entries = mantis::SyncLog::changesSince(sql, "notes", 0, 10);
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0].id, "b");
+}
+
+TEST(SyncPushTest, ClientTimesAheadOfTheServerAreClamped) {
+    const std::string now = "2025-01-31 13:45:00";
+
+    EXPECT_EQ(mantis::SyncLog::pushedTime("2025-01-31 13:44:59", now), "2025-01-31 13:44:59");
+    EXPECT_EQ(mantis::SyncLog::pushedTime("2025-01-31T13:40:00", now), "2025-01-31 13:40:00");
+    EXPECT_EQ(mantis::SyncLog::pushedTime("2025-01-31 13:45:01", now), now);
+    EXPECT_EQ(mantis::SyncLog::pushedTime("2099-12-31 23:59:59", now), now);
+}
+
+TEST(SyncPushTest, UnparsableClientTimesAreRejected) {
+    EXPECT_EQ(mantis::SyncLog::pushedTime("", "2025-01-31 13:45:00"), "");
+    EXPECT_EQ(mantis::SyncLog::pushedTime("yesterday", "2025-01-31 13:45:00"), "");
+}
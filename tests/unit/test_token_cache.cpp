@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include "mantis/core/token_cache.h"
+
+namespace
+{
+    nlohmann::json claims(const int64_t expiresIn)
+    {
+        const auto now = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        return {{"id", "123"}, {"table", "users"}, {"verified", true}, {"exp", now + expiresIn}};
+    }
+}
+
+TEST(TokenCache, ServesVerifiedTokensUntilExpiry) {
+    mantis::TokenCache cache;
+    EXPECT_FALSE(cache.get("token", "secret").has_value());
+
+    cache.put("token", "secret", claims(60));
+    const auto hit = cache.get("token", "secret");
+    ASSERT_TRUE(hit.has_value());
+    EXPECT_EQ(hit->at("id"), "123");
+
+    // Expired or without `exp`, never served
+    cache.put("expired", "secret", claims(-1));
+    EXPECT_FALSE(cache.get("expired", "secret").has_value());
+    cache.put("forever", "secret", {{"id", "123"}});
+    EXPECT_FALSE(cache.get("forever", "secret").has_value());
+}
+
+TEST(TokenCache, DropsTokensOnContextChange) {
+    mantis::TokenCache cache;
+    cache.put("token", "secret", claims(60));
+
+    EXPECT_FALSE(cache.get("token", "rotated").has_value());
+    EXPECT_FALSE(cache.get("token", "secret").has_value());
+    EXPECT_EQ(cache.stats()["entries"], 0);
+}
+
+TEST(TokenCache, StaysBounded) {
+    mantis::TokenCache cache;
+    for (size_t i = 0; i < mantis::TokenCache::MAX_ENTRIES * 2; ++i)
+        cache.put("token-" + std::to_string(i), "secret", claims(60 + static_cast<int64_t>(i)));
+
+    EXPECT_LE(cache.stats()["entries"].get<size_t>(), mantis::TokenCache::MAX_ENTRIES);
+    EXPECT_TRUE(cache.get("token-" + std::to_string(mantis::TokenCache::MAX_ENTRIES * 2 - 1), "secret").has_value());
+}
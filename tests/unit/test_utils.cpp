@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include "mantis/utils/utils.h"
+
+TEST(SortableIdTest, IdsAreSortedByCreation) {
+    std::string last;
+    for (int i = 0; i < 10000; ++i) {
+        const auto id = mantis::generateSortableId();
+        ASSERT_EQ(id.size(), 16);
+        ASSERT_LT(last, id);
+        last = id;
+    }
+}
+
+TEST(EtagTest, MatchesWeaklyAgainstTagLists) {
+    EXPECT_TRUE(mantis::etagMatches("W/\"abc\"", "W/\"abc\""));
+    EXPECT_TRUE(mantis::etagMatches("\"abc\"", "W/\"abc\""));
+    EXPECT_TRUE(mantis::etagMatches("\"x\", W/\"abc\"", "W/\"abc\""));
+    EXPECT_TRUE(mantis::etagMatches("*", "W/\"abc\""));
+    EXPECT_FALSE(mantis::etagMatches("W/\"abd\"", "W/\"abc\""));
+    EXPECT_FALSE(mantis::etagMatches("", "W/\"abc\""));
+}
+
+TEST(Base64UrlTest, RoundTripsAnyBytes) {
+    std::string data;
+    for (int i = 0; i < 256; ++i) {
+        const auto encoded = mantis::base64UrlEncode(data);
+        ASSERT_EQ(encoded.find_first_not_of(
+                      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"), std::string::npos);
+        ASSERT_EQ(mantis::base64UrlDecode(encoded), data);
+        data.push_back(static_cast<char>(255 - i));
+    }
+
+    EXPECT_EQ(mantis::base64UrlEncode("\xfb\xff"), "-_8");
+    EXPECT_EQ(mantis::base64UrlDecode("-_8="), "\xfb\xff");
+    EXPECT_EQ(mantis::base64UrlDecode("YQ=="), "a");
+}
+
+TEST(Base64UrlTest, RejectsMalformedInput) {
+    EXPECT_FALSE(mantis::base64UrlDecode("YW+i").has_value()); // Standard alphabet
+    EXPECT_FALSE(mantis::base64UrlDecode("YW/i").has_value());
+    EXPECT_FALSE(mantis::base64UrlDecode("YW i").has_value());
+    EXPECT_FALSE(mantis::base64UrlDecode("Y=Wi").has_value());
+    EXPECT_FALSE(mantis::base64UrlDecode("YWJjZ").has_value()); // Dangling character
+    EXPECT_FALSE(mantis::base64UrlDecode("YR").has_value()); // Non-zero left over bits
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <soci/soci.h>
+#include <soci/sqlite3/soci-sqlite3.h>
+#include <thread>
+#include "mantis/core/write_queue.h"
+
+class WriteQueueTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto sql = std::make_unique<soci::session>(soci::sqlite3, "db=:memory:");
+        *sql << "CREATE TABLE notes (id TEXT PRIMARY KEY)";
+        queue = std::make_unique<mantis::WriteQueue>(std::move(sql));
+        queue->start();
+    }
+
+    void TearDown() override {
+        queue->stop();
+    }
+
+    int count() const {
+        int n = 0;
+        queue->session() << "SELECT COUNT(*) FROM notes", soci::into(n);
+        return n;
+    }
+
+    std::unique_ptr<mantis::WriteQueue> queue;
+};
+
+TEST_F(WriteQueueTest, RunsNestedSubmissionsInline) {
+    const auto committed = queue->submit([this](soci::session& sql) {
+        sql << "INSERT INTO notes (id) VALUES ('outer')";
+
+        // Would deadlock if queued behind the job running it
+        return queue->submit([](soci::session& inner) {
+            inner << "INSERT INTO notes (id) VALUES ('inner')";
+            return true;
+        });
+    });
+
+    EXPECT_TRUE(committed);
+    queue->stop();
+    EXPECT_EQ(count(), 2);
+}
+
+TEST_F(WriteQueueTest, RollsBackOnlyTheFailingJob) {
+    constexpr int writers = 8;
+    std::vector<std::thread> threads;
+    std::atomic<int> failed{0};
+
+    for (int i = 0; i < writers; ++i)
+    {
+        threads.emplace_back([this, i, &failed] {
+            try
+            {
+                queue->submit([i](soci::session& sql) {
+                    sql << "INSERT INTO notes (id) VALUES ('" + std::to_string(i) + "')";
+                    if (i == 0) sql << "INSERT INTO notes (id) VALUES ('1')"; // Conflicts, or is conflicted with
+                    return true;
+                });
+            }
+            catch (const soci::soci_error&)
+            {
+                ++failed;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+
+    // Either the duplicate or writer `1` lost the race, nobody else's write was undone
+    EXPECT_EQ(failed, 1);
+    queue->stop();
+    EXPECT_EQ(count(), writers - 1);
+}